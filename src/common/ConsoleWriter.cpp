@@ -1,5 +1,6 @@
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 #include "utils.h"
 
@@ -9,6 +10,11 @@ using namespace std;
 
 const int ConsoleWriter::FLOAT_PRECISION = 3;
 
+void ConsoleWriter::setThroughputUnit(string unit)
+{
+    throughputUnit = unit;
+}
+
 void ConsoleWriter::beginOutput(size_t iterations, vector<size_t> sizes, string typeName)
 {
     cout << "##### Initialized Runner #####" << endl;
@@ -47,7 +53,7 @@ void ConsoleWriter::writeRun(const CPURun& run)
     if(run.exceptionOccured)
         cout << "#  Run            " << "EXCEPTION: " << run.exceptionMsg << endl;
     else
-        cout << "#  Run            " << fixed << setprecision(FLOAT_PRECISION) << run.runTimeMean << "s (sigma " << run.runTimeDeviation << "s) " << (run.verificationResult ? "SUCCESS" : "FAILED") << endl;
+        cout << "#  Run            " << fixed << setprecision(FLOAT_PRECISION) << run.runTimeMean << "s (sigma " << run.runTimeDeviation << "s) " << (run.verificationResult ? "SUCCESS" : "FAILED") << throughputToString(run, run.runTimeMean) << endl;
 }
 
 void ConsoleWriter::writeRun(const CLRun& run)
@@ -59,8 +65,18 @@ void ConsoleWriter::writeRun(const CLRun& run)
         if(r.exceptionOccured)
             cout << "#  WG: " << setw(4) << r.wgSize << "       EXCEPTION: " << r.exceptionMsg << endl;
         else
-            cout << "#  WG: " << setw(4) << r.wgSize << "       " << fixed << setprecision(FLOAT_PRECISION) << r.runTimeMean << "s (sigma " << r.runTimeDeviation << "s) " << (r.verificationResult ? "SUCCESS" : "FAILED ") << endl;
+            cout << "#  WG: " << setw(4) << r.wgSize << "       " << fixed << setprecision(FLOAT_PRECISION) << r.runTimeMean << "s (sigma " << r.runTimeDeviation << "s) " << (r.verificationResult ? "SUCCESS" : "FAILED ") << throughputToString(run, r.runTimeMean) << endl;
 
     cout << "#  Download (avg) " << fixed << setprecision(FLOAT_PRECISION) << run.avgDownloadTime << "s" << endl;
     cout << "#  Fastest        " << fixed << setprecision(FLOAT_PRECISION) << (run.fastest->uploadTimeMean + run.fastest->runTimeMean + run.fastest->downloadTimeMean) << "s " << "(WG: " << run.fastest->wgSize << ") " << endl;
 }
+
+const string ConsoleWriter::throughputToString(const Run& run, double time)
+{
+    if(throughputUnit.empty() || run.workload <= 0.0 || time <= 0.0)
+        return "";
+
+    stringstream ss;
+    ss << " " << fixed << setprecision(1) << run.workload / time << " " << throughputUnit;
+    return ss.str();
+}
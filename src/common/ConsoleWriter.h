@@ -12,6 +12,8 @@ class ConsoleWriter final
 public:
     static const int FLOAT_PRECISION;
 
+    void setThroughputUnit(string unit);
+
     void beginOutput(size_t iterations, vector<size_t> sizes, string typeName);
     void endOutput(double seconds);
 
@@ -20,5 +22,10 @@ public:
 
     void writeRun(const CPURun& run);
     void writeRun(const CLRun& run);
+
+private:
+    const string throughputToString(const Run& run, double time);
+
+    string throughputUnit;
 };
 
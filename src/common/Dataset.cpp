@@ -0,0 +1,172 @@
+#include <fstream>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#undef min
+#undef max
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Dataset.h"
+
+using namespace std;
+
+const string elementTypeToString(ElementType type)
+{
+    switch(type)
+    {
+    case ElementType::Int:
+        return "int";
+    case ElementType::UInt:
+        return "uint";
+    case ElementType::Float:
+        return "float";
+    case ElementType::Double:
+        return "double";
+    }
+
+    throw runtime_error("Invalid ElementType");
+}
+
+static size_t elementTypeSize(ElementType type)
+{
+    return type == ElementType::Double ? 8 : 4;
+}
+
+Dataset::Dataset(string fileName)
+    : fileName(fileName)
+{
+#ifdef _WIN32
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+        throw runtime_error("Failed to open dataset " + fileName);
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    mappingSize = (size_t)fileSize.QuadPart;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if(mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        throw runtime_error("Failed to map dataset " + fileName);
+    }
+
+    // copy on write, changes are not written back to the file
+    mapping = MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+    if(mapping == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw runtime_error("Failed to map dataset " + fileName);
+    }
+#else
+    fileDescriptor = open(fileName.c_str(), O_RDONLY);
+    if(fileDescriptor == -1)
+        throw runtime_error("Failed to open dataset " + fileName);
+
+    struct stat fileStat;
+    fstat(fileDescriptor, &fileStat);
+    mappingSize = (size_t)fileStat.st_size;
+
+    // private mapping, changes are not written back to the file
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+    if(mapping == MAP_FAILED)
+    {
+        close(fileDescriptor);
+        throw runtime_error("Failed to map dataset " + fileName);
+    }
+#endif
+
+    header = (DatasetHeader*)mapping;
+    data = (char*)mapping + sizeof(DatasetHeader);
+
+    if(mappingSize < sizeof(DatasetHeader) || memcmp(header->magic, "BTDS", 4) != 0)
+    {
+        unmap();
+        throw runtime_error(fileName + " is not a dataset");
+    }
+
+    if(header->version != DatasetHeader::VERSION || header->elementType > (uint32_t)ElementType::Double || header->dimensions > DatasetHeader::MAX_DIMENSIONS)
+    {
+        unmap();
+        throw runtime_error("Dataset " + fileName + " has an unsupported format");
+    }
+
+    if(mappingSize < sizeof(DatasetHeader) + header->count * elementTypeSize(getElementType()))
+    {
+        unmap();
+        throw runtime_error("Dataset " + fileName + " is truncated");
+    }
+}
+
+Dataset::~Dataset()
+{
+    unmap();
+}
+
+void Dataset::unmap()
+{
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+#else
+    munmap(mapping, mappingSize);
+    close(fileDescriptor);
+#endif
+}
+
+void Dataset::write(string fileName, ElementType type, const void* data, uint64_t count, const vector<uint64_t>& shape)
+{
+    if(shape.size() > DatasetHeader::MAX_DIMENSIONS)
+        throw runtime_error("Datasets support at most 4 dimensions");
+
+    DatasetHeader header;
+    memset(&header, 0, sizeof(DatasetHeader));
+    memcpy(header.magic, "BTDS", 4);
+    header.version = DatasetHeader::VERSION;
+    header.elementType = (uint32_t)type;
+    header.dimensions = (uint32_t)shape.size();
+    header.count = count;
+    for(size_t i = 0; i < shape.size(); i++)
+        header.shape[i] = shape[i];
+
+    ofstream file(fileName, ios::binary);
+    if(!file)
+        throw runtime_error("Failed to create dataset " + fileName);
+
+    file.write((const char*)&header, sizeof(DatasetHeader));
+    file.write((const char*)data, count * elementTypeSize(type));
+
+    if(!file)
+        throw runtime_error("Failed to write dataset " + fileName);
+}
+
+ElementType Dataset::getElementType()
+{
+    return (ElementType)header->elementType;
+}
+
+uint64_t Dataset::getCount()
+{
+    return header->count;
+}
+
+uint32_t Dataset::getDimensions()
+{
+    return header->dimensions;
+}
+
+uint64_t Dataset::getShape(uint32_t dimension)
+{
+    if(dimension >= header->dimensions)
+        throw runtime_error("Dataset " + fileName + " has no dimension " + to_string((unsigned long long)dimension));
+
+    return header->shape[dimension];
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <typeinfo>
+#include <stdexcept>
+
+using namespace std;
+
+/**
+* Type of the elements stored in a dataset file.
+*/
+enum class ElementType : uint32_t
+{
+    Int = 0,
+    UInt = 1,
+    Float = 2,
+    Double = 3
+};
+
+const string elementTypeToString(ElementType type);
+
+template <typename T>
+ElementType getElementType()
+{
+    if(typeid(T) == typeid(int32_t))
+        return ElementType::Int;
+    if(typeid(T) == typeid(uint32_t))
+        return ElementType::UInt;
+    if(typeid(T) == typeid(float))
+        return ElementType::Float;
+    if(typeid(T) == typeid(double))
+        return ElementType::Double;
+    throw runtime_error("Type is not supported by datasets");
+}
+
+/**
+* Header at the beginning of every dataset file. The elements follow directly after the header.
+*/
+struct DatasetHeader
+{
+    static const uint32_t VERSION = 1;
+    static const size_t MAX_DIMENSIONS = 4;
+
+    char magic[4]; // "BTDS"
+    uint32_t version;
+    uint32_t elementType;
+    uint32_t dimensions;
+    uint64_t count;
+    uint64_t shape[MAX_DIMENSIONS];
+    uint64_t reserved; // pads the header to 64 bytes
+};
+
+/**
+* A binary file of elements which is memory mapped for reading.
+* The mapping is private, so algorithms may modify the data without changing the file.
+*/
+class Dataset
+{
+public:
+    /**
+    * Constructor.
+    * Opens and maps the given dataset file.
+    *
+    * @param fileName The dataset file to open.
+    * @throw Throws a runtime_error if the file cannot be mapped or is not a valid dataset.
+    */
+    Dataset(string fileName);
+
+    /**
+    * Destructor.
+    * Unmaps the file. All pointers returned by getData become invalid.
+    */
+    virtual ~Dataset();
+
+    /**
+    * Writes a new dataset file.
+    *
+    * @param fileName The file to create.
+    * @param type The type of the elements.
+    * @param data The elements to write.
+    * @param count The number of elements.
+    * @param shape The extent of each dimension of the data. The product of all extents does not need to equal count, e.g. to store additional elements.
+    */
+    static void write(string fileName, ElementType type, const void* data, uint64_t count, const vector<uint64_t>& shape);
+
+    ElementType getElementType();
+    uint64_t getCount();
+    uint32_t getDimensions();
+    uint64_t getShape(uint32_t dimension);
+
+    /**
+    * Returns a pointer to the mapped elements.
+    *
+    * @param count The number of elements the caller is going to access.
+    * @throw Throws a runtime_error if T does not match the element type of the dataset or it does not contain count elements.
+    */
+    template <typename T>
+    T* getData(size_t count)
+    {
+        if(::getElementType<T>() != getElementType())
+            throw runtime_error("Dataset " + fileName + " contains elements of type " + elementTypeToString(getElementType()) + " but " + elementTypeToString(::getElementType<T>()) + " was requested");
+        if(count > header->count)
+            throw runtime_error("Dataset " + fileName + " contains less elements than requested");
+
+        return (T*)data;
+    }
+
+private:
+    void unmap();
+
+    string fileName;
+
+    void* mapping;
+    size_t mappingSize;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    DatasetHeader* header;
+    void* data;
+};
@@ -20,6 +20,7 @@
 #include "DeviceInfoWriter.h"
 #include "StatsWriter.h"
 #include "ConsoleWriter.h"
+#include "Dataset.h"
 
 using namespace std;
 
@@ -183,6 +184,14 @@ public:
             throw OpenCLException("No GPU context initialized!");
     }
 
+    /**
+    * Returns the plugin used to generate and verify the data, e.g. for configuring the input.
+    */
+    Plugin<T>* getPlugin()
+    {
+        return plugin;
+    }
+
     bool hasCLCPU()
     {
         return cpuContext != nullptr;
@@ -225,6 +234,10 @@ private:
 
         plugin = new Plugin<T>();
 
+        string throughputUnit = getThroughputUnit(plugin, 0);
+        writer.setThroughputUnit(throughputUnit);
+        consoleWriter.setThroughputUnit(throughputUnit);
+
         consoleWriter.beginOutput(iterations, sizes, getTypeName<T>());
     }
 
@@ -234,15 +247,23 @@ private:
     void runCPU(CPUAlgorithm<T>* alg, size_t size)
     {
         // create run stats and prepare input
-        CPURun run(plugin->getTaskDescription(size), size);
+        CPURun run(plugin->getTaskDescription(size), size, getWorkload(plugin, size, 0));
 
         run.verificationResult = true;
 
+        // generate the input only once, algorithms which may modify it get a fresh copy of it for every iteration
+        size_t inputLength = plugin->getInputLength(size);
+        T* pristine = plugin->genInput(size);
+        bool readOnly = isInputReadOnly(plugin, 0);
+        data = readOnly ? pristine : new T[inputLength];
+
         for(size_t i = 0; i < iterations; i++)
         {
             CPUIteration iteration;
 
-            data = plugin->genInput(size);
+            // restore input, a fresh result keeps the last iteration's output from being verified again
+            if(!readOnly)
+                parallelCopy(data, pristine, inputLength);
             result = plugin->genResult(size);
 
             // run algorithm
@@ -253,13 +274,16 @@ private:
             // verfiy result
             run.verificationResult = run.verificationResult && (validate ? plugin->verifyResult(dynamic_cast<typename Plugin<T>::AlgorithmType*>(alg), data, result, size) : true);
 
-            // cleanup
-            plugin->freeInput(data);
             plugin->freeResult(result);
 
             run.iterations.push_back(iteration);
         }
 
+        // cleanup
+        if(!readOnly)
+            delete[] data;
+        plugin->freeInput(pristine);
+
         // compute mean
         double sum = 0;
         for(CPUIteration& i : run.iterations)
@@ -285,11 +309,9 @@ private:
     void runCL(CLAlgorithm<T>* alg, Context* context, CommandQueue* queue, bool useAllSupportedWorkGroupSizes, size_t size)
     {
         // create algorithm and batch stats, prepare input
-        CLRun run(plugin->getTaskDescription(size), size);
+        CLRun run(plugin->getTaskDescription(size), size, getWorkload(plugin, size, 0));
 
         data = plugin->genInput(size);
-        result = plugin->genResult(size);
-
 
         if(useAllSupportedWorkGroupSizes)
             for(size_t i : alg->getSupportedWorkGroupSizes())
@@ -326,7 +348,6 @@ private:
 
         // cleanup
         plugin->freeInput(data);
-        plugin->freeResult(result);
 
         writer.writeRun(run);
         consoleWriter.writeRun(run);
@@ -337,6 +358,8 @@ private:
         CLRunWithWGSize run;
         run.wgSize = workGroupSize;
 
+        result = nullptr;
+
         try
         {
             run.verificationResult = true;
@@ -345,6 +368,9 @@ private:
             {
                 CLIteration iteration;
 
+                // a fresh result keeps the last iteration's download from being verified again
+                result = plugin->genResult(size);
+
                 // upload data
                 timer.start();
                 alg->upload(workGroupSize, data, size);
@@ -366,6 +392,9 @@ private:
                 // verify
                 run.verificationResult = run.verificationResult && (validate ? plugin->verifyResult(dynamic_cast<typename Plugin<T>::AlgorithmType*>(alg), data, result, size) : true);
 
+                plugin->freeResult(result);
+                result = nullptr;
+
                 run.iterations.push_back(iteration);
             }
         }
@@ -380,6 +409,12 @@ private:
             run.exceptionMsg = "unkown";
         }
 
+        if(result != nullptr)
+        {
+            plugin->freeResult(result);
+            result = nullptr;
+        }
+
         // compute means
         double uploadSum = 0;
         double runSum = 0;
@@ -415,6 +450,49 @@ private:
         return run;
     }
 
+    /**
+    * Plugins may report the amount of work of a problem size, e.g. the number of pixels, and the unit of the resulting throughput.
+    * The writers then print the throughput next to the run times. Plugins without these functions use the overloads returning nothing.
+    */
+    template <typename P>
+    static auto getWorkload(P* plugin, size_t size, int) -> decltype(plugin->getWorkload(size))
+    {
+        return plugin->getWorkload(size);
+    }
+
+    template <typename P>
+    static double getWorkload(P* plugin, size_t size, long)
+    {
+        return 0.0;
+    }
+
+    template <typename P>
+    static auto getThroughputUnit(P* plugin, int) -> decltype(plugin->getThroughputUnit())
+    {
+        return plugin->getThroughputUnit();
+    }
+
+    template <typename P>
+    static string getThroughputUnit(P* plugin, long)
+    {
+        return "";
+    }
+
+    /**
+    * Plugins whose algorithms never write to their input may say so. The CPU runs then work directly on the generated or mapped input instead of a copy.
+    */
+    template <typename P>
+    static auto isInputReadOnly(P* plugin, int) -> decltype(plugin->isInputReadOnly())
+    {
+        return plugin->isInputReadOnly();
+    }
+
+    template <typename P>
+    static bool isInputReadOnly(P* plugin, long)
+    {
+        return false;
+    }
+
     /**
     * Checks if the context necessary to run an algorithm is available.
     */
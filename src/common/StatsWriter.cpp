@@ -2,6 +2,11 @@
 
 #include "StatsWriter.h"
 
+void StatsWriter::setThroughputUnit(string unit)
+{
+    throughputUnit = unit;
+}
+
 void StatsWriter::beginFile(string fileName, char separator)
 {
     sep = separator;
@@ -40,6 +45,8 @@ void StatsWriter::beginAlgorithm(string algorithmName, RunType runType, double i
         file << "size" << sep;
         file << "run time mean" << sep;
         file << "run time deviation" << sep;
+        if(!throughputUnit.empty())
+            file << "run throughput (" << throughputUnit << ")" << sep;
         file << "result" << endl;
         break;
     case RunType::CL_CPU:
@@ -55,6 +62,8 @@ void StatsWriter::beginAlgorithm(string algorithmName, RunType runType, double i
         //file << "cleanup time" << sep;
         file << "wg size" << sep;
         file << "up run down sum" << sep;
+        if(!throughputUnit.empty())
+            file << "run throughput (" << throughputUnit << ")" << sep;
         file << "result" << endl;
         break;
     }
@@ -77,6 +86,8 @@ void StatsWriter::writeRun(const CPURun& run)
     file << run.size << sep;
     file << run.runTimeMean << sep;
     file << run.runTimeDeviation << sep;
+    if(!throughputUnit.empty())
+        file << (run.runTimeMean > 0.0 ? run.workload / run.runTimeMean : 0.0) << sep;
     file << (run.exceptionOccured ? "EXCEPTION" : (run.verificationResult ? "SUCCESS" : "FAILED")) << endl;
 
     file.flush();
@@ -95,6 +106,8 @@ void StatsWriter::writeRun(const CLRun& run)
     //file << run.cleanupTime << sep;
     file << run.fastest->wgSize << sep;
     file << (run.fastest->uploadTimeMean + run.fastest->runTimeMean + run.fastest->downloadTimeMean) << sep;
+    if(!throughputUnit.empty())
+        file << (run.fastest->runTimeMean > 0.0 ? run.workload / run.fastest->runTimeMean : 0.0) << sep;
     file << (run.fastest->exceptionOccured ? "EXCEPTION" : (run.fastest->verificationResult ? "SUCCESS" : "FAILED")) << endl;
 
     file.flush();
@@ -11,6 +11,8 @@ using namespace std;
 class StatsWriter final
 {
 public:
+    void setThroughputUnit(string unit);
+
     void beginFile(string fileName, char separator = ';');
     void endFile(double seconds);
 
@@ -23,5 +25,6 @@ public:
 private:
     ofstream file;
     char sep;
+    string throughputUnit;
 };
 
@@ -13,15 +13,8 @@ void clppContext::setup()
 
 void clppContext::setup(unsigned int platformId, unsigned int deviceId)
 {
-	isGPU = isCPU = false;
-	Vendor = Vendor_Unknown;
-
 	cl_int clStatus;
 
-	size_t infoLen;
-	char infoStr[1024];
-	cl_device_type infoType;
-
 	//---- Retreive information about platforms
 	cl_uint platformsCount;
 	clStatus = clGetPlatformIDs(0, NULL, &platformsCount);
@@ -34,17 +27,6 @@ void clppContext::setup(unsigned int platformId, unsigned int deviceId)
 	platformId = min(platformId, platformsCount - 1);
 	clPlatform = platforms[platformId];
 
-	clGetPlatformInfo (clPlatform, CL_PLATFORM_VENDOR, sizeof(infoStr), infoStr, &infoLen);
-	//clGetPlatformInfo (clPlatform, CL_DEVICE_VENDOR, sizeof(infoStr), infoStr, &infoLen);
-	if (stristr(infoStr, "Intel") != NULL)
-		Vendor = Vendor_Intel;
-	else if (stristr(infoStr, "AMD") != NULL || stristr(infoStr, "Advanced Micro Devices") != NULL)
-		Vendor = Vendor_AMD;
-	else if (stristr(infoStr, "NVidia") != NULL)
-		Vendor = Vendor_NVidia;
-	else if (stristr(infoStr, "Apple") != NULL)
-		Vendor = Vendor_NVidia;
-
 	//---- Devices
 	cl_uint devicesCount;
 	clStatus = clGetDeviceIDs(clPlatform, CL_DEVICE_TYPE_ALL, 0, NULL, &devicesCount);
@@ -57,11 +39,7 @@ void clppContext::setup(unsigned int platformId, unsigned int deviceId)
 
 	clDevice = devices[min(deviceId, devicesCount - 1)];
 
-	clGetDeviceInfo(clDevice, CL_DEVICE_TYPE, sizeof(infoType), &infoType, &infoLen);
-	if (infoType & CL_DEVICE_TYPE_CPU)
-		isCPU = true;
-	if (infoType & CL_DEVICE_TYPE_GPU)
-		isGPU = true;
+	detectDevice();
 
 	//---- Context
 	clContext = clCreateContext(0, 1, &clDevice, NULL, NULL, &clStatus);
@@ -84,6 +62,45 @@ void clppContext::setup(unsigned int platformId, unsigned int deviceId)
 	//cout << "Platform[" << platformName << "] Device[" << deviceName << "]" << endl << endl<< endl;
 }
 
+void clppContext::setup(cl_context context, cl_device_id device, cl_command_queue queue)
+{
+	clContext = context;
+	clDevice = device;
+	clQueue = queue;
+
+	cl_int clStatus = clGetDeviceInfo(clDevice, CL_DEVICE_PLATFORM, sizeof(cl_platform_id), &clPlatform, NULL);
+	assert(clStatus == CL_SUCCESS);
+
+	detectDevice();
+}
+
+void clppContext::detectDevice()
+{
+	isGPU = isCPU = false;
+	Vendor = Vendor_Unknown;
+
+	size_t infoLen;
+	char infoStr[1024];
+	cl_device_type infoType;
+
+	clGetPlatformInfo (clPlatform, CL_PLATFORM_VENDOR, sizeof(infoStr), infoStr, &infoLen);
+	//clGetPlatformInfo (clPlatform, CL_DEVICE_VENDOR, sizeof(infoStr), infoStr, &infoLen);
+	if (stristr(infoStr, "Intel") != NULL)
+		Vendor = Vendor_Intel;
+	else if (stristr(infoStr, "AMD") != NULL || stristr(infoStr, "Advanced Micro Devices") != NULL)
+		Vendor = Vendor_AMD;
+	else if (stristr(infoStr, "NVidia") != NULL)
+		Vendor = Vendor_NVidia;
+	else if (stristr(infoStr, "Apple") != NULL)
+		Vendor = Vendor_NVidia;
+
+	clGetDeviceInfo(clDevice, CL_DEVICE_TYPE, sizeof(infoType), &infoType, &infoLen);
+	if (infoType & CL_DEVICE_TYPE_CPU)
+		isCPU = true;
+	if (infoType & CL_DEVICE_TYPE_GPU)
+		isGPU = true;
+}
+
 char* clppContext::stristr(const char *String, const char *Pattern)
 {
     char *pptr, *sptr, *start;
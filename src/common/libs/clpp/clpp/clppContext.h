@@ -23,6 +23,10 @@ public:
 	// Setup with a specific platform and device
 	void setup(unsigned int platformId, unsigned int deviceId);
 
+	// Setup on an existing context, device and queue. The handles stay owned by the caller,
+	// so buffers of the caller can be passed to pushCLDatas without copies.
+	void setup(cl_context context, cl_device_id device, cl_command_queue queue);
+
 	// Returns the SIMT Capability of the device.
 	int GetSIMTCapability();
 
@@ -32,6 +36,9 @@ public:
 	clppVendor Vendor;
 
 private:
+	// Retreives the vendor and the device type of clPlatform and clDevice
+	void detectDevice();
+
 	// Case-insensitive strstr() work-alike.
 	static char* stristr(const char *String, const char *Pattern);
 };
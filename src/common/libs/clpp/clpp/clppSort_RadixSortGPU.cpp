@@ -19,6 +19,13 @@ clppSort_RadixSortGPU::clppSort_RadixSortGPU(clppContext* context, unsigned int
 	_keySize = 4;
 	_clBuffer_dataSet = 0;
 	_clBuffer_dataSetOut = 0;
+	_clBuffer_hostDataSet = 0;
+	radixDataB = 0;
+    _clBuffer_radixHist1 = NULL;
+    _clBuffer_radixHist2 = NULL;
+	_datasetSize = 0;
+	_capacity = 0;
+	_scan = 0;
 
 	_bits = bits;
 
@@ -43,28 +50,12 @@ clppSort_RadixSortGPU::clppSort_RadixSortGPU(clppContext* context, unsigned int
 
 	_scan = clpp::createBestScan(context, sizeof(int), maxElements);
 
-    _clBuffer_radixHist1 = NULL;
-    _clBuffer_radixHist2 = NULL;
-	_datasetSize = 0;
-	_is_clBuffersOwner = false;
+	reserve(maxElements);
 }
 
 clppSort_RadixSortGPU::~clppSort_RadixSortGPU()
 {
-	if (_is_clBuffersOwner)
-	{
-		if (_clBuffer_dataSet)
-			clReleaseMemObject(_clBuffer_dataSet);
-
-		if (_clBuffer_dataSetOut)
-			clReleaseMemObject(_clBuffer_dataSetOut);
-	}
-
-	if (_clBuffer_radixHist1)
-		clReleaseMemObject(_clBuffer_radixHist1);
-
-	if (_clBuffer_radixHist2)
-		clReleaseMemObject(_clBuffer_radixHist2);
+	freeUpRadixMems();
 
 	delete _scan;
 }
@@ -173,6 +164,14 @@ void clppSort_RadixSortGPU::sort()
 
         std::swap(dataA, dataB);
     }
+
+	//---- An odd number of passes ends in the second buffer, the result is always returned in the pushed one
+	if (dataA != _clBuffer_dataSet)
+	{
+		size_t elementSize = _keysOnly ? _keySize : (_valueSize + _keySize);
+		clStatus = clEnqueueCopyBuffer(_context->clQueue, dataA, _clBuffer_dataSet, 0, 0, elementSize * _datasetSize, 0, NULL, NULL);
+		checkCLStatus(clStatus);
+	}
 }
 
 void clppSort_RadixSortGPU::radixLocal(const size_t* global, const size_t* local, cl_mem data, cl_mem hist, cl_mem blockHists, int bitOffset)
@@ -246,90 +245,98 @@ void clppSort_RadixSortGPU::pushDatas(void* dataSet, size_t datasetSize)
 	//---- Store some values
 	_dataSet = dataSet;
 	_dataSetOut = dataSet;
-	bool reallocate = datasetSize > _datasetSize || !_is_clBuffersOwner;
 	_datasetSize = datasetSize;
 
-	//---- Prepare some buffers
-	if (reallocate)
+	grow(datasetSize);
+
+	//---- Copy on the device, the buffer is kept for the following data sets
+	size_t elementSize = _keysOnly ? _keySize : (_valueSize + _keySize);
+	if (!_clBuffer_hostDataSet)
 	{
-		//---- Release
-		if (_clBuffer_dataSet)
-		{
-			clReleaseMemObject(_clBuffer_dataSet);
-			clReleaseMemObject(_clBuffer_dataSetOut);
-			clReleaseMemObject(_clBuffer_radixHist1);
-			clReleaseMemObject(_clBuffer_radixHist2);
-		}
-
-		//---- Allocate
-		unsigned int numBlocks = roundUpDiv(_datasetSize, _workgroupSize * 4);
-
-		_clBuffer_radixHist1 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, _keySize * 16 * numBlocks, NULL, &clStatus);
+		_clBuffer_hostDataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, elementSize * _capacity, NULL, &clStatus);
 		checkCLStatus(clStatus);
+	}
 
-		_clBuffer_radixHist2 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, _keySize * 2 * 16 * numBlocks, NULL, &clStatus);
-		checkCLStatus(clStatus);
+	clStatus = clEnqueueWriteBuffer(_context->clQueue, _clBuffer_hostDataSet, CL_FALSE, 0, elementSize * _datasetSize, _dataSet, 0, 0, 0);
+	checkCLStatus(clStatus);
 
-		//---- Copy on the device
-		if (_keysOnly)
-		{
-			_clBuffer_dataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, _keySize * _datasetSize, _dataSet, &clStatus);
-			checkCLStatus(clStatus);
-
-			_clBuffer_dataSetOut = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, _keySize * _datasetSize, NULL, &clStatus);
-			checkCLStatus(clStatus);
-		}
-		else
-		{
-			_clBuffer_dataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, (_valueSize+_keySize) * _datasetSize, _dataSet, &clStatus);
-			checkCLStatus(clStatus);
-
-			_clBuffer_dataSetOut = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, (_valueSize+_keySize) * _datasetSize, NULL, &clStatus);
-			checkCLStatus(clStatus);
-		}
-
-		_is_clBuffersOwner = true;
-	}
-	else
-		// Just resend
-		clEnqueueWriteBuffer(_context->clQueue, _clBuffer_dataSet, CL_FALSE, 0, (_valueSize+_keySize) * _datasetSize, _dataSet, 0, 0, 0);
+	_clBuffer_dataSet = _clBuffer_hostDataSet;
+	_clBuffer_dataSetOut = radixDataB;
 }
 
 void clppSort_RadixSortGPU::pushCLDatas(cl_mem clBuffer_dataSet, size_t datasetSize)
+{
+	//---- The given buffer stays owned by the caller
+	_datasetSize = datasetSize;
+
+	grow(datasetSize);
+
+	_clBuffer_dataSet = clBuffer_dataSet;
+	_clBuffer_dataSetOut = radixDataB;
+}
+
+#pragma endregion
+
+#pragma region reserve
+
+void clppSort_RadixSortGPU::reserve(size_t maxElements)
 {
 	cl_int clStatus;
 
-	_is_clBuffersOwner = false;
+	if (maxElements <= _capacity)
+		return;
 
-	//---- Store some values
-	bool reallocate = datasetSize > _datasetSize;
-	_datasetSize = datasetSize;
+	//---- Release, the pushed data does not survive a reallocation
+	bool hostDataSet = _clBuffer_hostDataSet != 0;
+	freeUpRadixMems();
+
+	_capacity = maxElements;
+
+	//---- Allocate
+	unsigned int numBlocks = roundUpDiv(_capacity, _workgroupSize * 4);
+
+	// column size = 2^b = 16
+	// row size = numblocks
+	_clBuffer_radixHist1 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 16 * numBlocks, NULL, &clStatus);
+	checkCLStatus(clStatus);
+	_clBuffer_radixHist2 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, (_valueSize + _keySize) * 16 * numBlocks, NULL, &clStatus);
+	checkCLStatus(clStatus);
+
+	// The passes alternate between the pushed buffer and this one, they must not permute in place
+	size_t elementSize = _keysOnly ? _keySize : (_valueSize + _keySize);
+	radixDataB = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, elementSize * _capacity, NULL, &clStatus);
+	checkCLStatus(clStatus);
 
-	//---- Prepare some buffers
-	if (reallocate)
+	if (hostDataSet)
 	{
-		//---- Release
-		if (_clBuffer_dataSet)
-		{
-			clReleaseMemObject(_clBuffer_dataSet);
-			clReleaseMemObject(_clBuffer_dataSetOut);
-			clReleaseMemObject(_clBuffer_radixHist1);
-			clReleaseMemObject(_clBuffer_radixHist2);
-		}
-
-		//---- Allocate
-		unsigned int numBlocks = roundUpDiv(_datasetSize, _workgroupSize * 4);
-
-		// column size = 2^b = 16
-		// row size = numblocks
-		_clBuffer_radixHist1 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, sizeof(int) * 16 * numBlocks, NULL, &clStatus);
-		checkCLStatus(clStatus);
-		_clBuffer_radixHist2 = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, (_valueSize + _keySize) * 16 * numBlocks, NULL, &clStatus);
+		_clBuffer_hostDataSet = clCreateBuffer(_context->clContext, CL_MEM_READ_WRITE, elementSize * _capacity, NULL, &clStatus);
 		checkCLStatus(clStatus);
 	}
+}
 
-	_clBuffer_dataSet = clBuffer_dataSet;
-	_clBuffer_dataSetOut = clBuffer_dataSet;
+void clppSort_RadixSortGPU::grow(size_t datasetSize)
+{
+	// Doubling keeps the number of reallocations logarithmic when the sizes vary between the sorts
+	if (datasetSize > _capacity)
+		reserve(max(datasetSize, 2 * _capacity));
+}
+
+void clppSort_RadixSortGPU::freeUpRadixMems()
+{
+	if (_clBuffer_radixHist1)
+		clReleaseMemObject(_clBuffer_radixHist1);
+	if (_clBuffer_radixHist2)
+		clReleaseMemObject(_clBuffer_radixHist2);
+	if (radixDataB)
+		clReleaseMemObject(radixDataB);
+	if (_clBuffer_hostDataSet)
+		clReleaseMemObject(_clBuffer_hostDataSet);
+
+	_clBuffer_radixHist1 = NULL;
+	_clBuffer_radixHist2 = NULL;
+	radixDataB = NULL;
+	_clBuffer_hostDataSet = NULL;
+	_capacity = 0;
 }
 
 #pragma endregion
@@ -340,9 +347,9 @@ void clppSort_RadixSortGPU::popDatas()
 {
 	cl_int clStatus;
 	if (_keysOnly)
-		clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSetOut, CL_TRUE, 0, _keySize * _datasetSize, _dataSetOut, 0, NULL, NULL);
+		clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSet, CL_TRUE, 0, _keySize * _datasetSize, _dataSetOut, 0, NULL, NULL);
 	else
-		clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSetOut, CL_TRUE, 0, (_valueSize + _keySize) * _datasetSize, _dataSetOut, 0, NULL, NULL);
+		clStatus = clEnqueueReadBuffer(_context->clQueue, _clBuffer_dataSet, CL_TRUE, 0, (_valueSize + _keySize) * _datasetSize, _dataSetOut, 0, NULL, NULL);
 	checkCLStatus(clStatus);
 }
 
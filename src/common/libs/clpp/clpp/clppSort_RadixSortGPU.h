@@ -19,6 +19,10 @@ public:
 
 	void popDatas();
 
+	// Allocates the device buffers for data sets of up to maxElements, they never shrink.
+	// Pushing a larger data set grows them geometrically.
+	void reserve(size_t maxElements);
+
 	string compilePreprocess(string kernel);
 
 private:
@@ -39,6 +43,7 @@ private:
 	void radixLocal(const size_t* global, const size_t* local, cl_mem data, cl_mem hist, cl_mem blockHists, int bitOffset);
 	void localHistogram(const size_t* global, const size_t* local, cl_mem data, cl_mem hist, cl_mem blockHists, int bitOffset);
 	void radixPermute(const size_t* global, const size_t* local, cl_mem dataIn, cl_mem dataOut, cl_mem histScan, cl_mem blockHists, int bitOffset, unsigned int numBlocks);
+	void grow(size_t datasetSize);
 	void freeUpRadixMems();
 
 	clppScan* _scan;
@@ -46,8 +51,9 @@ private:
 	cl_mem _clBuffer_radixHist1;
 	cl_mem _clBuffer_radixHist2;
 	cl_mem radixDataB;
+	cl_mem _clBuffer_hostDataSet;	// Device copy of the data set given to pushDatas
 
-	bool _is_clBuffersOwner;
+	size_t _capacity;		// The number of elements the buffers can hold
 };
 
 #endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include <math.h>
 #include <time.h>
+#include <vector>
 
 #ifdef WIN32
 #include "stdafx.h"
@@ -20,7 +21,7 @@ DWORD GetTickCount() {
         //error
         return -1;
     }
-    return ts.tv_sec*1000;
+    return ts.tv_sec*1000 + ts.tv_nsec/1000000;
 }
 
 #endif
@@ -29,6 +30,7 @@ DWORD GetTickCount() {
 
 #include "sort/oclRadixSort.h"
 #include "phys/oclFluid3D.h"
+#include "phys/oclFluid3DHost.h"
 #include "geom/oclBvhTrimesh.h"
 
 #include "filter/oclRecursiveGaussian.h"
@@ -44,12 +46,19 @@ DWORD GetTickCount() {
 #include "image/oclToneMapping.h"
 #include "image/oclBloom.h"
 #include "image/oclAmbientOcclusion.h"
+#include "image/oclPipeline.h"
 
 
 void testRadixSort(oclContext& iContext);
 void testFluid3D0(oclContext& iContext);
 void testFluid3D1(oclContext& iContext);
+void testFluidBinning(oclContext& iContext);
+void testFluidHost(oclContext& iContext);
 void testBvhTrimesh(oclContext& iContext);
+void testBvhQuality(oclContext& iContext);
+void testFilterTiled(oclContext& iContext);
+void testPipeline(oclContext& iContext);
+void testPyramid(oclContext& iContext);
 void testCompile(oclContext& iContext);
 
 
@@ -115,10 +124,34 @@ int main(int argc, char* argv[])
     testFluid3D1(*lContext);
     Log(INFO) << "****** done\n";
 
+    Log(INFO) << "****** calling fluid binning benchmark ...";
+    testFluidBinning(*lContext);
+    Log(INFO) << "****** done\n";
+
+    Log(INFO) << "****** calling fluid host backend comparison ...";
+    testFluidHost(*lContext);
+    Log(INFO) << "****** done\n";
+
     Log(INFO) << "****** calling BVH construction ...";
     testBvhTrimesh(*lContext);
     Log(INFO) << "****** done\n";
 
+    Log(INFO) << "****** calling BVH quality comparison ...";
+    testBvhQuality(*lContext);
+    Log(INFO) << "****** done\n";
+
+    Log(INFO) << "****** calling tiled filter comparison ...";
+    testFilterTiled(*lContext);
+    Log(INFO) << "****** done\n";
+
+    Log(INFO) << "****** calling fused pipeline comparison ...";
+    testPipeline(*lContext);
+    Log(INFO) << "****** done\n";
+
+    Log(INFO) << "****** calling shared pyramid comparison ...";
+    testPyramid(*lContext);
+    Log(INFO) << "****** done\n";
+
     Log(INFO) << "****** compiling all ...";
     testCompile(*lContext);
     Log(INFO) << "****** done\n";
@@ -342,6 +375,173 @@ void testFluid3D1(oclContext& iContext)
     }
 }
 
+//
+// Fluid3D binning, radix sort vs. counting sort
+//
+
+void testFluidBinning(oclContext& iContext)
+{
+    oclDevice& lDevice = iContext.getDevice(0);
+
+    oclFluid3D clProgram(iContext);
+    if (!clProgram.compile())
+    {
+        return;
+    }
+
+    for (unsigned int lCount = 65536; lCount <= 4194304; lCount *= 4)
+    {
+        clProgram.setParticleCount(lCount);
+
+        for (int lCounting = 0; lCounting < 2; lCounting++)
+        {
+            oclBuffer* lBuffer = clProgram.getPositionBuffer();
+            if (lBuffer->map(CL_MAP_WRITE))
+            {
+                // same particle positions for both binning methods
+                srand(lCount);
+                cl_float4* lPtr = lBuffer->ptr<cl_float4>();
+                for (unsigned int i=0; i<lCount; i++)
+                {
+                    lPtr[i].s[0] = (float)rand()/RAND_MAX-0.5;
+                    lPtr[i].s[1] = (float)rand()/RAND_MAX-0.5;
+                    lPtr[i].s[2] = (float)rand()/RAND_MAX-0.5;
+                    lPtr[i].s[3] = 0;
+                }
+                lBuffer->unmap();
+            }
+
+            clProgram.setCountingSort(lCounting != 0);
+            clProgram.compute(lDevice);
+            clFinish(lDevice);
+
+            const int lSteps = 10;
+            DWORD lStart = GetTickCount();
+            for (int i=0; i<lSteps; i++)
+            {
+                clProgram.compute(lDevice);
+            }
+            clFinish(lDevice);
+            DWORD lTime = GetTickCount() - lStart;
+
+            Log(INFO) << lCount << " particles, " << (lCounting ? "counting sort" : "radix sort") << ": " << (float)lTime/lSteps << " ms per step";
+        }
+    }
+}
+
+//
+// Fluid3D host backend against OpenCL
+//
+
+void testFluidHost(oclContext& iContext)
+{
+    oclDevice& lDevice = iContext.getDevice(0);
+
+    oclFluid3D clDevice(iContext);
+    oclFluid3D clHost(iContext, oclFluid3D::BACKEND_HOST);
+    if (!clDevice.compile() || !clHost.compile())
+    {
+        return;
+    }
+
+    const unsigned int lCount = 65536;
+    oclFluid3D* lFluids[2] = { &clDevice, &clHost };
+    DWORD lTime[2];
+    for (int f=0; f<2; f++)
+    {
+        lFluids[f]->setParticleCount(lCount);
+
+        oclBuffer* lBuffer = lFluids[f]->getPositionBuffer();
+        if (lBuffer->map(CL_MAP_WRITE))
+        {
+            srand(lCount);
+            cl_float4* lPtr = lBuffer->ptr<cl_float4>();
+            for (unsigned int i=0; i<lCount; i++)
+            {
+                lPtr[i].s[0] = (float)rand()/RAND_MAX-0.5;
+                lPtr[i].s[1] = (float)rand()/RAND_MAX-0.5;
+                lPtr[i].s[2] = (float)rand()/RAND_MAX-0.5;
+                lPtr[i].s[3] = 0;
+            }
+            lBuffer->unmap();
+        }
+
+        DWORD lStart = GetTickCount();
+        for (int i=0; i<10; i++)
+        {
+            lFluids[f]->compute(lDevice);
+        }
+        clFinish(lDevice);
+        lTime[f] = GetTickCount() - lStart;
+    }
+
+    oclBuffer* lDevicePosition = clDevice.getPositionBuffer();
+    oclBuffer* lHostPosition = clHost.getPositionBuffer();
+    if (lDevicePosition->map(CL_MAP_READ) && lHostPosition->map(CL_MAP_READ))
+    {
+        float lError = 0;
+        cl_float4* lDevicePtr = lDevicePosition->ptr<cl_float4>();
+        cl_float4* lHostPtr = lHostPosition->ptr<cl_float4>();
+        for (unsigned int i=0; i<lCount; i++)
+        {
+            for (int k=0; k<3; k++)
+            {
+                float lDiff = fabs(lDevicePtr[i].s[k] - lHostPtr[i].s[k]);
+                if (lDiff > lError)
+                {
+                    lError = lDiff;
+                }
+            }
+        }
+        Log(INFO) << "OpenCL " << lTime[0] << " ms, host " << lTime[1] << " ms, max position difference = " << lError;
+        lDevicePosition->unmap();
+        lHostPosition->unmap();
+    }
+
+    // host steps with the single and the multi-threaded cell sort, both have to bin the same order
+    oclFluid3D::Params lParams;
+    oclFluid3DHost::initParameters(lParams);
+    cl_float4* lPosition = new cl_float4[lCount];
+    cl_float4* lVelocity = new cl_float4[lCount];
+    cl_float4* lForce = new cl_float4[lCount];
+    cl_uint* lIndex[2] = { new cl_uint[lCount], new cl_uint[lCount] };
+    DWORD lSortTime[2];
+    for (int lParallel=0; lParallel<2; lParallel++)
+    {
+        srand(lCount);
+        for (unsigned int i=0; i<lCount; i++)
+        {
+            lPosition[i].s[0] = (float)rand()/RAND_MAX-0.5;
+            lPosition[i].s[1] = (float)rand()/RAND_MAX-0.5;
+            lPosition[i].s[2] = (float)rand()/RAND_MAX-0.5;
+            lPosition[i].s[3] = 0;
+            lVelocity[i].s[0] = lVelocity[i].s[1] = lVelocity[i].s[2] = lVelocity[i].s[3] = 0;
+        }
+
+        oclFluid3DHost lHost;
+        lHost.setParallelSort(lParallel != 0);
+        lHost.setParticleCount(lCount);
+        DWORD lStart = GetTickCount();
+        for (int i=0; i<10; i++)
+        {
+            lHost.compute(lPosition, lVelocity, lForce, lParams, true);
+        }
+        lSortTime[lParallel] = GetTickCount() - lStart;
+        lHost.getSorted(lPosition, lVelocity, lIndex[lParallel]);
+    }
+    size_t lMismatch = 0;
+    for (unsigned int i=0; i<lCount; i++)
+    {
+        lMismatch += (lIndex[0][i] != lIndex[1][i]);
+    }
+    Log(INFO) << "host " << lSortTime[0] << " ms with a serial sort, " << lSortTime[1] << " ms with a parallel sort, " << lMismatch << " differently sorted particles";
+    delete [] lPosition;
+    delete [] lVelocity;
+    delete [] lForce;
+    delete [] lIndex[0];
+    delete [] lIndex[1];
+}
+
 //
 // Test BvhTrimesh
 //
@@ -400,6 +600,27 @@ void testBvhTrimesh(oclContext& iContext)
                 Log(INFO) << "BVH Root (right):" << lPtr[lRootNode].right;
                 lNodes.unmap();
             }
+
+            // animate the vertices and refit the hierarchy
+            Log(INFO) << "BVH SAH cost (build):" << clProgram.getSahCost();
+            for (int f=0; f<4; f++)
+            {
+                if (bfVertex.map(CL_MAP_WRITE))
+                {
+                    cl_float4* lPtr = bfVertex.ptr<cl_float4>();
+                    for (unsigned int i=0; i<1000; i++)
+                    {
+                        lPtr[i].s[0] += 0.05f*((float)rand()/RAND_MAX-0.5f);
+                        lPtr[i].s[1] += 0.05f*((float)rand()/RAND_MAX-0.5f);
+                        lPtr[i].s[2] += 0.05f*((float)rand()/RAND_MAX-0.5f);
+                    }
+                    bfVertex.unmap();
+                }
+                if (clProgram.refit(lDevice, bfVertex, bfIndex))
+                {
+                    Log(INFO) << "BVH SAH cost (refit " << f << "):" << clProgram.getSahCost();
+                }
+            }
         } else {
             Log(ERR) << "Something Failed, if running on AMD it's OK\n";
         }
@@ -408,6 +629,509 @@ void testBvhTrimesh(oclContext& iContext)
 
 
 
+//
+// BVH build time against traversal time for the Morton code and treelet options
+//
+
+static int traverseBvh(const oclBvhTrimesh::BVHNode* iNodes, cl_uint iRoot, const cl_float4& iMin, const cl_float4& iMax)
+{
+    // degenerate meshes can produce deep trees, so the stack grows on demand
+    std::vector<cl_uint> lStack;
+    int lVisited = 0;
+    lStack.push_back(iRoot);
+    while (!lStack.empty())
+    {
+        const oclBvhTrimesh::BVHNode& lNode = iNodes[lStack.back()];
+        lStack.pop_back();
+        lVisited++;
+        if (lNode.bbMin.s[0] > iMax.s[0] || lNode.bbMax.s[0] < iMin.s[0] ||
+            lNode.bbMin.s[1] > iMax.s[1] || lNode.bbMax.s[1] < iMin.s[1] ||
+            lNode.bbMin.s[2] > iMax.s[2] || lNode.bbMax.s[2] < iMin.s[2])
+        {
+            continue;
+        }
+        if (lNode.left != lNode.right)
+        {
+            lStack.push_back(lNode.left);
+            lStack.push_back(lNode.right);
+        }
+    }
+    return lVisited;
+}
+
+void testBvhQuality(oclContext& iContext)
+{
+    oclDevice& lDevice = iContext.getDevice(0);
+
+    // clustered mesh, most triangles are small and close together
+    const unsigned int lTriangles = 262144;
+    oclBuffer bfVertex(iContext, "bfVertex");
+    bfVertex.create<cl_float4> (CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lTriangles*3);
+    if (bfVertex.map(CL_MAP_WRITE))
+    {
+        cl_float4* lPtr = bfVertex.ptr<cl_float4>();
+        for (unsigned int i=0; i<lTriangles; i++)
+        {
+            float lCluster = (float)(i%8)/8.0f;
+            float lX = lCluster + 0.02f*((float)rand()/RAND_MAX);
+            float lY = lCluster + 0.02f*((float)rand()/RAND_MAX);
+            float lZ = (float)rand()/RAND_MAX;
+            for (int j=0; j<3; j++)
+            {
+                lPtr[i*3+j].s[0] = lX + 0.001f*((float)rand()/RAND_MAX);
+                lPtr[i*3+j].s[1] = lY + 0.001f*((float)rand()/RAND_MAX);
+                lPtr[i*3+j].s[2] = lZ + 0.001f*((float)rand()/RAND_MAX);
+                lPtr[i*3+j].s[3] = 1;
+            }
+        }
+        bfVertex.unmap();
+    }
+    else return;
+
+    oclBuffer bfIndex(iContext, "bfIndex");
+    bfIndex.create<cl_uint> (CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lTriangles*3);
+    if (bfIndex.map(CL_MAP_WRITE))
+    {
+        cl_uint* lPtr = bfIndex.ptr<cl_uint>();
+        for (unsigned int i=0; i<lTriangles*3; i++)
+        {
+            lPtr[i] = i;
+        }
+        bfIndex.unmap();
+    }
+    else return;
+
+    oclBvhTrimesh clProgram(iContext);
+    if (!clProgram.compile())
+    {
+        return;
+    }
+
+    const char* lNames[] = { "30 bit", "63 bit", "63 bit + treelets" };
+    for (int lConfig = 0; lConfig < 3; lConfig++)
+    {
+        clProgram.setMortonCode64(lConfig > 0);
+        clProgram.setTreeletPasses(lConfig == 2 ? 3 : 0);
+        if (!clProgram.compute(lDevice, bfVertex, bfIndex))
+        {
+            Log(ERR) << "Something Failed, if running on AMD it's OK\n";
+            return;
+        }
+        clFinish(lDevice);
+
+        const int lBuilds = 10;
+        DWORD lStart = GetTickCount();
+        for (int i=0; i<lBuilds; i++)
+        {
+            clProgram.compute(lDevice, bfVertex, bfIndex);
+        }
+        clFinish(lDevice);
+        DWORD lBuildTime = GetTickCount() - lStart;
+
+        // box queries around random triangles
+        int lVisited = 0;
+        DWORD lTraversalTime = 0;
+        oclBuffer& lNodes = clProgram.getNodeBuffer();
+        if (lNodes.map(CL_MAP_READ) && bfVertex.map(CL_MAP_READ))
+        {
+            const oclBvhTrimesh::BVHNode* lPtr = lNodes.ptr<oclBvhTrimesh::BVHNode>();
+            const cl_float4* lVertex = bfVertex.ptr<cl_float4>();
+            srand(1);
+            lStart = GetTickCount();
+            for (int i=0; i<100000; i++)
+            {
+                cl_float4 lMin = lVertex[(rand()%lTriangles)*3];
+                cl_float4 lMax = lMin;
+                for (int j=0; j<3; j++)
+                {
+                    lMin.s[j] -= 0.005f;
+                    lMax.s[j] += 0.005f;
+                }
+                lVisited += traverseBvh(lPtr, clProgram.getRootNode(), lMin, lMax);
+            }
+            lTraversalTime = GetTickCount() - lStart;
+            bfVertex.unmap();
+            lNodes.unmap();
+        }
+
+        Log(INFO) << lNames[lConfig] << ": build " << (float)lBuildTime/lBuilds << " ms, SAH cost " << clProgram.getSahCost() 
+                  << ", traversal " << lTraversalTime << " ms for 100000 queries (" << lVisited/100000 << " nodes per query)";
+    }
+}
+
+//
+// Tiled convolution and bilateral filter against the untiled kernels
+//
+
+static bool readImage(oclDevice& iDevice, oclImage2D& iImage, cl_float4* oPixels, size_t iW, size_t iH)
+{
+    size_t lOrigin[3] = { 0, 0, 0 };
+    size_t lRegion[3] = { iW, iH, 1 };
+    return clEnqueueReadImage(iDevice, iImage, CL_TRUE, lOrigin, lRegion, 0, 0, oPixels, 0, NULL, NULL) == CL_SUCCESS;
+}
+
+static float maxError(const cl_float4* iA, const cl_float4* iB, size_t iCount)
+{
+    float lError = 0;
+    for (size_t i=0; i<iCount; i++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            float lDiff = fabs(iA[i].s[c] - iB[i].s[c]);
+            lError = lDiff > lError ? lDiff : lError;
+        }
+    }
+    return lError;
+}
+
+void testFilterTiled(oclContext& iContext)
+{
+    oclDevice& lDevice = iContext.getDevice(0);
+
+    const size_t lW = 2048;
+    const size_t lH = 2048;
+    cl_float4* lPixels = new cl_float4[lW*lH];
+    cl_float4* lResultA = new cl_float4[lW*lH];
+    cl_float4* lResultB = new cl_float4[lW*lH];
+    for (size_t i=0; i<lW*lH; i++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            lPixels[i].s[c] = (float)rand()/RAND_MAX;
+        }
+    }
+
+    cl_image_format lFormat = { CL_RGBA, CL_FLOAT };
+    oclImage2D bfSrce(iContext, "bfSrce");
+    oclImage2D bfDest(iContext, "bfDest");
+    if (!bfSrce.create(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, lFormat, lW, lH, lPixels) ||
+        !bfDest.create(CL_MEM_WRITE_ONLY, lFormat, lW, lH))
+    {
+        delete [] lPixels;
+        delete [] lResultA;
+        delete [] lResultB;
+        return;
+    }
+
+    oclConvolute clConvolute(iContext);
+    oclBilateral clBilateral(iContext);
+    if (clConvolute.compile() && clBilateral.compile())
+    {
+        for (int lRadius = 1; lRadius <= 8; lRadius *= 2)
+        {
+            int lSize = 2*lRadius+1;
+            oclBuffer bfFilter(iContext, "bfFilter");
+            bfFilter.create<cl_float>(CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, lSize*lSize);
+            oclConvolute::gauss2D(lRadius/2.0f+0.5f, bfFilter, lSize, lSize);
+            oclBuffer bfFilter1D(iContext, "bfFilter1D");
+            bfFilter1D.create<cl_float>(CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, lSize);
+            oclConvolute::gauss1D(lRadius/2.0f+0.5f, bfFilter1D);
+            cl_int2 lAxis = { { 0, 1 } };
+            cl_float4 lMask = { { 0.299f, 0.587f, 0.114f, 0.0f } };
+
+            for (int lFilter = 0; lFilter < 3; lFilter++)
+            {
+                DWORD lTime[2];
+                for (int lTiled = 0; lTiled < 2; lTiled++)
+                {
+                    clFinish(lDevice);
+                    DWORD lStart = GetTickCount();
+                    for (int i=0; i<10; i++)
+                    {
+                        switch (lFilter)
+                        {
+                            case 0: clConvolute.iso2D(lDevice, bfSrce, bfDest, bfFilter, lSize, lSize, lTiled != 0); break;
+                            case 1: clConvolute.iso2Dsep(lDevice, bfSrce, bfDest, lAxis, bfFilter1D, lTiled != 0); break;
+                            case 2: clBilateral.iso2D(lDevice, bfSrce, bfDest, lRadius, 0.1f, lMask, lTiled != 0); break;
+                        }
+                    }
+                    clFinish(lDevice);
+                    lTime[lTiled] = GetTickCount() - lStart;
+                    readImage(lDevice, bfDest, lTiled ? lResultB : lResultA, lW, lH);
+                }
+
+                const char* lNames[] = { "iso2D", "iso2Dsep", "bilateral" };
+                Log(INFO) << lNames[lFilter] << " radius " << lRadius << ": " << lTime[0]/10.0f << " ms untiled, " 
+                          << lTime[1]/10.0f << " ms tiled, max error " << maxError(lResultA, lResultB, lW*lH);
+            }
+        }
+    }
+
+    delete [] lPixels;
+    delete [] lResultA;
+    delete [] lResultB;
+}
+
+//
+// Fused pipeline against the separate filter calls
+//
+
+void testPipeline(oclContext& iContext)
+{
+    oclDevice& lDevice = iContext.getDevice(0);
+
+    const size_t lW = 2048;
+    const size_t lH = 2048;
+    cl_float4* lPixels = new cl_float4[lW*lH];
+    cl_float4* lResultA = new cl_float4[lW*lH];
+    cl_float4* lResultB = new cl_float4[lW*lH];
+    for (size_t i=0; i<lW*lH; i++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            lPixels[i].s[c] = (float)rand()/RAND_MAX;
+        }
+    }
+
+    cl_image_format lFormat = { CL_RGBA, CL_FLOAT };
+    oclImage2D bfSrce(iContext, "bfSrce");
+    oclImage2D bfDest(iContext, "bfDest");
+    oclImage2D bfTempA(iContext, "bfTempA");
+    oclImage2D bfTempB(iContext, "bfTempB");
+    oclImage2D bfTempC(iContext, "bfTempC");
+    if (!bfSrce.create(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, lFormat, lW, lH, lPixels) ||
+        !bfDest.create(CL_MEM_READ_WRITE, lFormat, lW, lH) ||
+        !bfTempA.create(CL_MEM_READ_WRITE, lFormat, lW, lH) ||
+        !bfTempB.create(CL_MEM_READ_WRITE, lFormat, lW, lH) ||
+        !bfTempC.create(CL_MEM_READ_WRITE, lFormat, lW, lH))
+    {
+        delete [] lPixels;
+        delete [] lResultA;
+        delete [] lResultB;
+        return;
+    }
+
+    oclColor clColor(iContext);
+    oclQuantize clQuantize(iContext);
+    oclSobel clSobel(iContext);
+    oclTangent clTangent(iContext);
+    oclPipeline clPipeline(iContext);
+    if (clColor.compile() && clQuantize.compile() && clSobel.compile() && clTangent.compile())
+    {
+        for (int lGraph = 0; lGraph < 2; lGraph++)
+        {
+            // RGBtoLAB -> quantize -> LABtoRGB, and sobel -> tangent -> line convolution of the same
+            clPipeline.clear();
+            if (lGraph == 0)
+            {
+                int lLAB = clPipeline.RGBtoLAB(oclPipeline::cSource);
+                clPipeline.LABtoRGB(clPipeline.quantizeLAB(lLAB, 10.0f, 20.0f, 20.0f, 3.0f));
+            }
+            else
+            {
+                int lDx = clPipeline.sobel(oclPipeline::cSource);
+                int lTangent = clPipeline.tangent(lDx, lDx+1);
+                clPipeline.lineConv(lTangent, oclPipeline::cSource, 8);
+            }
+            if (!clPipeline.compile())
+            {
+                break;
+            }
+
+            DWORD lTime[2];
+            for (int lFused = 0; lFused < 2; lFused++)
+            {
+                clFinish(lDevice);
+                DWORD lStart = GetTickCount();
+                for (int i=0; i<10; i++)
+                {
+                    if (lFused)
+                    {
+                        clPipeline.compute(lDevice, bfSrce, bfDest);
+                    }
+                    else if (lGraph == 0)
+                    {
+                        clColor.RGBtoLAB(lDevice, bfSrce, bfTempA);
+                        clQuantize.quantizeLAB(lDevice, bfTempA, bfTempB, 10.0f, 20.0f, 20.0f, 3.0f);
+                        clColor.LABtoRGB(lDevice, bfTempB, bfDest);
+                    }
+                    else
+                    {
+                        clSobel.compute(lDevice, bfSrce, bfTempA, bfTempB);
+                        clTangent.compute(lDevice, bfTempA, bfTempB, bfTempC);
+                        clTangent.lineConv(lDevice, bfTempC, bfSrce, bfDest, 8);
+                    }
+                }
+                clFinish(lDevice);
+                lTime[lFused] = GetTickCount() - lStart;
+                readImage(lDevice, bfDest, lFused ? lResultB : lResultA, lW, lH);
+            }
+
+            const char* lNames[] = { "LAB quantize", "line convolution" };
+            Log(INFO) << lNames[lGraph] << ": " << lTime[0]/10.0f << " ms separate, " << lTime[1]/10.0f << " ms pipeline ("
+                      << clPipeline.getKernelCount() << " fused kernels, " << clPipeline.getImageCount() << " pooled images), max error " 
+                      << maxError(lResultA, lResultB, lW*lH);
+        }
+    }
+
+    delete [] lPixels;
+    delete [] lResultA;
+    delete [] lResultB;
+}
+
+//
+// Partial pyramid regeneration and a tone mapping + bloom frame sharing one pyramid
+//
+
+static size_t compareLevels(oclDevice& iDevice, oclBilinearPyramid& iA, oclBilinearPyramid& iB)
+{
+    size_t lMismatch = 0;
+    for (unsigned int l=0; l<iA.getLevelCount(); l++)
+    {
+        size_t lLw = iA.getLevel(l)->dim(0);
+        size_t lLh = iA.getLevel(l)->dim(1);
+        cl_ushort* lA = new cl_ushort[lLw*lLh*4];
+        cl_ushort* lB = new cl_ushort[lLw*lLh*4];
+        size_t lLevelRegion[3] = { lLw, lLh, 1 };
+        size_t lZero[3] = { 0, 0, 0 };
+        clEnqueueReadImage(iDevice, *iA.getLevel(l), CL_TRUE, lZero, lLevelRegion, 0, 0, lA, 0, NULL, NULL);
+        clEnqueueReadImage(iDevice, *iB.getLevel(l), CL_TRUE, lZero, lLevelRegion, 0, 0, lB, 0, NULL, NULL);
+        for (size_t i=0; i<lLw*lLh*4; i++)
+        {
+            lMismatch += (lA[i] != lB[i]);
+        }
+        delete [] lA;
+        delete [] lB;
+    }
+    return lMismatch;
+}
+
+void testPyramid(oclContext& iContext)
+{
+    oclDevice& lDevice = iContext.getDevice(0);
+
+    const size_t lW = 1920;
+    const size_t lH = 1080;
+    cl_float4* lPixels = new cl_float4[lW*lH];
+    for (size_t i=0; i<lW*lH; i++)
+    {
+        for (int c=0; c<4; c++)
+        {
+            lPixels[i].s[c] = 2.0f*rand()/RAND_MAX;
+        }
+    }
+
+    cl_image_format lFormat = { CL_RGBA, CL_FLOAT };
+    oclImage2D bfSrce(iContext, "bfSrce");
+    oclImage2D bfDest(iContext, "bfDest");
+    oclImage2D bfGlow(iContext, "bfGlow");
+    if (!bfSrce.create(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, lFormat, lW, lH, lPixels) ||
+        !bfDest.create(CL_MEM_READ_WRITE, lFormat, lW, lH) ||
+        !bfGlow.create(CL_MEM_READ_WRITE, lFormat, lW, lH))
+    {
+        delete [] lPixels;
+        return;
+    }
+
+    oclBilinearPyramid clPartial(iContext);
+    oclBilinearPyramid clFull(iContext);
+    if (clPartial.compile() && clFull.compile())
+    {
+        // change a 64x64 block of the source and regenerate only its footprint
+        clPartial.update(lDevice, bfSrce);
+        for (size_t i=0; i<64*64; i++)
+        {
+            lPixels[i].s[0] = lPixels[i].s[1] = lPixels[i].s[2] = 4.0f;
+        }
+        size_t lOrigin[3] = { 300, 200, 0 };
+        size_t lRegion[3] = { 64, 64, 1 };
+        clEnqueueWriteImage(lDevice, bfSrce, CL_TRUE, lOrigin, lRegion, 0, 0, lPixels, 0, NULL, NULL);
+
+        clFinish(lDevice);
+        DWORD lStart = GetTickCount();
+        for (int i=0; i<10; i++)
+        {
+            clPartial.invalidate(300, 200, 64, 64);
+            clPartial.update(lDevice, bfSrce);
+        }
+        clFinish(lDevice);
+        DWORD lPartialTime = GetTickCount() - lStart;
+
+        lStart = GetTickCount();
+        for (int i=0; i<10; i++)
+        {
+            clFull.compute(lDevice, bfSrce);
+        }
+        clFinish(lDevice);
+        DWORD lFullTime = GetTickCount() - lStart;
+
+        // both pyramids have to match bit for bit
+        size_t lMismatch = compareLevels(lDevice, clPartial, clFull);
+        Log(INFO) << "pyramid update of a 64x64 block: " << lPartialTime/10.0f << " ms, full build " << lFullTime/10.0f 
+                  << " ms, " << lMismatch << " differing texel channels";
+    }
+
+    // one frame of tone mapping and bloom, with and without a shared pyramid
+    oclBilinearPyramid clShared(iContext);
+    oclToneMapping clToneMapping(iContext);
+    oclBloom clBloom(iContext);
+    oclToneMapping clSharedToneMapping(iContext, &clShared);
+    oclBloom clSharedBloom(iContext, lFormat, &clShared);
+    if (clShared.compile() && clToneMapping.compile() && clBloom.compile() && clSharedToneMapping.compile() && clSharedBloom.compile())
+    {
+        clBloom.setPyramidGlow(true);
+        clSharedBloom.setPyramidGlow(true);
+
+        DWORD lTime[2];
+        for (int lMode = 0; lMode < 2; lMode++)
+        {
+            clFinish(lDevice);
+            DWORD lStart = GetTickCount();
+            for (int i=0; i<10; i++)
+            {
+                if (lMode)
+                {
+                    clShared.invalidate();
+                    clSharedBloom.compute(lDevice, bfSrce, bfGlow);
+                    clSharedToneMapping.compute(lDevice, bfSrce, bfDest);
+                }
+                else
+                {
+                    clBloom.compute(lDevice, bfSrce, bfGlow);
+                    clToneMapping.compute(lDevice, bfSrce, bfDest);
+                }
+            }
+            clFinish(lDevice);
+            lTime[lMode] = GetTickCount() - lStart;
+        }
+        Log(INFO) << "tone mapping + bloom: " << lTime[0]/10.0f << " ms separate, " << lTime[1]/10.0f << " ms with a shared pyramid";
+
+        // the next frame rewrites the same image, the shared levels have to follow it once invalidated
+        oclBilinearPyramid clReference(iContext);
+        if (clReference.compile())
+        {
+            clReference.compute(lDevice, bfSrce);
+            for (size_t i=0; i<lW*lH; i++)
+            {
+                for (int c=0; c<3; c++)
+                {
+                    lPixels[i].s[c] = 2.0f - lPixels[i].s[c];
+                }
+            }
+            size_t lOrigin[3] = { 0, 0, 0 };
+            size_t lRegion[3] = { lW, lH, 1 };
+            clEnqueueWriteImage(lDevice, bfSrce, CL_TRUE, lOrigin, lRegion, 0, 0, lPixels, 0, NULL, NULL);
+
+            clShared.invalidate();
+            clSharedBloom.compute(lDevice, bfSrce, bfGlow);
+            clSharedToneMapping.compute(lDevice, bfSrce, bfDest);
+            size_t lChanged = compareLevels(lDevice, clShared, clReference);
+            clReference.compute(lDevice, bfSrce);
+            size_t lStale = compareLevels(lDevice, clShared, clReference);
+            if (!lChanged || lStale)
+            {
+                Log(ERR) << "shared pyramid did not follow the rewritten source: " << lChanged << " changed, " << lStale << " stale texel channels";
+            }
+            else
+            {
+                Log(INFO) << "shared pyramid after rewriting the source: " << lChanged << " changed texel channels, none stale";
+            }
+        }
+    }
+
+    delete [] lPixels;
+}
+
 
 void testCompile(oclContext& iContext)
 {
@@ -440,4 +1164,6 @@ void testCompile(oclContext& iContext)
     clBloom.compile();
     oclAmbientOcclusion clAmbientOcclusion(iContext);
     clAmbientOcclusion.compile();
+    oclPipeline clPipeline(iContext);
+    clPipeline.compile();
 }
@@ -60,6 +60,67 @@ __kernel void clIso2D(__read_only image2d_t imageIn, __write_only image2d_t imag
     }
 }
 
+//
+// Tiled bilateral filter, compiled per filter RADIUS, each work group loads 
+// its tile and apron into local memory once
+//
+
+#ifdef RADIUS
+
+#ifndef TILE_SIZE
+#define TILE_SIZE 16
+#endif
+
+#define APRON (TILE_SIZE+2*RADIUS)
+
+__kernel __attribute__((reqd_work_group_size(TILE_SIZE, TILE_SIZE, 1)))
+void clIso2Dtiled(__read_only image2d_t imageIn, __write_only image2d_t imageOut, float range, float4 mask, int w, int h)
+{
+    const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP_TO_EDGE;
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int ox = mul24(get_group_id(0), TILE_SIZE) - RADIUS;
+    int oy = mul24(get_group_id(1), TILE_SIZE) - RADIUS;
+
+    __local float4 tile[APRON][APRON];
+    for (int j=ly; j<APRON; j+=TILE_SIZE)
+    {
+        for (int i=lx; i<APRON; i+=TILE_SIZE)
+        {
+            tile[j][i] = read_imagef(imageIn, sampler, (int2)(ox+i, oy+j));
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int x = ox + RADIUS + lx;
+    int y = oy + RADIUS + ly;
+    if (x < w && y < h) 
+    {
+        float4 nom = 0.0f;
+        float4 den = 0.0f;
+        float scalar = 0.5/(range*range);
+
+        float4 dc = tile[ly+RADIUS][lx+RADIUS];
+        #pragma unroll
+        for (int i=0; i<=2*RADIUS; i++)
+        {
+            #pragma unroll
+            for (int j=0; j<=2*RADIUS; j++)
+            {
+                float4 dp = tile[ly+i][lx+j];
+
+                float factor = gaussian(dc,dp,mask,scalar);
+                nom += dp * factor;
+                den += factor;
+            }
+        }
+
+        write_imagef(imageOut, (int2)(x,y), (float4)(nom/den));
+    }
+}
+
+#endif
+
 __kernel void clAniso2Dtang(__read_only image2d_t imageIn, __write_only image2d_t imageOut, int radius, float range, __read_only image2d_t vector, float4 mask, int w, int h)
 {	
     const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP_TO_EDGE;
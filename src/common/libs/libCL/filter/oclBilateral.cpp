@@ -12,16 +12,28 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <math.h>
+#include <stdio.h>
 
 #include "oclBilateral.h"
 
-oclBilateral::oclBilateral(oclContext& iContext)
+const int oclBilateral::cTileSize = 16;
+
+oclBilateral::oclBilateral(oclContext& iContext, int iRadius)
 : oclProgram(iContext, "oclBilateral")
 // kernels
 , clIso2D(*this)
 , clAniso2Dtang(*this)
 , clAniso2Dorth(*this)
+, clIso2Dtiled(*this)
+// members
+, mRadius(iRadius)
 {
+    if (mRadius > 0)
+    {
+        snprintf(mDefines, sizeof(mDefines), "#define RADIUS %d\n#define TILE_SIZE %d\n", mRadius, cTileSize);
+        addSourceCode(mDefines);
+        exportKernel(clIso2Dtiled);
+    }
     addSourceFile("filter/oclBilateral.cl");
 
     exportKernel(clIso2D);
@@ -29,6 +41,14 @@ oclBilateral::oclBilateral(oclContext& iContext)
     exportKernel(clAniso2Dorth);
 }
 
+oclBilateral::~oclBilateral()
+{
+    for (unsigned int i=0; i<mTiled.size(); i++)
+    {
+        delete mTiled[i];
+    }
+}
+
 //
 //
 //
@@ -38,6 +58,7 @@ int oclBilateral::compile()
     clIso2D = 0;
     clAniso2Dtang = 0;
     clAniso2Dorth = 0;
+    clIso2Dtiled = 0;
 
     if (!oclProgram::compile())
     {
@@ -50,17 +71,78 @@ int oclBilateral::compile()
     KERNEL_VALIDATE(clAniso2Dtang)
     clAniso2Dorth = createKernel("clAniso2Dorth");
     KERNEL_VALIDATE(clAniso2Dorth)
+
+    if (mRadius > 0)
+    {
+        clIso2Dtiled = createKernel("clIso2Dtiled");
+        KERNEL_VALIDATE(clIso2Dtiled)
+    }
     return 1;
 }
 
+oclBilateral* oclBilateral::getTiled(oclDevice& iDevice, int iRadius)
+{
+    if (iRadius <= 0)
+    {
+        return 0;
+    }
+    for (unsigned int i=0; i<mTiled.size(); i++)
+    {
+        if (mTiled[i]->mRadius == iRadius)
+        {
+            return mTiled[i];
+        }
+    }
+
+    cl_ulong lLocalMem = 0;
+    clGetDeviceInfo(iDevice, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &lLocalMem, NULL);
+    if ((cTileSize+2*iRadius)*(cTileSize+2*iRadius)*sizeof(cl_float4) > lLocalMem)
+    {
+        Log(WARN, this) << "tile of radius " << iRadius << " exceeds local memory, using untiled kernel";
+        return 0;
+    }
+
+    oclBilateral* lTiled = new oclBilateral(mContext, iRadius);
+    if (!lTiled->compile() || 
+        lTiled->clIso2Dtiled.getKernelWorkGroupInfo<size_t>(CL_KERNEL_WORK_GROUP_SIZE, iDevice) < (size_t)cTileSize*cTileSize)
+    {
+        Log(WARN, this) << "tiled kernel of radius " << iRadius << " not available, using untiled kernel";
+        delete lTiled;
+        return 0;
+    }
+    mTiled.push_back(lTiled);
+    return lTiled;
+}
+
 //
 //
 //
 
-int oclBilateral::iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRadius, cl_float iRange, cl_float4 iMask)
+int oclBilateral::iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRadius, cl_float iRange, cl_float4 iMask, bool iTiled)
 {
     cl_uint lIw = bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH);
     cl_uint lIh = bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
+
+    oclBilateral* lTiled = iTiled ? getTiled(iDevice, iRadius) : 0;
+    if (lTiled)
+    {
+        size_t lLocalSize[2] = { cTileSize, cTileSize };
+        size_t lGlobalSize[2];
+        lGlobalSize[0] = ((lIw+cTileSize-1)/cTileSize)*cTileSize;
+        lGlobalSize[1] = ((lIh+cTileSize-1)/cTileSize)*cTileSize;
+
+        oclKernel& lKernel = lTiled->clIso2Dtiled;
+        clSetKernelArg(lKernel, 0, sizeof(cl_mem), bfSrce);
+        clSetKernelArg(lKernel, 1, sizeof(cl_mem), bfDest);
+        clSetKernelArg(lKernel, 2, sizeof(cl_float), &iRange);
+        clSetKernelArg(lKernel, 3, sizeof(cl_float4), &iMask);
+        clSetKernelArg(lKernel, 4, sizeof(cl_uint), &lIw);
+        clSetKernelArg(lKernel, 5, sizeof(cl_uint), &lIh);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, lKernel, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, lKernel.getEvent());
+        ENQUEUE_VALIDATE
+        return true;
+    }
+
     size_t lGlobalSize[2];
     size_t lLocalSize[2];
     clIso2D.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
@@ -22,19 +22,32 @@ class oclBilateral : public oclProgram
 {
     public: 
 
-        oclBilateral(oclContext& iContext);
+        // a radius compiles the tiled kernel for this filter size only
+        oclBilateral(oclContext& iContext, int iRadius = 0);
+       ~oclBilateral();
 
         int compile();
 
-        int iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRadius, cl_float iRange, cl_float4 iMask);
+        // tiled calls stage the image in local memory through a program 
+        // compiled for the radius
+        int iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRadius, cl_float iRange, cl_float4 iMask, bool iTiled = false);
         int aniso2Dtang(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRadius, cl_float iRange, oclImage2D& bfVector, cl_float4 iMask);
         int aniso2Dorth(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRadius, cl_float iRange, oclImage2D& bfVector, cl_float4 iMask);
 
     protected:
 
+        static const int cTileSize;
+
+        oclBilateral* getTiled(oclDevice& iDevice, int iRadius);
+
         oclKernel clIso2D;
         oclKernel clAniso2Dtang;
         oclKernel clAniso2Dorth;
+        oclKernel clIso2Dtiled;
+
+        int mRadius;
+        char mDefines[64];
+        vector<oclBilateral*> mTiled;
 };      
 
 #endif
\ No newline at end of file
@@ -13,12 +13,15 @@
 // limitations under the License.
 
 
-__kernel void clDownsample(__read_only image2d_t imageIn, __write_only image2d_t imageOut, int imgw, int imgh)
+// imgw, imgh is the size of imageOut, only the region at ox, oy of size rw, rh is written
+__kernel void clDownsample(__read_only image2d_t imageIn, __write_only image2d_t imageOut, int imgw, int imgh, int ox, int oy, int rw, int rh)
 {
     const sampler_t sampler = CLK_NORMALIZED_COORDS_TRUE | CLK_FILTER_LINEAR | CLK_ADDRESS_CLAMP_TO_EDGE;
-    int x = mul24(get_group_id(0), get_local_size(0)) + get_local_id(0);
-    int y = mul24(get_group_id(1), get_local_size(1)) + get_local_id(1);
-    if (x < imgw && y < imgh) 
+    int rx = mul24(get_group_id(0), get_local_size(0)) + get_local_id(0);
+    int ry = mul24(get_group_id(1), get_local_size(1)) + get_local_id(1);
+    int x = ox + rx;
+    int y = oy + ry;
+    if (rx < rw && ry < rh && x < imgw && y < imgh) 
     {
         float dw = 1.0/imgw;
         float dh = 1.0/imgh;
@@ -29,12 +32,14 @@ __kernel void clDownsample(__read_only image2d_t imageIn, __write_only image2d_t
     }
 }
 
-__kernel void clUpsample(__read_only image2d_t imageIn, __write_only image2d_t imageOut, int imgw, int imgh)
+__kernel void clUpsample(__read_only image2d_t imageIn, __write_only image2d_t imageOut, int imgw, int imgh, int ox, int oy, int rw, int rh)
 {
     const sampler_t sampler = CLK_NORMALIZED_COORDS_TRUE | CLK_FILTER_LINEAR | CLK_ADDRESS_CLAMP_TO_EDGE;
-    int x = mul24(get_group_id(0), get_local_size(0)) + get_local_id(0);
-    int y = mul24(get_group_id(1), get_local_size(1)) + get_local_id(1);
-    if (x < imgw && y < imgh) 
+    int rx = mul24(get_group_id(0), get_local_size(0)) + get_local_id(0);
+    int ry = mul24(get_group_id(1), get_local_size(1)) + get_local_id(1);
+    int x = ox + rx;
+    int y = oy + ry;
+    if (rx < rw && ry < rh && x < imgw && y < imgh) 
     {
         float dw = 1.0/imgw;
         float dh = 1.0/imgh;
@@ -20,16 +20,21 @@ oclBilinearPyramid::oclBilinearPyramid(oclContext& iContext)
 // kernels
 , clUpsample(*this)
 , clDownsample(*this)
-, mLevel(1)
+, mSource(0)
+, mSourceWidth(0)
+, mSourceHeight(0)
 {
     addSourceFile("filter/oclBilinearPyramid.cl");
 
     exportKernel(clUpsample);
     exportKernel(clDownsample);
 
-    cl_image_format lFormat = { CL_RGBA,  CL_HALF_FLOAT };
-    mLevel[0] = new oclImage2D(mContext, "Level");
-    mLevel[0]->create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lFormat, 256, 256);
+    invalidate();
+}
+
+oclBilinearPyramid::~oclBilinearPyramid()
+{
+    resize(0, 0);
 }
 
 //
@@ -59,76 +64,199 @@ int oclBilinearPyramid::compile()
 
 int oclBilinearPyramid::compute(oclDevice& iDevice, oclImage2D& bfSrce)
 {
-    cl_uint lIw = pow(2.0f, ceil(log(bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH)/2.0f)/log(2.0f)));
-    cl_uint lIh = pow(2.0f, ceil(log(bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT)/2.0f)/log(2.0f)));
-    unsigned int lLevels = log(1.0*min(lIw,lIh))/log(2.0f);
+    invalidate();
+    return update(iDevice, bfSrce);
+}
 
-    // resize pyramid if necessary
-    cl_uint lLw = mLevel[0]->getImageInfo<size_t>(CL_IMAGE_WIDTH)/2;
-    cl_uint lLh = mLevel[0]->getImageInfo<size_t>(CL_IMAGE_HEIGHT)/2;
-    if (lLevels != mLevel.size() || lLw != lIw || lLh != lIh )
+static void clampRegion(cl_int iRegion[4], cl_int iW, cl_int iH)
+{
+    iRegion[0] = max(iRegion[0], 0);
+    iRegion[1] = max(iRegion[1], 0);
+    iRegion[2] = min(iRegion[2], iW);
+    iRegion[3] = min(iRegion[3], iH);
+}
+
+int oclBilinearPyramid::update(oclDevice& iDevice, oclImage2D& bfSrce)
+{
+    cl_uint lWidth = bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH);
+    cl_uint lHeight = bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
+
+    // another source or size always needs a full build, the levels are only reallocated on resize;
+    // new content in the same image is the owner's to invalidate
+    if (lWidth != mSourceWidth || lHeight != mSourceHeight || bfSrce.getMem() != mSource)
     {
-        for (unsigned int i=0; i<mLevel.size(); i++)
+        if (!resize(lWidth, lHeight))
         {
-            delete mLevel[i];
+            return false;
         }
-        mLevel.resize(lLevels);
-        cl_image_format lFormat = { CL_RGBA,  CL_HALF_FLOAT };
-        lLw = lIw;
-        lLh = lIh;
-        for (unsigned int i=0; i<lLevels; i++)
+        mSource = bfSrce.getMem();
+        invalidate();
+    }
+
+    cl_int lRegion[4] = { mDirty[0], mDirty[1], mDirty[2], mDirty[3] };
+    clampRegion(lRegion, lWidth, lHeight);
+    if (mDown.empty() || lRegion[0] >= lRegion[2] || lRegion[1] >= lRegion[3])
+    {
+        return true;
+    }
+
+    // level 0 is scaled to a power of two, every texel reads a 2x2 footprint of the source
+    cl_int lLw = mDown[0]->dim(0);
+    cl_int lLh = mDown[0]->dim(1);
+    float lSx = (float)lLw/lWidth;
+    float lSy = (float)lLh/lHeight;
+    lRegion[0] = (cl_int)floor(lRegion[0]*lSx) - 1;
+    lRegion[1] = (cl_int)floor(lRegion[1]*lSy) - 1;
+    lRegion[2] = (cl_int)ceil(lRegion[2]*lSx) + 1;
+    lRegion[3] = (cl_int)ceil(lRegion[3]*lSy) + 1;
+    clampRegion(lRegion, lLw, lLh);
+    if (!sample(iDevice, clDownsample, bfSrce, *mDown[0], lRegion))
+    {
+        return false;
+    }
+
+    for (unsigned int i=1; i<mDown.size(); i++)
+    {
+        lLw /= 2;
+        lLh /= 2;
+        lRegion[0] = lRegion[0]/2 - 1;
+        lRegion[1] = lRegion[1]/2 - 1;
+        lRegion[2] = (lRegion[2]+1)/2 + 1;
+        lRegion[3] = (lRegion[3]+1)/2 + 1;
+        clampRegion(lRegion, lLw, lLh);
+        if (!sample(iDevice, clDownsample, *mDown[i-1], *mDown[i], lRegion))
         {
-            mLevel[i] = new oclImage2D(mContext, "Level");
-            mLevel[i]->create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lFormat, lLw, lLh);
-            lLw /=2;
-            lLh /=2;
+            return false;
+        }
+
+        // texels of the finer level whose bilinear footprint touches the changed ones
+        cl_int lUpsample[4] = { 2*lRegion[0] - 1, 2*lRegion[1] - 1, 2*lRegion[2] + 1, 2*lRegion[3] + 1 };
+        clampRegion(lUpsample, 2*lLw, 2*lLh);
+        if (!sample(iDevice, clUpsample, *mDown[i], *mLevel[i-1], lUpsample))
+        {
+            return false;
         }
     }
 
-    // fill in pyramid
-    size_t lGlobalSize[2];
-    size_t lLocalSize[2];
-    clDownsample.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
-    clSetKernelArg(clDownsample, 0, sizeof(cl_mem), bfSrce);
-    clSetKernelArg(clDownsample, 1, sizeof(cl_mem), *mLevel[0]);
-    clSetKernelArg(clDownsample, 2, sizeof(cl_uint), &lIw);
-    clSetKernelArg(clDownsample, 3, sizeof(cl_uint), &lIh);
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clDownsample, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, clDownsample.getEvent());
-    ENQUEUE_VALIDATE
+    mDirty[0] = mDirty[1] = mDirty[2] = mDirty[3] = 0;
+    return true;
+}
 
-    for (unsigned int i=1; i<mLevel.size(); i++)
+void oclBilinearPyramid::invalidate()
+{
+    mDirty[0] = 0;
+    mDirty[1] = 0;
+    mDirty[2] = mSourceWidth;
+    mDirty[3] = mSourceHeight;
+}
+
+void oclBilinearPyramid::invalidate(cl_int iX, cl_int iY, cl_int iW, cl_int iH)
+{
+    if (iW <= 0 || iH <= 0)
     {
+        return;
+    }
+    if (mDirty[0] >= mDirty[2] || mDirty[1] >= mDirty[3])
+    {
+        mDirty[0] = iX;
+        mDirty[1] = iY;
+        mDirty[2] = iX + iW;
+        mDirty[3] = iY + iH;
+    }
+    else
+    {
+        mDirty[0] = min(mDirty[0], iX);
+        mDirty[1] = min(mDirty[1], iY);
+        mDirty[2] = max(mDirty[2], iX + iW);
+        mDirty[3] = max(mDirty[3], iY + iH);
+    }
+}
+
+int oclBilinearPyramid::resize(cl_uint iWidth, cl_uint iHeight)
+{
+    if (iWidth == mSourceWidth && iHeight == mSourceHeight && !mDown.empty())
+    {
+        return true;
+    }
+
+    for (unsigned int i=0; i<mDown.size(); i++)
+    {
+        delete mDown[i];
+    }
+    for (unsigned int i=0; i<mLevel.size(); i++)
+    {
+        delete mLevel[i];
+    }
+    mDown.clear();
+    mLevel.clear();
+    mSource = 0;
+    mSourceWidth = iWidth;
+    mSourceHeight = iHeight;
+    if (iWidth < 2 || iHeight < 2)
+    {
+        return true;
+    }
+
+    cl_uint lIw = pow(2.0f, ceil(log(iWidth/2.0f)/log(2.0f)));
+    cl_uint lIh = pow(2.0f, ceil(log(iHeight/2.0f)/log(2.0f)));
+    unsigned int lLevels = log(1.0*min(lIw,lIh))/log(2.0f);
+
+    cl_image_format lFormat = { CL_RGBA,  CL_HALF_FLOAT };
+    for (unsigned int i=0; i<lLevels; i++)
+    {
+        mDown.push_back(new oclImage2D(mContext, "Level"));
+        if (!mDown.back()->create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lFormat, lIw, lIh))
+        {
+            resize(0, 0);
+            return false;
+        }
+        if (i+1 < lLevels)
+        {
+            mLevel.push_back(new oclImage2D(mContext, "Level"));
+            if (!mLevel.back()->create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lFormat, lIw, lIh))
+            {
+                resize(0, 0);
+                return false;
+            }
+        }
         lIw /= 2;
         lIh /= 2;
-        clDownsample.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
-        clSetKernelArg(clDownsample, 0, sizeof(cl_mem), *mLevel[i-1]);
-        clSetKernelArg(clDownsample, 1, sizeof(cl_mem), *mLevel[i]);
-        clSetKernelArg(clDownsample, 2, sizeof(cl_uint), &lIw);
-        clSetKernelArg(clDownsample, 3, sizeof(cl_uint), &lIh);
-        sStatusCL = clEnqueueNDRangeKernel(iDevice, clDownsample, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, clDownsample.getEvent());
-        ENQUEUE_VALIDATE
-
-        lIw *= 2;
-        lIh *= 2;
-        clUpsample.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
-        clSetKernelArg(clUpsample, 0, sizeof(cl_mem), *mLevel[i]);
-        clSetKernelArg(clUpsample, 1, sizeof(cl_mem), *mLevel[i-1]);
-        clSetKernelArg(clUpsample, 2, sizeof(cl_uint), &lIw);
-        clSetKernelArg(clUpsample, 3, sizeof(cl_uint), &lIh);
-        sStatusCL = clEnqueueNDRangeKernel(iDevice, clUpsample, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, clUpsample.getEvent());
-        ENQUEUE_VALIDATE
-        lIw /= 2;
-        lIh /= 2;
+    }
+    return true;
+}
+
+int oclBilinearPyramid::sample(oclDevice& iDevice, oclKernel& iKernel, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRegion[4])
+{
+    cl_int lW = bfDest.dim(0);
+    cl_int lH = bfDest.dim(1);
+    cl_int lRw = iRegion[2] - iRegion[0];
+    cl_int lRh = iRegion[3] - iRegion[1];
+    if (lRw <= 0 || lRh <= 0)
+    {
+        return true;
     }
 
+    size_t lGlobalSize[2];
+    size_t lLocalSize[2];
+    iKernel.localSize2D(iDevice, lGlobalSize, lLocalSize, lRw, lRh);
+    clSetKernelArg(iKernel, 0, sizeof(cl_mem), bfSrce);
+    clSetKernelArg(iKernel, 1, sizeof(cl_mem), bfDest);
+    clSetKernelArg(iKernel, 2, sizeof(cl_int), &lW);
+    clSetKernelArg(iKernel, 3, sizeof(cl_int), &lH);
+    clSetKernelArg(iKernel, 4, sizeof(cl_int), &iRegion[0]);
+    clSetKernelArg(iKernel, 5, sizeof(cl_int), &iRegion[1]);
+    clSetKernelArg(iKernel, 6, sizeof(cl_int), &lRw);
+    clSetKernelArg(iKernel, 7, sizeof(cl_int), &lRh);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, iKernel, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, iKernel.getEvent());
+    ENQUEUE_VALIDATE
     return true;
 }
 
 
 oclImage2D* oclBilinearPyramid::getLevel(unsigned int iLevel)
 {
-    // do not return last level. It is useless
-    if (iLevel < mLevel.size()-1)
+    // the last level is never upsampled, it is useless
+    if (iLevel < mLevel.size())
     {
         return mLevel[iLevel];
     }
@@ -137,3 +265,8 @@ oclImage2D* oclBilinearPyramid::getLevel(unsigned int iLevel)
         return 0;
     }
 };
+
+unsigned int oclBilinearPyramid::getLevelCount()
+{
+    return mLevel.size();
+}
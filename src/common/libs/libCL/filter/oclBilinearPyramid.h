@@ -20,24 +20,51 @@
 //
 // computes Bilateral Pyramind of 2D Image. see "Pyramid Methods in GPU-Based Image Processing"
 //
+// The levels are allocated once per source size. update() rebuilds what was invalidated
+// since the last build, and everything for another source image or size. Rewriting the
+// same image is not detected: the owner of a pyramid shared by several effects has to call
+// invalidate() once per frame after the source changed, then only the first update() of the
+// frame builds it. invalidate() with a region regenerates only the affected texels.
+//
 
 class oclBilinearPyramid : public oclProgram
 {
     public: 
 
         oclBilinearPyramid(oclContext& iContext);
+        ~oclBilinearPyramid();
 
         int compile();
+
+        // always rebuilds the whole pyramid
         int compute(oclDevice& iDevice, oclImage2D& bfSource);
 
+        // rebuilds the invalidated part, everything if bfSource is another image or size than last time
+        int update(oclDevice& iDevice, oclImage2D& bfSource);
+
+        // marks the whole source or a region of it in pixels as changed
+        void invalidate();
+        void invalidate(cl_int iX, cl_int iY, cl_int iW, cl_int iH);
+
         oclImage2D* getLevel(unsigned int iLevel);
+        unsigned int getLevelCount();
 
     protected:
 
+        int resize(cl_uint iWidth, cl_uint iHeight);
+        int sample(oclDevice& iDevice, oclKernel& iKernel, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int iRegion[4]);
+
         oclKernel clUpsample;
         oclKernel clDownsample;
 
+        // mDown holds the plain downsampled chain, mLevel[i] the upsampled mDown[i+1]
+        vector<oclImage2D*> mDown;
         vector<oclImage2D*> mLevel;
+
+        cl_mem mSource;
+        cl_uint mSourceWidth;
+        cl_uint mSourceHeight;
+        cl_int mDirty[4];     // x0, y0, x1, y1 of the changed source pixels
 };      
 
 #endif
\ No newline at end of file
@@ -58,6 +58,97 @@ __kernel void clIso2Dsep(__read_only image2d_t imageIn, __write_only image2d_t i
     }
 }
 
+//
+// Tiled 2D Convolution, compiled per filter radius (RADIUS_X, RADIUS_Y), each
+// work group loads its tile and apron into local memory once
+//
+
+#ifdef RADIUS_X
+
+#ifndef TILE_SIZE
+#define TILE_SIZE 16
+#endif
+
+#define APRON_W (TILE_SIZE+2*RADIUS_X)
+#define APRON_H (TILE_SIZE+2*RADIUS_Y)
+
+__kernel __attribute__((reqd_work_group_size(TILE_SIZE, TILE_SIZE, 1)))
+void clIso2Dtiled(__read_only image2d_t imageIn, __write_only image2d_t imageOut, __constant float* filter, int imgw, int imgh)
+{
+    const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP_TO_EDGE;
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int ox = mul24(get_group_id(0), TILE_SIZE) - RADIUS_X;
+    int oy = mul24(get_group_id(1), TILE_SIZE) - RADIUS_Y;
+
+    __local float4 tile[APRON_H][APRON_W];
+    for (int j=ly; j<APRON_H; j+=TILE_SIZE)
+    {
+        for (int i=lx; i<APRON_W; i+=TILE_SIZE)
+        {
+            tile[j][i] = read_imagef(imageIn, sampler, (int2)(ox+i, oy+j));
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int x = ox + RADIUS_X + lx;
+    int y = oy + RADIUS_Y + ly;
+    if (x < imgw && y < imgh) 
+    {
+        float4 ds = (float4)0;
+        #pragma unroll
+        for (int j=0; j<=2*RADIUS_Y; j++)
+        {
+            #pragma unroll
+            for (int i=0; i<=2*RADIUS_X; i++)
+            {
+                ds += tile[ly+j][lx+i]*filter[j*(2*RADIUS_X+1)+i];
+            }
+        }
+        write_imagef(imageOut, (int2)(x,y), ds);
+    }
+}
+
+// the tile is laid out so that consecutive work items along x touch consecutive texels: rows along
+// the filter axis for the horizontal pass, columns for the vertical one, which avoids bank conflicts
+
+__kernel __attribute__((reqd_work_group_size(TILE_SIZE, TILE_SIZE, 1)))
+void clIso2Dseptiled(__read_only image2d_t imageIn, __write_only image2d_t imageOut, int2 axis, __constant float* filter, int imgw, int imgh)
+{
+    const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP_TO_EDGE;
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int along = axis.x ? lx : ly;
+    int across = axis.x ? ly : lx;
+    int2 perp = (int2)(axis.y, axis.x);
+    int2 origin = (int2)(mul24(get_group_id(0), TILE_SIZE), mul24(get_group_id(1), TILE_SIZE));
+    int row = axis.x ? APRON_W : 1;
+    int step = axis.x ? 1 : TILE_SIZE;
+
+    __local float4 tile[TILE_SIZE*APRON_W];
+    for (int i=along; i<APRON_W; i+=TILE_SIZE)
+    {
+        int2 p = origin + (i-RADIUS_X)*axis + across*perp;
+        tile[across*row+i*step] = read_imagef(imageIn, sampler, p);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int x = origin.x + lx;
+    int y = origin.y + ly;
+    if (x < imgw && y < imgh) 
+    {
+        float4 ds = (float4)0;
+        #pragma unroll
+        for (int i=0; i<=2*RADIUS_X; i++)
+        {
+            ds += tile[across*row+(along+i)*step]*filter[i];
+        }
+        write_imagef(imageOut, (int2)(x,y), ds);
+    }
+}
+
+#endif
+
 __kernel void clAniso2Dtang(__read_only image2d_t imageIn, __write_only image2d_t imageOut, __read_only image2d_t vector, __constant float* filter, int size, int imgw, int imgh)
 {
     const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP_TO_EDGE;
@@ -13,6 +13,7 @@
 // limitations under the License.
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <stdio.h>
 
 #include "oclConvolute.h"
 
@@ -66,22 +67,44 @@ void calcGauss2D(float iSigma, float* iBuffer, int iWidth, int iHeigth)
     }
 }
 
-oclConvolute::oclConvolute(oclContext& iContext)
+const int oclConvolute::cTileSize = 16;
+
+oclConvolute::oclConvolute(oclContext& iContext, int iRadiusX, int iRadiusY)
 : oclProgram(iContext, "oclConvolute")
 // kernels
 , clIso2D(*this)
 , clIso2Dsep(*this)
 , clAniso2Dtang(*this)
 , clAniso2Dorth(*this)
+, clIso2Dtiled(*this)
+, clIso2Dseptiled(*this)
+// members
+, mRadiusX(iRadiusX)
+, mRadiusY(iRadiusY)
 {
     exportKernel(clIso2D);
     exportKernel(clIso2Dsep);
     exportKernel(clAniso2Dtang);
     exportKernel(clAniso2Dorth);
 
+    if (mRadiusX > 0 || mRadiusY > 0)
+    {
+        snprintf(mDefines, sizeof(mDefines), "#define RADIUS_X %d\n#define RADIUS_Y %d\n#define TILE_SIZE %d\n", mRadiusX, mRadiusY, cTileSize);
+        addSourceCode(mDefines);
+        exportKernel(clIso2Dtiled);
+        exportKernel(clIso2Dseptiled);
+    }
     addSourceFile("filter/oclConvolute.cl");
 }
 
+oclConvolute::~oclConvolute()
+{
+    for (unsigned int i=0; i<mTiled.size(); i++)
+    {
+        delete mTiled[i];
+    }
+}
+
 //
 //
 //
@@ -92,6 +115,8 @@ int oclConvolute::compile()
     clIso2Dsep = 0;
     clAniso2Dtang = 0;
     clAniso2Dorth = 0;
+    clIso2Dtiled = 0;
+    clIso2Dseptiled = 0;
 
     if (!oclProgram::compile())
     {
@@ -107,9 +132,51 @@ int oclConvolute::compile()
     KERNEL_VALIDATE(clAniso2Dtang)
     clAniso2Dorth = createKernel("clAniso2Dorth");
     KERNEL_VALIDATE(clAniso2Dorth)
+
+    if (mRadiusX > 0 || mRadiusY > 0)
+    {
+        clIso2Dtiled = createKernel("clIso2Dtiled");
+        KERNEL_VALIDATE(clIso2Dtiled)
+        clIso2Dseptiled = createKernel("clIso2Dseptiled");
+        KERNEL_VALIDATE(clIso2Dseptiled)
+    }
     return 1;
 }
 
+oclConvolute* oclConvolute::getTiled(oclDevice& iDevice, int iRadiusX, int iRadiusY)
+{
+    if (iRadiusX <= 0 && iRadiusY <= 0)
+    {
+        return 0;
+    }
+    for (unsigned int i=0; i<mTiled.size(); i++)
+    {
+        if (mTiled[i]->mRadiusX == iRadiusX && mTiled[i]->mRadiusY == iRadiusY)
+        {
+            return mTiled[i];
+        }
+    }
+
+    cl_ulong lLocalMem = 0;
+    clGetDeviceInfo(iDevice, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(cl_ulong), &lLocalMem, NULL);
+    if ((cTileSize+2*iRadiusX)*(cTileSize+2*iRadiusY)*sizeof(cl_float4) > lLocalMem)
+    {
+        Log(WARN, this) << "tile of radius " << iRadiusX << "x" << iRadiusY << " exceeds local memory, using untiled kernel";
+        return 0;
+    }
+
+    oclConvolute* lTiled = new oclConvolute(mContext, iRadiusX, iRadiusY);
+    if (!lTiled->compile() || 
+        lTiled->clIso2Dtiled.getKernelWorkGroupInfo<size_t>(CL_KERNEL_WORK_GROUP_SIZE, iDevice) < (size_t)cTileSize*cTileSize)
+    {
+        Log(WARN, this) << "tiled kernel of radius " << iRadiusX << "x" << iRadiusY << " not available, using untiled kernel";
+        delete lTiled;
+        return 0;
+    }
+    mTiled.push_back(lTiled);
+    return lTiled;
+}
+
 //
 //
 //
@@ -241,10 +308,30 @@ bool oclConvolute::DoG2D(float iSigmaA, float iSigmaB, float iSensitivity, oclBu
 //
 //
 
-int oclConvolute::iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, oclBuffer& bfFilter, int iFilterW, int iFilterH)
+int oclConvolute::iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, oclBuffer& bfFilter, int iFilterW, int iFilterH, bool iTiled)
 {
     cl_uint lIw = bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH);
     cl_uint lIh = bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
+
+    oclConvolute* lTiled = iTiled ? getTiled(iDevice, iFilterW/2, iFilterH/2) : 0;
+    if (lTiled)
+    {
+        size_t lLocalSize[2] = { cTileSize, cTileSize };
+        size_t lGlobalSize[2];
+        lGlobalSize[0] = ((lIw+cTileSize-1)/cTileSize)*cTileSize;
+        lGlobalSize[1] = ((lIh+cTileSize-1)/cTileSize)*cTileSize;
+
+        oclKernel& lKernel = lTiled->clIso2Dtiled;
+        clSetKernelArg(lKernel, 0, sizeof(cl_mem), bfSrce);
+        clSetKernelArg(lKernel, 1, sizeof(cl_mem), bfDest);
+        clSetKernelArg(lKernel, 2, sizeof(cl_mem), bfFilter);
+        clSetKernelArg(lKernel, 3, sizeof(cl_uint), &lIw);
+        clSetKernelArg(lKernel, 4, sizeof(cl_uint), &lIh);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, lKernel, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, lKernel.getEvent());
+        ENQUEUE_VALIDATE
+        return true;
+    }
+
     size_t lGlobalSize[2];
     size_t lLocalSize[2];
     clIso2D.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
@@ -261,19 +348,41 @@ int oclConvolute::iso2D(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDe
     return true;
 }   
 
-int oclConvolute::iso2Dsep(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int2 iAxis, oclBuffer& bfFilter)
+int oclConvolute::iso2Dsep(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest, cl_int2 iAxis, oclBuffer& bfFilter, bool iTiled)
 {
     cl_uint lIw = bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH);
     cl_uint lIh = bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
     size_t lGlobalSize[2];
     size_t lLocalSize[2];
-    clIso2Dsep.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
 
     cl_int lFilterSize = bfFilter.dim(0)/sizeof(cl_float);
     if (lFilterSize %2 == 0)
     {
         Log(ERR, this) << "Failure in call to oclConvolute::iso2D : kernel size must be odd ";
     }
+
+    // the 2D tile of a (radius, 0) program is the size of the separable tile
+    oclConvolute* lTiled = iTiled ? getTiled(iDevice, lFilterSize/2, 0) : 0;
+    if (lTiled)
+    {
+        lLocalSize[0] = cTileSize;
+        lLocalSize[1] = cTileSize;
+        lGlobalSize[0] = ((lIw+cTileSize-1)/cTileSize)*cTileSize;
+        lGlobalSize[1] = ((lIh+cTileSize-1)/cTileSize)*cTileSize;
+
+        oclKernel& lKernel = lTiled->clIso2Dseptiled;
+        clSetKernelArg(lKernel, 0, sizeof(cl_mem), bfSrce);
+        clSetKernelArg(lKernel, 1, sizeof(cl_mem), bfDest);
+        clSetKernelArg(lKernel, 2, sizeof(cl_int2),  &iAxis);
+        clSetKernelArg(lKernel, 3, sizeof(cl_mem), bfFilter);
+        clSetKernelArg(lKernel, 4, sizeof(cl_uint), &lIw);
+        clSetKernelArg(lKernel, 5, sizeof(cl_uint), &lIh);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, lKernel, 2, NULL, lGlobalSize, lLocalSize, 0, NULL, lKernel.getEvent());
+        ENQUEUE_VALIDATE
+        return true;
+    }
+
+    clIso2Dsep.localSize2D(iDevice, lGlobalSize, lLocalSize, lIw, lIh);
     clSetKernelArg(clIso2Dsep, 0, sizeof(cl_mem), bfSrce);
     clSetKernelArg(clIso2Dsep, 1, sizeof(cl_mem), bfDest);
     clSetKernelArg(clIso2Dsep, 2, sizeof(cl_int2),  &iAxis);
@@ -22,13 +22,16 @@ class oclConvolute : public oclProgram
 {
     public: 
 
-        oclConvolute(oclContext& iContext);
+        // a radius compiles the tiled kernels for this filter size only
+        oclConvolute(oclContext& iContext, int iRadiusX = 0, int iRadiusY = 0);
+       ~oclConvolute();
 
         int compile();
 
-        // 2D convolutions on images and buffers
-        int iso2D(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, oclBuffer& bfFilter, int iFilterW, int iFilterH);
-        int iso2Dsep(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, cl_int2 iAxis, oclBuffer& bfFilter);
+        // 2D convolutions on images and buffers, tiled calls stage the image 
+        // in local memory through a program compiled for the filter radius
+        int iso2D(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, oclBuffer& bfFilter, int iFilterW, int iFilterH, bool iTiled = false);
+        int iso2Dsep(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, cl_int2 iAxis, oclBuffer& bfFilter, bool iTiled = false);
         int aniso2Dtang(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, oclImage2D& iLine, oclBuffer& bfFilter);
         int aniso2Dorth(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, oclImage2D& iLine, oclBuffer& bfFilter);
 
@@ -41,10 +44,21 @@ class oclConvolute : public oclProgram
 
     protected:
 
+        static const int cTileSize;
+
+        oclConvolute* getTiled(oclDevice& iDevice, int iRadiusX, int iRadiusY);
+
         oclKernel clIso2D;
         oclKernel clIso2Dsep;
         oclKernel clAniso2Dtang;
         oclKernel clAniso2Dorth;
+        oclKernel clIso2Dtiled;
+        oclKernel clIso2Dseptiled;
+
+        int mRadiusX;
+        int mRadiusY;
+        char mDefines[128];
+        vector<oclConvolute*> mTiled;
 };      
 
 #endif
\ No newline at end of file
@@ -12,45 +12,53 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+//
+// Young / van Vliet recursive filter, one work item per image line. A launch
+// filters count lines from first on, the causal pass is kept in line, a buffer
+// of count*length float4 laid out so that neighboring lines access consecutive
+// elements
+//
+
 __kernel void clRecursiveGaussian(__read_only image2d_t valIn, 
                                   __write_only image2d_t valOut, 
                                   uint iWidth, uint iHeight, uint2 dxy,
                                   float a0, float a1, 
                                   float a2, float a3, 
                                   float b1, float b2, 
-                                  float coefp, float coefn)
+                                  float coefp, float coefn,
+                                  __global float4* line,
+                                  uint first, uint count)
 {
     const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP;
 
-    unsigned int c = mul24(get_group_id(0), get_local_size(0)) + get_local_id(0);
-    if (c >= iWidth*dxy.y + iHeight*dxy.x)
+    unsigned int l = mul24(get_group_id(0), get_local_size(0)) + get_local_id(0);
+    if (l >= count)
     {
         return;
     }
-
-    float4 lumOut[1024];
+    uint c = first + l;
 
     uint limit = iWidth*dxy.x + iHeight*dxy.y;
     uint sx = c*dxy.y;
     uint sy = c*dxy.x;
 
     // forward filter pass
-    float4 xp = read_imagef(valIn, sampler, (float2)(sx,sy));
+    float4 xp = read_imagef(valIn, sampler, (int2)(sx,sy));
     float4 yp = xp * coefp; 
     float4 yb = yp; 
     for (int i=0; i<limit; i++) 
     {
         float4 xc = read_imagef(valIn, sampler, (int2)(sx,sy));
         float4 yc = (xc * a0) + (xp * a1) - (yp * b1) - (yb * b2);
-        lumOut[i] = yc;
+        line[i*count+l] = yc;
         xp = xc; 
         yb = yp; 
         yp = yc; 
         sx += dxy.x;
         sy += dxy.y;
-   }
+    }
 
-    // reverse filter pass
+    // reverse filter pass, adds the causal part and writes the result
     sx -= dxy.x;
     sy -= dxy.y;
     float4 xn = read_imagef(valIn, sampler, (int2)(sx,sy));
@@ -65,18 +73,8 @@ __kernel void clRecursiveGaussian(__read_only image2d_t valIn,
         xn = xc; 
         ya = yn; 
         yn = yc;
-        lumOut[i] = lumOut[i] + yc;
+        write_imagef(valOut, (int2)(sx,sy), line[i*count+l] + yc);
         sx -= dxy.x;
         sy -= dxy.y;
     }
-
-
-    sx = c*dxy.y;
-    sy = c*dxy.x;
-    for (int i=0; i<limit; i++) 
-    {
-        write_imagef(valOut, (int2)(sx+i*dxy.x,sy+i*dxy.y), lumOut[i]);
-    }
-
-    write_imagef(valOut, (int2)(sx,sy), (float4)0);
 }
@@ -17,9 +17,13 @@
 
 oclRecursiveGaussian::oclRecursiveGaussian(oclContext& iContext)
 : oclProgram(iContext, "oclRecursiveGaussian")
+// buffers
+, bfLine(iContext, "bfLine")
 // kernels
 , clRecursiveGaussian(*this)
 {
+    bfLine.create<cl_float4>(CL_MEM_READ_WRITE, 256*256);
+
     addSourceFile("filter/oclRecursiveGaussian.cl");
 
     exportKernel(clRecursiveGaussian);
@@ -78,31 +82,55 @@ void oclRecursiveGaussian::setSigma(cl_float nsigma)
 
 int oclRecursiveGaussian::compute(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfTemp, oclImage2D& bfDest)
 {
-    size_t lGlobalSize;
     cl_uint2 dxy;
     cl_uint lImageWidth = bfSource.getImageInfo<size_t>(CL_IMAGE_WIDTH);
     cl_uint lImageHeight = bfSource.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
 
+    // the lines are filtered in launches of the lines the device runs at once, so the
+    // causal pass only has to be kept for those instead of the whole image
+    cl_uint lUnits = 1;
+    clGetDeviceInfo(iDevice, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &lUnits, NULL);
+    size_t lBatch = lUnits*mLocalSize;
+    size_t lSize = max(min(lBatch, (size_t)lImageWidth)*lImageHeight, min(lBatch, (size_t)lImageHeight)*lImageWidth);
+    if (bfLine.count<cl_float4>() < lSize)
+    {
+        if (!bfLine.resize<cl_float4>(lSize))
+        {
+            return false;
+        }
+    }
+
     clSetKernelArg(clRecursiveGaussian, 2, sizeof(cl_uint), &lImageWidth);
     clSetKernelArg(clRecursiveGaussian, 3, sizeof(cl_uint), &lImageHeight);
+    clSetKernelArg(clRecursiveGaussian, 13, sizeof(cl_mem), bfLine);
 
     dxy.s[0] = 0;
     dxy.s[1] = 1;
-    lGlobalSize = ceil((float)lImageWidth/mLocalSize)*mLocalSize;
-    clSetKernelArg(clRecursiveGaussian, 0, sizeof(cl_mem), bfSource);
-    clSetKernelArg(clRecursiveGaussian, 1, sizeof(cl_mem), bfTemp);
-    clSetKernelArg(clRecursiveGaussian, 4, sizeof(cl_uint2), &dxy);
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clRecursiveGaussian, 1, NULL, &lGlobalSize, &mLocalSize, 0, NULL, clRecursiveGaussian.getEvent());
-    ENQUEUE_VALIDATE
+    if (!filter(iDevice, bfSource, bfTemp, dxy, lImageWidth, lBatch))
+    {
+        return false;
+    }
 
     dxy.s[0] = 1;
     dxy.s[1] = 0;
-    lGlobalSize = ceil((float)lImageHeight/mLocalSize)*mLocalSize;
-    clSetKernelArg(clRecursiveGaussian, 0, sizeof(cl_mem), bfTemp);
+    return filter(iDevice, bfTemp, bfDest, dxy, lImageHeight, lBatch);
+}
+
+int oclRecursiveGaussian::filter(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, cl_uint2 iAxis, cl_uint iLines, size_t iBatch)
+{
+    clSetKernelArg(clRecursiveGaussian, 0, sizeof(cl_mem), bfSource);
     clSetKernelArg(clRecursiveGaussian, 1, sizeof(cl_mem), bfDest);
-    clSetKernelArg(clRecursiveGaussian, 4, sizeof(cl_uint2), &dxy);
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clRecursiveGaussian, 1, NULL, &lGlobalSize, &mLocalSize, 0, NULL, clRecursiveGaussian.getEvent());
-    ENQUEUE_VALIDATE
+    clSetKernelArg(clRecursiveGaussian, 4, sizeof(cl_uint2), &iAxis);
+
+    for (cl_uint lFirst=0; lFirst<iLines; lFirst+=iBatch)
+    {
+        cl_uint lCount = min((size_t)(iLines - lFirst), iBatch);
+        size_t lGlobalSize = ceil((float)lCount/mLocalSize)*mLocalSize;
+        clSetKernelArg(clRecursiveGaussian, 14, sizeof(cl_uint), &lFirst);
+        clSetKernelArg(clRecursiveGaussian, 15, sizeof(cl_uint), &lCount);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clRecursiveGaussian, 1, NULL, &lGlobalSize, &mLocalSize, 0, NULL, clRecursiveGaussian.getEvent());
+        ENQUEUE_VALIDATE
+    }
 
     return true;
 }
\ No newline at end of file
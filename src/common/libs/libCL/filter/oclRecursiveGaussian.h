@@ -15,6 +15,7 @@
 #define _oclRecursiveGaussian
 
 #include "oclProgram.h"
+#include "oclBuffer.h"
 #include "oclImage2D.h"
 
 class oclRecursiveGaussian : public oclProgram
@@ -30,6 +31,12 @@ class oclRecursiveGaussian : public oclProgram
 
     protected:
 
+        int filter(oclDevice& iDevice, oclImage2D& bfSource, oclImage2D& bfDest, cl_uint2 iAxis, cl_uint iLines, size_t iBatch);
+
+        // causal pass of the lines in flight, a work group of lines per compute unit:
+        // compute units * work group size * longest line * 16 bytes at most
+        oclBuffer bfLine;
+
         oclKernel clRecursiveGaussian;
         size_t mLocalSize;
 
@@ -102,6 +102,39 @@ __kernel void clMorton(__global uint* index, __global float4* vertex, __global u
     val[g] = g;
 }
 
+// 63 bit codes, 21 bits per axis, split into two 32 bit words for the radix sort
+
+ulong code64(ulong x)
+{
+    x = (x | (x << 32)) & 0x001F00000000FFFF;
+    x = (x | (x << 16)) & 0x001F0000FF0000FF;
+    x = (x | (x <<  8)) & 0x100F00F00F00F00F;
+    x = (x | (x <<  4)) & 0x10C30C30C30C30C3;
+    x = (x | (x <<  2)) & 0x1249249249249249;
+    return x;
+}
+
+__kernel void clMorton64(__global uint* index, __global float4* vertex, __global ulong* key, __global uint* val, __global AABB* aabb)
+{
+    int g = get_global_id(0);
+
+    float4 v0 = vertex[index[g*3+0]];
+    float4 v1 = vertex[index[g*3+1]];
+    float4 v2 = vertex[index[g*3+2]];
+
+    float4 normal = ((v0+v1+v2)/3 - aabb[0].bbMin)/(aabb[0].bbMax - aabb[0].bbMin);
+
+    key[g] = code64(normal.x*0x1FFFFF) | (code64(normal.y*0x1FFFFF)<<1) | (code64(normal.z*0x1FFFFF)<<2);
+    val[g] = g;
+}
+
+__kernel void clSplitKey(__global ulong* key, __global uint* val, __global uint* word, uint shift)
+{
+    int g = get_global_id(0);
+
+    word[g] = key[val[g]] >> shift;
+}
+
 //
 // Create BVH
 //
@@ -142,6 +175,32 @@ __kernel void clCreateNodes(__global uint* mortonKey, __global uint* mortonVal,
     }
 }
 
+__kernel void clCreateNodes64(__global ulong* mortonKey, __global uint* mortonVal, __global BVHNode* bvh)
+{
+    int globalid = get_global_id(0);
+
+    bvh[globalid].left = -1;
+    bvh[globalid].right = -1;
+    bvh[globalid].bit = 0;
+    bvh[globalid].trav = 0;
+    bvh[globalid].bbMin = (float4)( MAXFLOAT, MAXFLOAT,MAXFLOAT,0);
+    bvh[globalid].bbMax = (float4)(-MAXFLOAT,-MAXFLOAT,-MAXFLOAT,0);
+
+    ulong key0 = mortonKey[mortonVal[globalid]];
+    ulong key1 = mortonKey[mortonVal[globalid+1]];
+
+    for (int i=62; i>=0; i--)
+    {
+        ulong bit0 = (key0 >> i) & 0x1;
+        ulong bit1 = (key1 >> i) & 0x1;
+        if (bit0 != bit1)
+        {
+            bvh[globalid].bit = i;
+            break;
+        }
+    }
+}
+
 __kernel void clLinkNodes(__global uint* mortonKey, __global BVHNode* bvh, __global uint* bvhRoot)
 {
     int globalid = get_global_id(0);
@@ -231,66 +290,296 @@ __kernel void clCreateLeaves(__global uint* mortonVal, __global BVHNode* bvh)
     }
 }
 
-__kernel void clComputeAABBs(__global uint* index, __global float4* vertex, __global BVHNode* bvh, __global int* bvhRoot)
+__kernel void clComputeParents(__global BVHNode* bvh, __global int* parent, __global uint* bvhRoot)
 {
     int globalid = get_global_id(0);
 
-    uint stack[128];
-    uint top = 0;
-    
-    stack[top] = *bvhRoot;
-    while (1)
+    parent[bvh[globalid].left] = globalid;
+    parent[bvh[globalid].right] = globalid;
+    if (globalid == *bvhRoot)
     {
-        if (stack[top] >= globalid)
+        parent[globalid] = -1;
+    }
+}
+
+// walks up from each leaf, the second thread to reach a node merges the boxes
+// of its children, works for any topology so it is also used after treelet
+// restructuring and for refits
+
+__kernel void clComputeAABBs(__global uint* index, __global float4* vertex, __global BVHNode* bvh, __global int* parent)
+{
+    int globalid = get_global_id(0);
+    int leafstart = get_global_size(0)-1;
+
+    int node = leafstart+globalid;
+    int triangle = bvh[node].bit;
+    float4 v0 = vertex[index[triangle*3+0]];
+    float4 v1 = vertex[index[triangle*3+1]];
+    float4 v2 = vertex[index[triangle*3+2]];
+    bvh[node].bbMin = min(min(v0, v1), v2);
+    bvh[node].bbMax = max(max(v0, v1), v2);
+
+    node = parent[node];
+    while (node != -1)
+    {
+        mem_fence(CLK_GLOBAL_MEM_FENCE);
+        if (atom_inc(&bvh[node].trav) == 0)
         {
-            // turn left
-            stack[top+1] = bvh[stack[top]].left;
+            return;
         }
-        else
+
+        uint left = bvh[node].left;
+        uint right = bvh[node].right;
+        bvh[node].bbMin = min(bvh[left].bbMin, bvh[right].bbMin);
+        bvh[node].bbMax = max(bvh[left].bbMax, bvh[right].bbMax);
+        node = parent[node];
+    }
+}
+
+//
+// Refit, keeps the hierarchy and recomputes the AABBs with clComputeAABBs
+//
+
+__kernel void clResetTraversal(__global BVHNode* bvh)
+{
+    int globalid = get_global_id(0);
+    bvh[globalid].trav = 0;
+}
+
+//
+// Surface area heuristic, cost of the tree relative to its root box
+//
+
+#define SAH_BLOCKSIZE 256
+#define SAH_INTERNAL_COST 1.2f
+#define SAH_LEAF_COST 1.0f
+
+float surfaceArea(float4 bbMin, float4 bbMax)
+{
+    float4 d = bbMax - bbMin;
+    return 2.0f*(d.x*d.y + d.y*d.z + d.z*d.x);
+}
+
+__kernel void clSurfaceArea(__global BVHNode* bvh, uint internalCount, uint nodeCount, __global float* partial)
+{
+    int globalid = get_global_id(0);
+    int threadid = get_local_id(0);
+
+    __local float sum[SAH_BLOCKSIZE];
+
+    float area = 0;
+    if (globalid < nodeCount)
+    {
+        area = surfaceArea(bvh[globalid].bbMin, bvh[globalid].bbMax);
+        area *= globalid < internalCount ? SAH_INTERNAL_COST : SAH_LEAF_COST;
+    }
+    sum[threadid] = area;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int i=SAH_BLOCKSIZE/2; i>0; i>>=1)
+    {
+        if (threadid < i)
         {
-            // turn right
-            stack[top+1] = bvh[stack[top]].right;
+            sum[threadid] += sum[threadid + i];
         }
-        
-        top++;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (threadid == 0)
+    {
+        partial[get_group_id(0)] = sum[0];
+    }
+}
+
+//
+// Treelet restructuring, finds the optimal topology of small treelets
+// bottom-up by dynamic programming over all subsets of the treelet leaves
+//
+
+#define TREELET_SIZE 5
+#define TREELET_SUBSETS (1 << TREELET_SIZE)
+
+int lowestBit(uint set)
+{
+    int i = 0;
+    while (!(set & 1))
+    {
+        set >>= 1;
+        i++;
+    }
+    return i;
+}
 
-        if (bvh[stack[top]].left == bvh[stack[top]].right)
+void optimizeTreelet(__global BVHNode* bvh, __global int* parent, __global float* cost, int root)
+{
+    // grow the treelet by expanding the leaf with the largest surface area
+    int leaves[TREELET_SIZE];
+    int internal[TREELET_SIZE-1];
+    int leafCount = 2;
+    int internalCount = 1;
+    internal[0] = root;
+    leaves[0] = bvh[root].left;
+    leaves[1] = bvh[root].right;
+    while (leafCount < TREELET_SIZE)
+    {
+        int best = -1;
+        float bestArea = -1;
+        for (int i=0; i<leafCount; i++)
+        {
+            int n = leaves[i];
+            if (bvh[n].left != bvh[n].right)
+            {
+                float area = surfaceArea(bvh[n].bbMin, bvh[n].bbMax);
+                if (area > bestArea)
+                {
+                    best = i;
+                    bestArea = area;
+                }
+            }
+        }
+        if (best == -1)
         {
-            // is leaf
-            int triangle = bvh[stack[top]].bit;
-            float4 v0 = vertex[index[triangle*3+0]];
-            float4 v1 = vertex[index[triangle*3+1]];
-            float4 v2 = vertex[index[triangle*3+2]];
-            float4 bbMin = (float4)( MAXFLOAT, MAXFLOAT,MAXFLOAT,0);
-            float4 bbMax = (float4)(-MAXFLOAT,-MAXFLOAT,-MAXFLOAT,0);
-            bbMin = min(bbMin, v0);
-            bbMin = min(bbMin, v1);
-            bbMin = min(bbMin, v2);
-            bbMax = max(bbMax, v0);
-            bbMax = max(bbMax, v1);
-            bbMax = max(bbMax, v2);
-            bvh[stack[top]].bbMin = bbMin;
-            bvh[stack[top]].bbMax = bbMax;
             break;
         }
+
+        int n = leaves[best];
+        internal[internalCount++] = n;
+        leaves[best] = bvh[n].left;
+        leaves[leafCount++] = bvh[n].right;
     }
 
-    while (top--)
+    float area = surfaceArea(bvh[root].bbMin, bvh[root].bbMax);
+    cost[root] = SAH_INTERNAL_COST*area + cost[bvh[root].left] + cost[bvh[root].right];
+    if (leafCount < 3)
     {
-        if (atom_cmpxchg(&bvh[stack[top]].trav,0,1)==0)
+        return;
+    }
+
+    // optimal cost and partition of every subset
+    float subsetArea[TREELET_SUBSETS];
+    float subsetCost[TREELET_SUBSETS];
+    uint subsetSplit[TREELET_SUBSETS];
+    uint full = (1 << leafCount) - 1;
+    for (uint s=1; s<=full; s++)
+    {
+        float4 bbMin = (float4)( MAXFLOAT, MAXFLOAT,MAXFLOAT,0);
+        float4 bbMax = (float4)(-MAXFLOAT,-MAXFLOAT,-MAXFLOAT,0);
+        for (int i=0; i<leafCount; i++)
         {
-            bvh[stack[top]].trav = 2;
-            return;
-        };  
+            if ((s >> i) & 1)
+            {
+                bbMin = min(bbMin, bvh[leaves[i]].bbMin);
+                bbMax = max(bbMax, bvh[leaves[i]].bbMax);
+            }
+        }
+        subsetArea[s] = surfaceArea(bbMin, bbMax);
+    }
+    for (int i=0; i<leafCount; i++)
+    {
+        subsetCost[1 << i] = cost[leaves[i]];
+    }
+    for (uint s=1; s<=full; s++)
+    {
+        if ((s & (s-1)) == 0)
+        {
+            continue;
+        }
 
-        while (atom_cmpxchg(&bvh[stack[top]].trav,2,3)==1);
+        // each partition once, the left side holds the lowest leaf
+        uint low = s & (~s + 1);
+        float best = MAXFLOAT;
+        uint split = 0;
+        for (uint p=(s-1)&s; p; p=(p-1)&s)
+        {
+            if (p & low)
+            {
+                float c = subsetCost[p] + subsetCost[s ^ p];
+                if (c < best)
+                {
+                    best = c;
+                    split = p;
+                }
+            }
+        }
+        subsetCost[s] = SAH_INTERNAL_COST*subsetArea[s] + best;
+        subsetSplit[s] = split;
+    }
 
-        uint left = bvh[stack[top]].left;
-        uint right = bvh[stack[top]].right;
-        bvh[stack[top]].bbMin = bvh[left].bbMin;
-        bvh[stack[top]].bbMax = bvh[left].bbMax;
-        bvh[stack[top]].bbMin = min(bvh[stack[top]].bbMin, bvh[right].bbMin);
-        bvh[stack[top]].bbMax = max(bvh[stack[top]].bbMax, bvh[right].bbMax);
+    if (subsetCost[full] >= cost[root])
+    {
+        return;
     }
 
+    // rebuild the treelet top-down reusing its internal nodes
+    uint stackSet[TREELET_SIZE];
+    int stackNode[TREELET_SIZE];
+    int order[TREELET_SIZE-1];
+    int top = 0;
+    int orderCount = 0;
+    int next = 1;
+    stackSet[top] = full;
+    stackNode[top] = root;
+    top++;
+    while (top)
+    {
+        top--;
+        uint s = stackSet[top];
+        int n = stackNode[top];
+        order[orderCount++] = n;
+
+        uint sub[2];
+        int child[2];
+        sub[0] = subsetSplit[s];
+        sub[1] = s ^ subsetSplit[s];
+        for (int c=0; c<2; c++)
+        {
+            if ((sub[c] & (sub[c]-1)) == 0)
+            {
+                child[c] = leaves[lowestBit(sub[c])];
+            }
+            else
+            {
+                child[c] = internal[next++];
+                stackSet[top] = sub[c];
+                stackNode[top] = child[c];
+                top++;
+            }
+            parent[child[c]] = n;
+        }
+        bvh[n].left = child[0];
+        bvh[n].right = child[1];
+    }
+
+    // children were emitted after their parents
+    for (int i=orderCount-1; i>=0; i--)
+    {
+        int n = order[i];
+        int left = bvh[n].left;
+        int right = bvh[n].right;
+        bvh[n].bbMin = min(bvh[left].bbMin, bvh[right].bbMin);
+        bvh[n].bbMax = max(bvh[left].bbMax, bvh[right].bbMax);
+        cost[n] = SAH_INTERNAL_COST*surfaceArea(bvh[n].bbMin, bvh[n].bbMax) + cost[left] + cost[right];
+    }
+}
+
+__kernel void clOptimizeTreelets(__global BVHNode* bvh, __global int* parent, __global float* cost)
+{
+    int globalid = get_global_id(0);
+    int leafstart = get_global_size(0)-1;
+
+    int node = leafstart+globalid;
+    cost[node] = SAH_LEAF_COST*surfaceArea(bvh[node].bbMin, bvh[node].bbMax);
+
+    node = parent[node];
+    while (node != -1)
+    {
+        mem_fence(CLK_GLOBAL_MEM_FENCE);
+        if (atom_inc(&bvh[node].trav) == 0)
+        {
+            return;
+        }
+
+        optimizeTreelet(bvh, parent, cost, node);
+        node = parent[node];
+    }
 }
@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <math.h>
+#include <float.h>
+#include <vector>
 
 #include "oclBvhTrimesh.h"
 
 const size_t oclBvhTrimesh::cWarpSize = 32;
+const size_t oclBvhTrimesh::cSahBlockSize = 256;
 
 oclBvhTrimesh::oclBvhTrimesh(oclContext& iContext)
   : oclProgram(iContext, "oclBvhTrimesh")
@@ -23,35 +26,63 @@ oclBvhTrimesh::oclBvhTrimesh(oclContext& iContext)
   , bfAABB(iContext, "bfAABB")
   , bfMortonKey(iContext, "bfMortonKey")
   , bfMortonVal(iContext, "bfMortonVal")
+  , bfMortonKey64(iContext, "bfMortonKey64")
   , bfBvhRoot(iContext, "bfBvhRoot")
   , bfBvhNode(iContext, "bfBvhNode")
+  , bfBvhParent(iContext, "bfBvhParent")
+  , bfNodeCost(iContext, "bfNodeCost")
+  , bfSahPartial(iContext, "bfSahPartial")
     // kernels
   , clAABB(*this)
   , clMorton(*this)
+  , clMorton64(*this)
+  , clSplitKey(*this)
   , clCreateNodes(*this)
+  , clCreateNodes64(*this)
   , clLinkNodes(*this)
   , clCreateLeaves(*this)
+  , clComputeParents(*this)
   , clComputeAABBs(*this)
+  , clResetTraversal(*this)
+  , clSurfaceArea(*this)
+  , clOptimizeTreelets(*this)
     // programs
   , mRadixSort(iContext)
     // members
   , mRootNode(0)
+  , mTriangles(0)
+  , mBuildCost(0)
+  , mSahCost(0)
+  , mRebuildThreshold(1.5f)
+  , mMortonCode64(false)
+  , mTreeletPasses(0)
 {
     bfAABB.create<srtAABB>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
     bfMortonKey.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 256);
     bfMortonVal.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 256);
+    bfMortonKey64.create<cl_ulong>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
     bfBvhNode.create<cl_char>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
+    bfBvhParent.create<cl_int>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
+    bfNodeCost.create<cl_float>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
     bfBvhRoot.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, 1, 
                               &mRootNode);
+    bfSahPartial.create<cl_float>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
 
     addSourceFile("geom/oclBvhTrimesh.cl");
 
     exportKernel(clAABB);
     exportKernel(clMorton);
+    exportKernel(clMorton64);
+    exportKernel(clSplitKey);
     exportKernel(clCreateNodes);
+    exportKernel(clCreateNodes64);
     exportKernel(clLinkNodes);
     exportKernel(clCreateLeaves);
+    exportKernel(clComputeParents);
     exportKernel(clComputeAABBs);
+    exportKernel(clResetTraversal);
+    exportKernel(clSurfaceArea);
+    exportKernel(clOptimizeTreelets);
 }
 
 oclBvhTrimesh::~oclBvhTrimesh()
@@ -63,10 +94,18 @@ int oclBvhTrimesh::compile()
 {
     clAABB = 0;
     clMorton = 0;
+    clMorton64 = 0;
+    clSplitKey = 0;
     clCreateNodes = 0;
+    clCreateNodes64 = 0;
     clLinkNodes = 0;
     clCreateLeaves = 0;
+    clComputeParents = 0;
     clComputeAABBs = 0;
+    clResetTraversal = 0;
+    clSurfaceArea = 0;
+    clOptimizeTreelets = 0;
+    mTriangles = 0;
 
     if (!mRadixSort.compile())
     {
@@ -82,14 +121,28 @@ int oclBvhTrimesh::compile()
     KERNEL_VALIDATE(clAABB)
     clMorton = createKernel("clMorton");
     KERNEL_VALIDATE(clMorton)
+    clMorton64 = createKernel("clMorton64");
+    KERNEL_VALIDATE(clMorton64)
+    clSplitKey = createKernel("clSplitKey");
+    KERNEL_VALIDATE(clSplitKey)
     clCreateNodes = createKernel("clCreateNodes");
     KERNEL_VALIDATE(clCreateNodes)
+    clCreateNodes64 = createKernel("clCreateNodes64");
+    KERNEL_VALIDATE(clCreateNodes64)
     clLinkNodes = createKernel("clLinkNodes");
     KERNEL_VALIDATE(clLinkNodes)
     clCreateLeaves = createKernel("clCreateLeaves");
     KERNEL_VALIDATE(clCreateLeaves)
+    clComputeParents = createKernel("clComputeParents");
+    KERNEL_VALIDATE(clComputeParents)
     clComputeAABBs = createKernel("clComputeAABBs");
     KERNEL_VALIDATE(clComputeAABBs)
+    clResetTraversal = createKernel("clResetTraversal");
+    KERNEL_VALIDATE(clResetTraversal)
+    clSurfaceArea = createKernel("clSurfaceArea");
+    KERNEL_VALIDATE(clSurfaceArea)
+    clOptimizeTreelets = createKernel("clOptimizeTreelets");
+    KERNEL_VALIDATE(clOptimizeTreelets)
     return 1;
 }
 
@@ -102,7 +155,13 @@ int oclBvhTrimesh::compute(oclDevice& iDevice, oclBuffer& bfVertex,
     }
     
     cl_uint lVertices = bfVertex.count<cl_float4>();
-    size_t lTriangles = bfIndex.count<size_t>()/3;
+    size_t lTriangles = bfIndex.count<cl_uint>()/3;
+    if (lTriangles < 2)
+    {
+        // the kernels over the lTriangles-1 internal nodes would run empty
+        Log(ERR, this) << "A hierarchy needs at least 2 triangles, got " << lTriangles;
+        return false;
+    }
 
     if (bfMortonKey.count<cl_uint>() != lTriangles)
     {
@@ -116,11 +175,33 @@ int oclBvhTrimesh::compute(oclDevice& iDevice, oclBuffer& bfVertex,
     {
         bfBvhNode.resize<BVHNode>(2*lTriangles-1);
     }
+    if (bfBvhParent.count<cl_int>() != 2*lTriangles-1)
+    {
+        bfBvhParent.resize<cl_int>(2*lTriangles-1);
+    }
+    if (mMortonCode64 && bfMortonKey64.count<cl_ulong>() != lTriangles)
+    {
+        bfMortonKey64.resize<cl_ulong>(lTriangles);
+    }
+    if (mTreeletPasses > 0 && bfNodeCost.count<cl_float>() != 2*lTriangles-1)
+    {
+        bfNodeCost.resize<cl_float>(2*lTriangles-1);
+    }
 
 
     //
     // compute global AABB
     //
+    // reset, clAABB only grows the box of the previous build
+    srtAABB lInitAABB = { {  FLT_MAX,  FLT_MAX,  FLT_MAX, 0 }, 
+                          { -FLT_MAX, -FLT_MAX, -FLT_MAX, 0 }, 0 };
+    sStatusCL = clEnqueueWriteBuffer(iDevice, bfAABB, CL_TRUE, 0, 
+                                     sizeof(srtAABB), &lInitAABB, 0, NULL, NULL);
+    if (!oclSuccess("clEnqueueWriteBuffer", this))
+    {
+        return false;
+    }
+
     size_t lBatchSize = ceil(ceil(lVertices/8.0)/cWarpSize)*cWarpSize;
     clSetKernelArg(clAABB, 0, sizeof(cl_mem), bfVertex);
     clSetKernelArg(clAABB, 1, sizeof(cl_mem), bfAABB);
@@ -138,30 +219,130 @@ int oclBvhTrimesh::compute(oclDevice& iDevice, oclBuffer& bfVertex,
     ENQUEUE_VALIDATE
 
     //
-    // Compute morton curve
+    // Compute morton curve and create BVH
     //	 
+    if (mMortonCode64)
+    {
+        if (!createNodes64(iDevice, bfVertex, bfIndex, lTriangles))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (!createNodes(iDevice, bfVertex, bfIndex, lTriangles))
+        {
+            return false;
+        }
+    }
+
+    size_t lGlobalSize = lTriangles-1;
+    clSetKernelArg(clLinkNodes, 0, sizeof(cl_mem), bfMortonKey);
+    clSetKernelArg(clLinkNodes, 1, sizeof(cl_mem), bfBvhNode);
+    clSetKernelArg(clLinkNodes, 2, sizeof(cl_mem), bfBvhRoot);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clLinkNodes, 1, NULL, 
+                                       &lGlobalSize, NULL, 0, NULL, 
+                                       clLinkNodes.getEvent());
+    ENQUEUE_VALIDATE
+
+    clSetKernelArg(clCreateLeaves, 0, sizeof(cl_mem), bfMortonVal);
+    clSetKernelArg(clCreateLeaves, 1, sizeof(cl_mem), bfBvhNode);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clCreateLeaves, 1, NULL, 
+                                       &lTriangles, NULL, 0, NULL, 
+                                       clCreateLeaves.getEvent());
+    ENQUEUE_VALIDATE
+
+    bfBvhRoot.map(CL_MAP_READ);
+    bfBvhRoot.unmap();
+
+    clSetKernelArg(clComputeParents, 0, sizeof(cl_mem), bfBvhNode);
+    clSetKernelArg(clComputeParents, 1, sizeof(cl_mem), bfBvhParent);
+    clSetKernelArg(clComputeParents, 2, sizeof(cl_mem), bfBvhRoot);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clComputeParents, 1, NULL, 
+                                       &lGlobalSize, NULL, 0, NULL, 
+                                       clComputeParents.getEvent());
+    ENQUEUE_VALIDATE
+
+    if (!computeAABBs(iDevice, bfVertex, bfIndex, lTriangles))
+    {
+        return false;
+    }
+
+    for (int i=0; i<mTreeletPasses; i++)
+    {
+        if (!resetTraversal(iDevice, lTriangles))
+        {
+            return false;
+        }
+
+        clSetKernelArg(clOptimizeTreelets, 0, sizeof(cl_mem), bfBvhNode);
+        clSetKernelArg(clOptimizeTreelets, 1, sizeof(cl_mem), bfBvhParent);
+        clSetKernelArg(clOptimizeTreelets, 2, sizeof(cl_mem), bfNodeCost);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clOptimizeTreelets, 1, NULL, 
+                                           &lTriangles, NULL, 0, NULL, 
+                                           clOptimizeTreelets.getEvent());
+        ENQUEUE_VALIDATE
+    }
+
+    mTriangles = lTriangles;
+    if (!computeSahCost(iDevice, lTriangles, mBuildCost))
+    {
+        return false;
+    }
+    mSahCost = mBuildCost;
+    return true;
+}
+
+int oclBvhTrimesh::refit(oclDevice& iDevice, oclBuffer& bfVertex, 
+                         oclBuffer& bfIndex)
+{
+    size_t lTriangles = bfIndex.count<cl_uint>()/3;
+    if (lTriangles < 2 || lTriangles != mTriangles)
+    {
+        // no hierarchy for this topology yet, compute rejects too small meshes
+        return compute(iDevice, bfVertex, bfIndex);
+    }
+
+    if (!resetTraversal(iDevice, lTriangles))
+    {
+        return false;
+    }
+
+    if (!computeAABBs(iDevice, bfVertex, bfIndex, lTriangles))
+    {
+        return false;
+    }
+
+    if (!computeSahCost(iDevice, lTriangles, mSahCost))
+    {
+        return false;
+    }
+    if (mSahCost > mBuildCost*mRebuildThreshold)
+    {
+        Log(INFO, this) << "SAH cost degraded from " << mBuildCost << " to " << mSahCost << ", rebuilding";
+        return compute(iDevice, bfVertex, bfIndex);
+    }
+    return true;
+}
+
+int oclBvhTrimesh::createNodes(oclDevice& iDevice, oclBuffer& bfVertex, 
+                               oclBuffer& bfIndex, size_t iTriangles)
+{
     clSetKernelArg(clMorton, 0, sizeof(cl_mem), bfIndex);
     clSetKernelArg(clMorton, 1, sizeof(cl_mem), bfVertex);
     clSetKernelArg(clMorton, 2, sizeof(cl_mem), bfMortonKey);
     clSetKernelArg(clMorton, 3, sizeof(cl_mem), bfMortonVal);
     clSetKernelArg(clMorton, 4, sizeof(cl_mem), bfAABB);
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clMorton, 1, NULL, &lTriangles, 
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clMorton, 1, NULL, &iTriangles, 
                                        NULL, 0, NULL, clMorton.getEvent());
     ENQUEUE_VALIDATE
 
-    // 
-    // Sort morton curve
-    //	
     if (!mRadixSort.compute(iDevice, bfMortonKey, bfMortonVal, 0, 32))
     {
-        return 0;
+        return false;
     }
 
-    //
-    // Create BVH
-    //	
-    size_t lGlobalSize = lTriangles-1;
-
+    size_t lGlobalSize = iTriangles-1;
     clSetKernelArg(clCreateNodes, 0, sizeof(cl_mem), bfMortonKey);
     clSetKernelArg(clCreateNodes, 1, sizeof(cl_mem), bfMortonVal);
     clSetKernelArg(clCreateNodes, 2, sizeof(cl_mem), bfBvhNode);
@@ -169,36 +350,148 @@ int oclBvhTrimesh::compute(oclDevice& iDevice, oclBuffer& bfVertex,
                                        &lGlobalSize, NULL, 0, NULL, 
                                        clCreateNodes.getEvent());
     ENQUEUE_VALIDATE
+    return true;
+}
 
-    clSetKernelArg(clLinkNodes, 0, sizeof(cl_mem), bfMortonKey);
-    clSetKernelArg(clLinkNodes, 1, sizeof(cl_mem), bfBvhNode);
-    clSetKernelArg(clLinkNodes, 2, sizeof(cl_mem), bfBvhRoot);
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clLinkNodes, 1, NULL, 
+int oclBvhTrimesh::createNodes64(oclDevice& iDevice, oclBuffer& bfVertex, 
+                                 oclBuffer& bfIndex, size_t iTriangles)
+{
+    clSetKernelArg(clMorton64, 0, sizeof(cl_mem), bfIndex);
+    clSetKernelArg(clMorton64, 1, sizeof(cl_mem), bfVertex);
+    clSetKernelArg(clMorton64, 2, sizeof(cl_mem), bfMortonKey64);
+    clSetKernelArg(clMorton64, 3, sizeof(cl_mem), bfMortonVal);
+    clSetKernelArg(clMorton64, 4, sizeof(cl_mem), bfAABB);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clMorton64, 1, NULL, &iTriangles, 
+                                       NULL, 0, NULL, clMorton64.getEvent());
+    ENQUEUE_VALIDATE
+
+    // least significant word first, the radix sort is stable so sorting 
+    // the gathered high words afterwards orders the full 63 bit codes
+    for (cl_uint lShift = 0; lShift <= 32; lShift += 32)
+    {
+        clSetKernelArg(clSplitKey, 0, sizeof(cl_mem), bfMortonKey64);
+        clSetKernelArg(clSplitKey, 1, sizeof(cl_mem), bfMortonVal);
+        clSetKernelArg(clSplitKey, 2, sizeof(cl_mem), bfMortonKey);
+        clSetKernelArg(clSplitKey, 3, sizeof(cl_uint), &lShift);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clSplitKey, 1, NULL, &iTriangles, 
+                                           NULL, 0, NULL, clSplitKey.getEvent());
+        ENQUEUE_VALIDATE
+
+        if (!mRadixSort.compute(iDevice, bfMortonKey, bfMortonVal, 0, 32))
+        {
+            return false;
+        }
+    }
+
+    size_t lGlobalSize = iTriangles-1;
+    clSetKernelArg(clCreateNodes64, 0, sizeof(cl_mem), bfMortonKey64);
+    clSetKernelArg(clCreateNodes64, 1, sizeof(cl_mem), bfMortonVal);
+    clSetKernelArg(clCreateNodes64, 2, sizeof(cl_mem), bfBvhNode);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clCreateNodes64, 1, NULL, 
                                        &lGlobalSize, NULL, 0, NULL, 
-                                       clLinkNodes.getEvent());
+                                       clCreateNodes64.getEvent());
     ENQUEUE_VALIDATE
+    return true;
+}
 
-    clSetKernelArg(clCreateLeaves, 0, sizeof(cl_mem), bfMortonVal);
-    clSetKernelArg(clCreateLeaves, 1, sizeof(cl_mem), bfBvhNode);
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clCreateLeaves, 1, NULL, 
-                                       &lTriangles, NULL, 0, NULL, 
-                                       clCreateLeaves.getEvent());
+int oclBvhTrimesh::resetTraversal(oclDevice& iDevice, size_t iTriangles)
+{
+    size_t lGlobalSize = iTriangles-1;
+    clSetKernelArg(clResetTraversal, 0, sizeof(cl_mem), bfBvhNode);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clResetTraversal, 1, NULL, 
+                                       &lGlobalSize, NULL, 0, NULL, 
+                                       clResetTraversal.getEvent());
     ENQUEUE_VALIDATE
+    return true;
+}
 
+int oclBvhTrimesh::computeAABBs(oclDevice& iDevice, oclBuffer& bfVertex, 
+                                oclBuffer& bfIndex, size_t iTriangles)
+{
     clSetKernelArg(clComputeAABBs, 0, sizeof(cl_mem), bfIndex);
     clSetKernelArg(clComputeAABBs, 1, sizeof(cl_mem), bfVertex);
     clSetKernelArg(clComputeAABBs, 2, sizeof(cl_mem), bfBvhNode);
-    clSetKernelArg(clComputeAABBs, 3, sizeof(cl_mem), bfBvhRoot);
+    clSetKernelArg(clComputeAABBs, 3, sizeof(cl_mem), bfBvhParent);
     sStatusCL = clEnqueueNDRangeKernel(iDevice, clComputeAABBs, 1, 
-                                       NULL, &lTriangles, NULL, 0, NULL, 
+                                       NULL, &iTriangles, NULL, 0, NULL, 
                                        clComputeAABBs.getEvent());
     ENQUEUE_VALIDATE
-        
-    bfBvhRoot.map(CL_MAP_READ);
-    bfBvhRoot.unmap();
- 
     return true;
 }
+
+int oclBvhTrimesh::computeSahCost(oclDevice& iDevice, size_t iTriangles, 
+                                  float& oCost)
+{
+    cl_uint lInternalCount = iTriangles-1;
+    cl_uint lNodeCount = 2*iTriangles-1;
+    size_t lGroups = (lNodeCount + cSahBlockSize - 1)/cSahBlockSize;
+    size_t lGlobalSize = lGroups*cSahBlockSize;
+    if (bfSahPartial.count<cl_float>() < lGroups)
+    {
+        bfSahPartial.resize<cl_float>(lGroups);
+    }
+
+    clSetKernelArg(clSurfaceArea, 0, sizeof(cl_mem), bfBvhNode);
+    clSetKernelArg(clSurfaceArea, 1, sizeof(cl_uint), &lInternalCount);
+    clSetKernelArg(clSurfaceArea, 2, sizeof(cl_uint), &lNodeCount);
+    clSetKernelArg(clSurfaceArea, 3, sizeof(cl_mem), bfSahPartial);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clSurfaceArea, 1, NULL, 
+                                       &lGlobalSize, &cSahBlockSize, 0, NULL, 
+                                       clSurfaceArea.getEvent());
+    ENQUEUE_VALIDATE
+
+    std::vector<cl_float> lPartial(lGroups);
+    sStatusCL = clEnqueueReadBuffer(iDevice, bfSahPartial, CL_TRUE, 0, 
+                                    lGroups*sizeof(cl_float), &lPartial[0], 
+                                    0, NULL, NULL);
+    if (!oclSuccess("clEnqueueReadBuffer", this))
+    {
+        return false;
+    }
+
+    BVHNode lRoot;
+    sStatusCL = clEnqueueReadBuffer(iDevice, bfBvhNode, CL_TRUE, 
+                                    mRootNode*sizeof(BVHNode), sizeof(BVHNode), 
+                                    &lRoot, 0, NULL, NULL);
+    if (!oclSuccess("clEnqueueReadBuffer", this))
+    {
+        return false;
+    }
+
+    float lSum = 0;
+    for (size_t i=0; i<lGroups; i++)
+    {
+        lSum += lPartial[i];
+    }
+
+    float lX = lRoot.bbMax.s[0] - lRoot.bbMin.s[0];
+    float lY = lRoot.bbMax.s[1] - lRoot.bbMin.s[1];
+    float lZ = lRoot.bbMax.s[2] - lRoot.bbMin.s[2];
+    float lRootArea = 2.0f*(lX*lY + lY*lZ + lZ*lX);
+    oCost = lRootArea > 0 ? lSum/lRootArea : 0;
+    return true;
+}
+
+void oclBvhTrimesh::setMortonCode64(bool iState)
+{
+    mMortonCode64 = iState;
+}
+
+void oclBvhTrimesh::setTreeletPasses(int iPasses)
+{
+    mTreeletPasses = iPasses;
+}
+
+void oclBvhTrimesh::setRebuildThreshold(float iThreshold)
+{
+    mRebuildThreshold = iThreshold;
+}
+
+float oclBvhTrimesh::getSahCost()
+{
+    return mSahCost;
+}
+
 //
 
 cl_uint oclBvhTrimesh::getRootNode()
@@ -26,10 +26,26 @@ class oclBvhTrimesh : public oclProgram
        ~oclBvhTrimesh();
 
         int compile();
+
+        // fails for meshes with less than 2 triangles
         int compute(oclDevice& iDevice, 
                     oclBuffer& bfVertex, 
                     oclBuffer& bIndex);
 
+        // recomputes the AABBs of the last hierarchy for moved vertices, rebuilds
+        // if the topology changed or the SAH cost degraded beyond the threshold
+        int refit(oclDevice& iDevice, 
+                  oclBuffer& bfVertex, 
+                  oclBuffer& bIndex);
+
+        // 63 bit instead of 30 bit Morton codes, sorted in two 32 bit passes
+        void setMortonCode64(bool iState);
+        // number of treelet restructuring passes after the build, 0 disables
+        void setTreeletPasses(int iPasses);
+
+        void setRebuildThreshold(float iThreshold);
+        float getSahCost();
+
         typedef struct 
         {
             cl_float4 bbMin;
@@ -48,12 +64,22 @@ class oclBvhTrimesh : public oclProgram
 
     protected:
         static const size_t cWarpSize;
+        static const size_t cSahBlockSize;
 
         oclRadixSort mRadixSort;
 
         void create();
         void destroy();
 
+        int createNodes(oclDevice& iDevice, oclBuffer& bfVertex, 
+                        oclBuffer& bfIndex, size_t iTriangles);
+        int createNodes64(oclDevice& iDevice, oclBuffer& bfVertex, 
+                          oclBuffer& bfIndex, size_t iTriangles);
+        int resetTraversal(oclDevice& iDevice, size_t iTriangles);
+        int computeAABBs(oclDevice& iDevice, oclBuffer& bfVertex, 
+                         oclBuffer& bfIndex, size_t iTriangles);
+        int computeSahCost(oclDevice& iDevice, size_t iTriangles, float& oCost);
+
         typedef struct 
         {
             cl_float4 bbMin;
@@ -68,18 +94,37 @@ class oclBvhTrimesh : public oclProgram
 
         oclKernel clAABB;
         oclKernel clMorton;
+        oclKernel clMorton64;
+        oclKernel clSplitKey;
         oclKernel clCreateNodes;
+        oclKernel clCreateNodes64;
         oclKernel clLinkNodes;
         oclKernel clCreateLeaves;
+        oclKernel clComputeParents;
         oclKernel clComputeAABBs;
+        oclKernel clResetTraversal;
+        oclKernel clSurfaceArea;
+        oclKernel clOptimizeTreelets;
 
         oclBuffer bfAABB;
         oclBuffer bfMortonKey;
         oclBuffer bfMortonVal;
+        oclBuffer bfMortonKey64;
         oclBuffer bfBvhRoot;
         oclBuffer bfBvhNode;
+        oclBuffer bfBvhParent;
+        oclBuffer bfNodeCost;
+        oclBuffer bfSahPartial;
 
         cl_uint mRootNode;
+        size_t mTriangles;
+
+        float mBuildCost;
+        float mSahCost;
+        float mRebuildThreshold;
+
+        bool mMortonCode64;
+        int mTreeletPasses;
 };
 
 #endif
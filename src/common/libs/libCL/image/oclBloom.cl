@@ -12,6 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+float4 bloomFilter(float4 RGBA, float threshold)
+{
+    //float luminance = dot(vec4(0.27,0.67,0.06,0.0),RGB);
+    float luminance = dot((float4)(0.2126,0.7152,0.0722,0.0),RGBA);
+
+    if (luminance <= threshold)
+    {
+        RGBA = (float4)(0.0,0.0,0.0,0.0);
+    }
+    return RGBA;
+}
+
+float4 bloomCombine(float4 RGBA, float4 BLOOM, float intensity)
+{
+    return RGBA + BLOOM*exp(intensity*dot((float4)(0.2126,0.7152,0.0722,0.0),RGBA));
+}
+
 __kernel void clFilter(__read_only image2d_t RGBAin, __write_only image2d_t RGBAout, float threshold)
 {
     const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_LINEAR | CLK_ADDRESS_CLAMP;
@@ -22,15 +39,8 @@ __kernel void clFilter(__read_only image2d_t RGBAin, __write_only image2d_t RGBA
     float2 pixel = (float2)(gx+0.5,gy+0.5);
 
     float4 RGBA = read_imagef(RGBAin, sampler, pixel);
-    //float luminance = dot(vec4(0.27,0.67,0.06,0.0),RGB);
-    float luminance = dot((float4)(0.2126,0.7152,0.0722,0.0),RGBA);
-
-    if (luminance <= threshold)
-    {
-        RGBA = (float4)(0.0,0.0,0.0,0.0);
-    }
 
-    write_imagef(RGBAout, (int2)(gx,gy), RGBA);
+    write_imagef(RGBAout, (int2)(gx,gy), bloomFilter(RGBA, threshold));
 }
 
 __kernel void clCombine(__read_only image2d_t RGBAin, __read_only image2d_t Bloom, __write_only image2d_t RGBAout, float intensity)
@@ -39,13 +49,46 @@ __kernel void clCombine(__read_only image2d_t RGBAin, __read_only image2d_t Bloo
 
     const int gx = get_global_id(0);
     const int gy = get_global_id(1);
-    const float gw = get_global_size(0);
-    const float gh = get_global_size(1);
 
     float2 pixel = (float2)(gx,gy);
 
     float4 RGBA = read_imagef(RGBAin, sampler, pixel);
-    float4 BLOOM = read_imagef(Bloom, sampler, pixel)*exp(intensity*dot((float4)(0.2126,0.7152,0.0722,0.0),RGBA));
+    float4 BLOOM = read_imagef(Bloom, sampler, pixel);
+
+    write_imagef(RGBAout, (int2)(gx,gy), bloomCombine(RGBA, BLOOM, intensity));
+}
+
+// adds the bright part of a pyramid level to the upsampled glow of the next coarser level
+__kernel void clGlow(__read_only image2d_t level, __read_only image2d_t glowIn, __write_only image2d_t glowOut, float threshold, float weight, int coarsest)
+{
+    const sampler_t sampler = CLK_NORMALIZED_COORDS_TRUE | CLK_FILTER_LINEAR | CLK_ADDRESS_CLAMP_TO_EDGE;
+
+    const int gx = get_global_id(0);
+    const int gy = get_global_id(1);
+
+    float2 pixel = (float2)((gx+0.5f)/get_global_size(0), (gy+0.5f)/get_global_size(1));
+
+    float4 GLOW = bloomFilter(read_imagef(level, sampler, pixel), threshold)*weight;
+    if (!coarsest)
+    {
+        GLOW += read_imagef(glowIn, sampler, pixel);
+    }
+
+    write_imagef(glowOut, (int2)(gx,gy), GLOW);
+}
+
+__kernel void clCombineGlow(__read_only image2d_t RGBAin, __read_only image2d_t Glow, __write_only image2d_t RGBAout, float intensity)
+{
+    const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP;
+    const sampler_t linear = CLK_NORMALIZED_COORDS_TRUE | CLK_FILTER_LINEAR | CLK_ADDRESS_CLAMP_TO_EDGE;
+
+    const int gx = get_global_id(0);
+    const int gy = get_global_id(1);
+
+    float2 pixel = (float2)((gx+0.5f)/get_global_size(0), (gy+0.5f)/get_global_size(1));
+
+    float4 RGBA = read_imagef(RGBAin, sampler, (int2)(gx,gy));
+    float4 GLOW = read_imagef(Glow, linear, pixel);
 
-    write_imagef(RGBAout, (int2)(gx,gy), RGBA + BLOOM);
+    write_imagef(RGBAout, (int2)(gx,gy), bloomCombine(RGBA, GLOW, intensity));
 }
@@ -15,7 +15,7 @@
 
 #include <math.h>
 
-oclBloom::oclBloom(oclContext& iContext, cl_image_format iFormat)
+oclBloom::oclBloom(oclContext& iContext, cl_image_format iFormat, oclBilinearPyramid* iPyramid)
 : oclProgram(iContext, "oclBloom")
 , mGaussian(iContext)
 // buffers
@@ -24,6 +24,13 @@ oclBloom::oclBloom(oclContext& iContext, cl_image_format iFormat)
 // kernels
 , clFilter(*this)
 , clCombine(*this)
+, clGlow(*this)
+, clCombineGlow(*this)
+// programs
+, mOwnPyramid(iContext)
+, mPyramid(iPyramid ? iPyramid : &mOwnPyramid)
+, mPyramidGlow(false)
+, mFormat(iFormat)
 {
     bfTempA.create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, iFormat, 256, 256);
     bfTempB.create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, iFormat, 256, 256);
@@ -32,17 +39,33 @@ oclBloom::oclBloom(oclContext& iContext, cl_image_format iFormat)
 
     exportKernel(clFilter);
     exportKernel(clCombine);
+    exportKernel(clGlow);
+    exportKernel(clCombineGlow);
+}
+
+oclBloom::~oclBloom()
+{
+    for (unsigned int i=0; i<mGlow.size(); i++)
+    {
+        delete mGlow[i];
+    }
 }
 
 int oclBloom::compile()
 {
     clFilter = 0;
     clCombine = 0;
+    clGlow = 0;
+    clCombineGlow = 0;
 
     if (!mGaussian.compile())
     {
         return 0;
     }
+    if (mPyramid == &mOwnPyramid && !mOwnPyramid.compile())
+    {
+        return 0;
+    }
     if (!oclProgram::compile())
     {
         return 0;
@@ -50,10 +73,14 @@ int oclBloom::compile()
 
     clFilter = createKernel("clFilter");
     KERNEL_VALIDATE(clFilter)
+    clGlow = createKernel("clGlow");
+    KERNEL_VALIDATE(clGlow)
     setThreshold(0.9f);
 
     clCombine = createKernel("clCombine");
     KERNEL_VALIDATE(clCombine)
+    clCombineGlow = createKernel("clCombineGlow");
+    KERNEL_VALIDATE(clCombineGlow)
     setIntensity(0.9f);
 
     return 1;
@@ -62,6 +89,11 @@ int oclBloom::compile()
 
 int oclBloom::compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest)
 {
+    if (mPyramidGlow)
+    {
+        return glow(iDevice, bfSrce, bfDest);
+    }
+
     cl_uint lWidth = bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH);
     cl_uint lHeight = bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
 
@@ -97,6 +129,79 @@ int oclBloom::compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest
     return true;
 }
 
+int oclBloom::glow(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest)
+{
+    if (mPyramid == &mOwnPyramid)
+    {
+        mOwnPyramid.invalidate();
+    }
+    if (!mPyramid->update(iDevice, bfSrce))
+    {
+        return false;
+    }
+
+    // one glow image per pyramid level, only reallocated when the pyramid changes its size
+    unsigned int lLevels = mPyramid->getLevelCount();
+    if (lLevels == 0)
+    {
+        Log(ERR, this) << "source too small for a pyramid";
+        return false;
+    }
+    if (mGlow.size() != lLevels || mGlow[0]->dim(0) != mPyramid->getLevel(0)->dim(0) || mGlow[0]->dim(1) != mPyramid->getLevel(0)->dim(1))
+    {
+        for (unsigned int i=0; i<mGlow.size(); i++)
+        {
+            delete mGlow[i];
+        }
+        mGlow.resize(lLevels);
+        for (unsigned int i=0; i<lLevels; i++)
+        {
+            oclImage2D* lLevel = mPyramid->getLevel(i);
+            mGlow[i] = new oclImage2D(mContext, "bfGlow");
+            if (!mGlow[i]->create(CL_MEM_READ_WRITE, mFormat, lLevel->dim(0), lLevel->dim(1)))
+            {
+                for (unsigned int j=0; j<=i; j++)
+                {
+                    delete mGlow[j];
+                }
+                mGlow.clear();
+                Log(ERR, this) << "failed to allocate the glow levels";
+                return false;
+            }
+        }
+    }
+
+    // coarse to fine, every level adds its bright part to the upsampled glow of the coarser one
+    cl_float lWeight = 1.0f/lLevels;
+    for (int i=lLevels-1; i>=0; i--)
+    {
+        oclImage2D* lLevel = mPyramid->getLevel(i);
+        cl_int lCoarsest = (i == (int)lLevels-1);
+
+        size_t lGlobalWorkSize[2];
+        lGlobalWorkSize[0] = lLevel->dim(0);
+        lGlobalWorkSize[1] = lLevel->dim(1);
+        clSetKernelArg(clGlow, 0, sizeof(cl_mem), *lLevel);
+        clSetKernelArg(clGlow, 1, sizeof(cl_mem), lCoarsest ? *lLevel : *mGlow[i+1]);
+        clSetKernelArg(clGlow, 2, sizeof(cl_mem), *mGlow[i]);
+        clSetKernelArg(clGlow, 4, sizeof(cl_float), &lWeight);
+        clSetKernelArg(clGlow, 5, sizeof(cl_int), &lCoarsest);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clGlow, 2, NULL, lGlobalWorkSize, NULL, 0, NULL, clGlow.getEvent());
+        ENQUEUE_VALIDATE
+    }
+
+    size_t lGlobalWorkSize[2];
+    lGlobalWorkSize[0] = bfSrce.dim(0);
+    lGlobalWorkSize[1] = bfSrce.dim(1);
+    clSetKernelArg(clCombineGlow, 0, sizeof(cl_mem), bfSrce);
+    clSetKernelArg(clCombineGlow, 1, sizeof(cl_mem), *mGlow[0]);
+    clSetKernelArg(clCombineGlow, 2, sizeof(cl_mem), bfDest);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clCombineGlow, 2, NULL, lGlobalWorkSize, NULL, 0, NULL, clCombineGlow.getEvent());
+    ENQUEUE_VALIDATE
+
+    return true;
+}
+
 void oclBloom::setSmoothing(cl_float iValue)
 {
     mGaussian.setSigma(iValue);
@@ -105,11 +210,18 @@ void oclBloom::setSmoothing(cl_float iValue)
 void oclBloom::setThreshold(cl_float iValue)
 {
     clSetKernelArg(clFilter, 2, sizeof(cl_float), &iValue);
+    clSetKernelArg(clGlow, 3, sizeof(cl_float), &iValue);
 }
 
 void oclBloom::setIntensity(cl_float iValue)
 {
     clSetKernelArg(clCombine, 3, sizeof(cl_float), &iValue);
+    clSetKernelArg(clCombineGlow, 3, sizeof(cl_float), &iValue);
+}
+
+void oclBloom::setPyramidGlow(bool iEnable)
+{
+    mPyramidGlow = iEnable;
 }
 
 cl_image_format oclBloom::sDefaultFormat = { CL_RGBA,  CL_HALF_FLOAT };
@@ -20,12 +20,16 @@
 #include "oclContext.h"
 
 #include "filter/oclRecursiveGaussian.h"
+#include "filter/oclBilinearPyramid.h"
 
 class oclBloom : public oclProgram
 {
     public: 
 
-        oclBloom(oclContext& iContext, cl_image_format iFormat = sDefaultFormat);
+        // a shared pyramid of the source is used by the pyramid glow, it has to be compiled by its owner,
+        // who invalidates it once per frame
+        oclBloom(oclContext& iContext, cl_image_format iFormat = sDefaultFormat, oclBilinearPyramid* iPyramid = 0);
+        ~oclBloom();
 
         int compile();
         int compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest);
@@ -34,16 +38,29 @@ class oclBloom : public oclProgram
         void setThreshold(cl_float iValue);
         void setIntensity(cl_float iValue);
 
+        // gathers the glow from the pyramid levels instead of a gaussian blur of the bright parts
+        void setPyramidGlow(bool iEnable);
+
     protected:
 
         oclRecursiveGaussian mGaussian;
 
+        int glow(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest);
+
         oclKernel clFilter;
         oclKernel clCombine;
+        oclKernel clGlow;
+        oclKernel clCombineGlow;
 
         oclImage2D bfTempA;
         oclImage2D bfTempB;
 
+        oclBilinearPyramid mOwnPyramid;
+        oclBilinearPyramid* mPyramid;
+        vector<oclImage2D*> mGlow;
+        bool mPyramidGlow;
+        cl_image_format mFormat;
+
         static cl_image_format sDefaultFormat;
 };      
 
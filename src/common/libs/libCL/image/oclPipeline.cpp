@@ -0,0 +1,660 @@
+// Copyright [2011] [Geist Software Labs Inc.]
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <stdio.h>
+#include <algorithm>
+
+#include "oclPipeline.h"
+
+//
+// library stages
+//
+
+struct srtSobelStage : public srtStage
+{
+    srtSobelStage(oclSobel& iSobel)
+    : srtStage("sobel", 1, 2)
+    , mSobel(iSobel)
+    {
+    }
+
+    int operator() (oclDevice& iDevice, oclImage2D** iSrce, oclImage2D** iDest)
+    {
+        return mSobel.compute(iDevice, *iSrce[0], *iDest[0], *iDest[1]);
+    }
+
+    oclSobel& mSobel;
+};
+
+struct srtTangentStage : public srtStage
+{
+    srtTangentStage(oclTangent& iTangent)
+    : srtStage("tangent", 2, 1)
+    , mTangent(iTangent)
+    {
+    }
+
+    int operator() (oclDevice& iDevice, oclImage2D** iSrce, oclImage2D** iDest)
+    {
+        return mTangent.compute(iDevice, *iSrce[0], *iSrce[1], *iDest[0]);
+    }
+
+    oclTangent& mTangent;
+};
+
+struct srtLineConvStage : public srtStage
+{
+    srtLineConvStage(oclTangent& iTangent, int iDepth)
+    : srtStage("lineConv", 2, 1)
+    , mTangent(iTangent)
+    , mDepth(iDepth)
+    {
+    }
+
+    int operator() (oclDevice& iDevice, oclImage2D** iSrce, oclImage2D** iDest)
+    {
+        return mTangent.lineConv(iDevice, *iSrce[0], *iSrce[1], *iDest[0], mDepth);
+    }
+
+    oclTangent& mTangent;
+    cl_int mDepth;
+};
+
+//
+//
+//
+
+oclPipeline::oclPipeline(oclContext& iContext)
+: oclProgram(iContext, "oclPipeline")
+, mSlots(1)
+, mOutput(cSource)
+, mChanged(true)
+, mParamsChanged(true)
+, mPoolWidth(0)
+, mPoolHeight(0)
+// buffers
+, bfParams(iContext, "bfParams")
+// programs
+, mSobel(iContext)
+, mTangent(iContext)
+{
+    bfParams.create<cl_float>(CL_MEM_READ_ONLY, 256);
+}
+
+oclPipeline::~oclPipeline()
+{
+    clear();
+    for (unsigned int i=0; i<mPool.size(); i++)
+    {
+        delete mPool[i];
+    }
+}
+
+//
+//
+//
+
+int oclPipeline::compile()
+{
+    for (unsigned int i=0; i<mFusions.size(); i++)
+    {
+        delete mFusions[i].mKernel;
+    }
+    mFusions.clear();
+
+    if (!mSobel.compile() || !mTangent.compile())
+    {
+        return 0;
+    }
+
+    plan();
+    generate();
+
+    // the point-wise library functions are compiled together with the generated kernels
+    clrSource();
+    addSourceFile("color/oclColor.cl");
+    addSourceFile("color/oclQuantize.cl");
+    addSourceFile("image/oclBloom.cl");
+    addSourceCode((char*)mCode.c_str());
+
+    if (!oclProgram::compile())
+    {
+        return 0;
+    }
+
+    for (unsigned int i=0; i<mFusions.size(); i++)
+    {
+        srtFusion& lFusion = mFusions[i];
+        if (lFusion.mOutputs.empty())
+        {
+            continue; // nothing of this run is read, so it is never launched
+        }
+
+        char lName[32];
+        sprintf(lName, "clFused%d", i);
+        lFusion.mKernel = new oclKernel(*this);
+        *lFusion.mKernel = createKernel(lName);
+        if (!*lFusion.mKernel)
+        {
+            Log(ERR, this) << "Kernel " << lName << " not found in " << mName;
+            return 0;
+        }
+    }
+
+    mChanged = false;
+    return 1;
+}
+
+int oclPipeline::compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest)
+{
+    if (mNodes.empty() || mOutput == cSource)
+    {
+        Log(ERR, this) << "pipeline has no output";
+        return false;
+    }
+    if (mChanged && !compile())
+    {
+        return false;
+    }
+
+    size_t lWidth = bfSrce.getImageInfo<size_t>(CL_IMAGE_WIDTH);
+    size_t lHeight = bfSrce.getImageInfo<size_t>(CL_IMAGE_HEIGHT);
+    if (lWidth != mPoolWidth || lHeight != mPoolHeight)
+    {
+        for (unsigned int i=0; i<mPool.size(); i++)
+        {
+            mPool[i]->resize(lWidth, lHeight);
+        }
+        mPoolWidth = lWidth;
+        mPoolHeight = lHeight;
+    }
+
+    if (mParamsChanged && !mParams.empty())
+    {
+        if (bfParams.count<cl_float>() < mParams.size())
+        {
+            bfParams.resize<cl_float>(mParams.size());
+        }
+        sStatusCL = clEnqueueWriteBuffer(iDevice, bfParams, CL_TRUE, 0, mParams.size()*sizeof(cl_float), &mParams[0], 0, NULL, NULL);
+        if (!oclSuccess("clEnqueueWriteBuffer", this))
+        {
+            return false;
+        }
+        mParamsChanged = false;
+    }
+
+    size_t lGlobalSize[2];
+    lGlobalSize[0] = lWidth;
+    lGlobalSize[1] = lHeight;
+
+    // the queue is in order, so an image can go back to the pool as soon as its last reader is enqueued
+    vector<oclImage2D*> lSlots(mSlots, (oclImage2D*)0);
+    lSlots[cSource] = &bfSrce;
+
+    int lResult = true;
+    for (unsigned int i=0; i<mNodes.size() && lResult; i++)
+    {
+        srtNode& lNode = mNodes[i];
+        if (lNode.mStage)
+        {
+            oclImage2D* lSrce[cMaxPorts];
+            oclImage2D* lDest[cMaxPorts];
+            for (int k=0; k<lNode.mSrceCount; k++)
+            {
+                lSrce[k] = lSlots[lNode.mSrce[k]];
+            }
+            for (int k=0; k<lNode.mDestCount; k++)
+            {
+                int lSlot = lNode.mDest+k;
+                lSlots[lSlot] = (lSlot == mOutput) ? &bfDest : acquire();
+                lDest[k] = lSlots[lSlot];
+                lResult = lResult && lDest[k];
+            }
+            if (lResult && !(*lNode.mStage)(iDevice, lSrce, lDest))
+            {
+                Log(ERR, this) << "stage " << lNode.mStage->mName << " failed";
+                lResult = false;
+            }
+        }
+        else
+        {
+            srtFusion& lFusion = mFusions[lNode.mFusion];
+            if (lFusion.mLast != (int)i)
+            {
+                continue;
+            }
+
+            if (lFusion.mKernel)
+            {
+                int lArg = 0;
+                for (unsigned int k=0; k<lFusion.mInputs.size(); k++)
+                {
+                    clSetKernelArg(*lFusion.mKernel, lArg++, sizeof(cl_mem), *lSlots[lFusion.mInputs[k]]);
+                }
+                for (unsigned int k=0; k<lFusion.mOutputs.size() && lResult; k++)
+                {
+                    int lSlot = lFusion.mOutputs[k];
+                    lSlots[lSlot] = (lSlot == mOutput) ? &bfDest : acquire();
+                    if (lSlots[lSlot])
+                    {
+                        clSetKernelArg(*lFusion.mKernel, lArg++, sizeof(cl_mem), *lSlots[lSlot]);
+                    }
+                    else lResult = false;
+                }
+                clSetKernelArg(*lFusion.mKernel, lArg++, sizeof(cl_mem), bfParams);
+                if (lResult)
+                {
+                    sStatusCL = clEnqueueNDRangeKernel(iDevice, *lFusion.mKernel, 2, NULL, lGlobalSize, 0, 0, NULL, lFusion.mKernel->getEvent());
+                    lResult = oclSuccess("clEnqueueNDRangeKernel", this);
+                }
+            }
+        }
+
+        for (unsigned int k=0; k<lNode.mRelease.size(); k++)
+        {
+            release(lSlots[lNode.mRelease[k]]);
+        }
+    }
+
+    mFree = mPool;
+    return lResult;
+}
+
+//
+// Graph Interface
+//
+
+void oclPipeline::clear()
+{
+    for (unsigned int i=0; i<mFusions.size(); i++)
+    {
+        delete mFusions[i].mKernel;
+    }
+    for (unsigned int i=0; i<mOwned.size(); i++)
+    {
+        delete mOwned[i];
+    }
+    mFusions.clear();
+    mOwned.clear();
+    mNodes.clear();
+    mParams.clear();
+    mSlots = 1;
+    mOutput = cSource;
+    mChanged = true;
+}
+
+void oclPipeline::setOutput(int iSlot)
+{
+    if (iSlot <= cSource || iSlot >= mSlots)
+    {
+        Log(ERR, this) << "invalid output slot " << iSlot;
+        return;
+    }
+    mOutput = iSlot;
+    mChanged = true;
+}
+
+int oclPipeline::getOutput()
+{
+    return mOutput;
+}
+
+int oclPipeline::addPoint(const char* iExpression, int iSrceA, int iSrceB, const cl_float* iParams, int iParamCount)
+{
+    return addNode(iExpression, 0, iSrceA, iSrceB, 1, iParams, iParamCount);
+}
+
+int oclPipeline::setParams(int iSlot, const cl_float* iParams)
+{
+    for (unsigned int i=0; i<mNodes.size(); i++)
+    {
+        srtNode& lNode = mNodes[i];
+        if (lNode.mExpression && lNode.mDest == iSlot)
+        {
+            for (int k=0; k<lNode.mParamCount; k++)
+            {
+                mParams[lNode.mParam+k] = iParams[k];
+            }
+            mParamsChanged = true;
+            return true;
+        }
+    }
+    Log(ERR, this) << "no point node writes slot " << iSlot;
+    return false;
+}
+
+int oclPipeline::addStage(srtStage& iStage, int iSrceA, int iSrceB)
+{
+    int lInputs = (iSrceB < 0) ? 1 : 2;
+    if (iStage.mInputs != lInputs || iStage.mOutputs < 1 || iStage.mOutputs > cMaxPorts)
+    {
+        Log(ERR, this) << "stage " << iStage.mName << " does not match its " << lInputs << " inputs";
+        return -1;
+    }
+    return addNode(0, &iStage, iSrceA, iSrceB, iStage.mOutputs, 0, 0);
+}
+
+int oclPipeline::addNode(const char* iExpression, srtStage* iStage, int iSrceA, int iSrceB, int iDestCount, const cl_float* iParams, int iParamCount)
+{
+    srtNode lNode;
+    lNode.mExpression = iExpression;
+    lNode.mStage = iStage;
+    lNode.mSrce[0] = iSrceA;
+    lNode.mSrce[1] = iSrceB;
+    lNode.mSrceCount = (iSrceB < 0) ? 1 : 2;
+    for (int k=0; k<lNode.mSrceCount; k++)
+    {
+        if (lNode.mSrce[k] < 0 || lNode.mSrce[k] >= mSlots)
+        {
+            Log(ERR, this) << "invalid input slot " << lNode.mSrce[k];
+            return -1;
+        }
+    }
+
+    lNode.mDest = mSlots;
+    lNode.mDestCount = iDestCount;
+    lNode.mParam = mParams.size();
+    lNode.mParamCount = iParams ? iParamCount : 0;
+    lNode.mFusion = -1;
+    if (iParams)
+    {
+        mParams.insert(mParams.end(), iParams, iParams+iParamCount);
+    }
+
+    mNodes.push_back(lNode);
+    mSlots += iDestCount;
+    mOutput = lNode.mDest;
+    mChanged = true;
+    mParamsChanged = true;
+    return lNode.mDest;
+}
+
+//
+// Library Nodes
+//
+
+int oclPipeline::RGBtoHSV(int iSrce)
+{
+    return addPoint("RGBtoHSV(a)", iSrce);
+}
+
+int oclPipeline::HSVtoRGB(int iSrce)
+{
+    return addPoint("HSVtoRGB(a)", iSrce);
+}
+
+int oclPipeline::RGBtoXYZ(int iSrce)
+{
+    return addPoint("RGBtoXYZ(a)", iSrce);
+}
+
+int oclPipeline::XYZtoRGB(int iSrce)
+{
+    return addPoint("XYZtoRGB(a)", iSrce);
+}
+
+int oclPipeline::RGBtoLAB(int iSrce)
+{
+    return addPoint("RGBtoLAB(a)", iSrce);
+}
+
+int oclPipeline::LABtoRGB(int iSrce)
+{
+    return addPoint("LABtoRGB(a)", iSrce);
+}
+
+int oclPipeline::quantizeLAB(int iSrce, float iBinL, float iBinA, float iBinB, float iSharpness)
+{
+    cl_float lParams[4] = { iBinL, iBinA, iBinB, iSharpness };
+    return addPoint("quantizeLAB(a, p[0], p[1], p[2], p[3])", iSrce, -1, lParams, 4);
+}
+
+int oclPipeline::bloomFilter(int iSrce, float iThreshold)
+{
+    return addPoint("bloomFilter(a, p[0])", iSrce, -1, &iThreshold, 1);
+}
+
+int oclPipeline::bloomCombine(int iSrce, int iBloom, float iIntensity)
+{
+    return addPoint("bloomCombine(a, b, p[0])", iSrce, iBloom, &iIntensity, 1);
+}
+
+int oclPipeline::sobel(int iSrce)
+{
+    srtStage* lStage = new srtSobelStage(mSobel);
+    mOwned.push_back(lStage);
+    return addStage(*lStage, iSrce);
+}
+
+int oclPipeline::tangent(int iDx, int iDy)
+{
+    srtStage* lStage = new srtTangentStage(mTangent);
+    mOwned.push_back(lStage);
+    return addStage(*lStage, iDx, iDy);
+}
+
+int oclPipeline::lineConv(int iVector, int iSrce, int iDepth)
+{
+    srtStage* lStage = new srtLineConvStage(mTangent, iDepth);
+    mOwned.push_back(lStage);
+    return addStage(*lStage, iVector, iSrce);
+}
+
+int oclPipeline::getKernelCount()
+{
+    int lCount = 0;
+    for (unsigned int i=0; i<mFusions.size(); i++)
+    {
+        lCount += mFusions[i].mKernel ? 1 : 0;
+    }
+    return lCount;
+}
+
+int oclPipeline::getImageCount()
+{
+    return mPool.size();
+}
+
+//
+// Planning
+//
+
+void oclPipeline::plan()
+{
+    // every run of consecutive point nodes becomes one kernel, it is launched at its last node
+    for (unsigned int i=0; i<mNodes.size(); i++)
+    {
+        srtNode& lNode = mNodes[i];
+        lNode.mRelease.clear();
+        lNode.mFusion = -1;
+        if (!lNode.mExpression)
+        {
+            continue;
+        }
+        if (i == 0 || !mNodes[i-1].mExpression)
+        {
+            srtFusion lFusion;
+            lFusion.mFirst = i;
+            lFusion.mKernel = 0;
+            mFusions.push_back(lFusion);
+        }
+        lNode.mFusion = mFusions.size()-1;
+        mFusions.back().mLast = i;
+    }
+
+    // node launching the producer of every slot, the source is produced before the first node
+    vector<int> lProducer(mSlots, -1);
+    vector<int> lLastUse(mSlots, -1);
+    vector<bool> lImage(mSlots, false);
+    for (unsigned int i=0; i<mNodes.size(); i++)
+    {
+        srtNode& lNode = mNodes[i];
+        int lUnit = lNode.mExpression ? mFusions[lNode.mFusion].mLast : i;
+        for (int k=0; k<lNode.mDestCount; k++)
+        {
+            lProducer[lNode.mDest+k] = lUnit;
+            lLastUse[lNode.mDest+k] = lUnit;
+            lImage[lNode.mDest+k] = !lNode.mExpression;
+        }
+        for (int k=0; k<lNode.mSrceCount; k++)
+        {
+            int lSlot = lNode.mSrce[k];
+            lLastUse[lSlot] = lUnit;
+
+            // point results read within their own kernel stay in registers
+            if (lProducer[lSlot] != lUnit)
+            {
+                lImage[lSlot] = true;
+                if (lNode.mExpression)
+                {
+                    vector<int>& lInputs = mFusions[lNode.mFusion].mInputs;
+                    if (std::find(lInputs.begin(), lInputs.end(), lSlot) == lInputs.end())
+                    {
+                        lInputs.push_back(lSlot);
+                    }
+                }
+            }
+        }
+    }
+    lImage[mOutput] = true;
+
+    for (unsigned int i=0; i<mNodes.size(); i++)
+    {
+        srtNode& lNode = mNodes[i];
+        if (lNode.mExpression && lImage[lNode.mDest])
+        {
+            mFusions[lNode.mFusion].mOutputs.push_back(lNode.mDest);
+        }
+    }
+
+    // pooled images go back after their last reader, unread ones right after they are written
+    for (int s=cSource+1; s<mSlots; s++)
+    {
+        if (lImage[s] && s != mOutput)
+        {
+            mNodes[lLastUse[s]].mRelease.push_back(s);
+        }
+    }
+}
+
+void oclPipeline::generate()
+{
+    char lLine[256];
+    mCode.clear();
+
+    for (unsigned int i=0; i<mNodes.size(); i++)
+    {
+        srtNode& lNode = mNodes[i];
+        if (lNode.mExpression)
+        {
+            sprintf(lLine, "float4 clPoint%d(float4 a, float4 b, __constant float* p)\n{\n    return ", i);
+            mCode += lLine;
+            mCode += lNode.mExpression;
+            mCode += ";\n}\n\n";
+        }
+    }
+
+    for (unsigned int f=0; f<mFusions.size(); f++)
+    {
+        srtFusion& lFusion = mFusions[f];
+
+        sprintf(lLine, "__kernel void clFused%d(", f);
+        mCode += lLine;
+        for (unsigned int k=0; k<lFusion.mInputs.size(); k++)
+        {
+            sprintf(lLine, "__read_only image2d_t srce%d, ", k);
+            mCode += lLine;
+        }
+        for (unsigned int k=0; k<lFusion.mOutputs.size(); k++)
+        {
+            sprintf(lLine, "__write_only image2d_t dest%d, ", k);
+            mCode += lLine;
+        }
+        mCode += "__constant float* param)\n{\n";
+        mCode += "    const sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_FILTER_NEAREST | CLK_ADDRESS_CLAMP;\n";
+        mCode += "    int2 idx = (int2)(get_global_id(0), get_global_id(1));\n";
+
+        for (unsigned int k=0; k<lFusion.mInputs.size(); k++)
+        {
+            sprintf(lLine, "    float4 v%d = read_imagef(srce%d, sampler, idx);\n", lFusion.mInputs[k], k);
+            mCode += lLine;
+        }
+        for (int i=lFusion.mFirst; i<=lFusion.mLast; i++)
+        {
+            srtNode& lNode = mNodes[i];
+            if (lNode.mSrceCount > 1)
+            {
+                sprintf(lLine, "    float4 v%d = clPoint%d(v%d, v%d, param + %d);\n", lNode.mDest, i, lNode.mSrce[0], lNode.mSrce[1], lNode.mParam);
+            }
+            else
+            {
+                sprintf(lLine, "    float4 v%d = clPoint%d(v%d, (float4)(0.0f), param + %d);\n", lNode.mDest, i, lNode.mSrce[0], lNode.mParam);
+            }
+            mCode += lLine;
+        }
+        for (unsigned int k=0; k<lFusion.mOutputs.size(); k++)
+        {
+            sprintf(lLine, "    write_imagef(dest%d, idx, v%d);\n", k, lFusion.mOutputs[k]);
+            mCode += lLine;
+        }
+        mCode += "}\n\n";
+    }
+}
+
+//
+// Image Pool
+//
+
+oclImage2D* oclPipeline::acquire()
+{
+    if (!mFree.empty())
+    {
+        oclImage2D* lImage = mFree.back();
+        mFree.pop_back();
+        return lImage;
+    }
+
+    cl_image_format lFormat = { CL_RGBA, CL_FLOAT };
+    oclImage2D* lImage = new oclImage2D(mContext, "bfPool");
+    if (!lImage->create(CL_MEM_READ_WRITE, lFormat, mPoolWidth, mPoolHeight))
+    {
+        Log(ERR, this) << "unable to create a " << mPoolWidth << "x" << mPoolHeight << " pool image";
+        delete lImage;
+        return 0;
+    }
+    mPool.push_back(lImage);
+    return lImage;
+}
+
+void oclPipeline::release(oclImage2D* iImage)
+{
+    if (iImage)
+    {
+        mFree.push_back(iImage);
+    }
+}
+
+//
+//
+//
+
+srtStage::srtStage(char* iName, int iInputs, int iOutputs)
+: mName(iName)
+, mInputs(iInputs)
+, mOutputs(iOutputs)
+{
+}
+
+srtStage::~srtStage()
+{
+}
@@ -0,0 +1,158 @@
+// Copyright [2011] [Geist Software Labs Inc.]
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _oclPipeline
+#define _oclPipeline
+
+#include <string>
+
+#include "oclBuffer.h"
+#include "oclImage2D.h"
+#include "filter/oclSobel.h"
+#include "filter/oclTangent.h"
+
+struct srtStage;
+
+//
+// Image filter graph. Every image is addressed by a slot, slot 0 is the
+// source passed to compute(), each added node returns the slot of its output.
+// Consecutive point-wise nodes are fused into one generated kernel, so their
+// intermediate results stay in registers; all other intermediate images come
+// from a pool which is reused between nodes and compute() calls.
+//
+class oclPipeline : public oclProgram
+{
+    public:
+
+        static const int cSource = 0;
+        static const int cMaxPorts = 2;
+
+        oclPipeline(oclContext& iContext);
+        ~oclPipeline();
+
+        int compile();
+
+        // runs the graph on bfSrce, the output slot is written to bfDest which must have the size of bfSrce
+        int compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest);
+
+        // removes all nodes, pooled images are kept
+        void clear();
+
+        // the output slot defaults to the last added one
+        void setOutput(int iSlot);
+        int getOutput();
+
+        // point-wise node, iExpression returns the float4 result from the input pixels a and b and
+        // the parameters p, e.g. "a*p[0] + b". The expression is not copied.
+        int addPoint(const char* iExpression, int iSrceA, int iSrceB = -1, const cl_float* iParams = 0, int iParamCount = 0);
+
+        // updates the parameters of the point node writing iSlot, takes effect without recompiling
+        int setParams(int iSlot, const cl_float* iParams);
+
+        // generic node, its outputs get consecutive slots starting at the returned one.
+        // The stage is not owned by the pipeline.
+        int addStage(srtStage& iStage, int iSrceA, int iSrceB = -1);
+
+        // point-wise library nodes
+        int RGBtoHSV(int iSrce);
+        int HSVtoRGB(int iSrce);
+        int RGBtoXYZ(int iSrce);
+        int XYZtoRGB(int iSrce);
+        int RGBtoLAB(int iSrce);
+        int LABtoRGB(int iSrce);
+        int quantizeLAB(int iSrce, float iBinL, float iBinA, float iBinB, float iSharpness);
+        int bloomFilter(int iSrce, float iThreshold);
+        int bloomCombine(int iSrce, int iBloom, float iIntensity);
+
+        // library stages, sobel returns the dx slot, dy is the following one
+        int sobel(int iSrce);
+        int tangent(int iDx, int iDy);
+        int lineConv(int iVector, int iSrce, int iDepth);
+
+        // statistics of the last compile / compute
+        int getKernelCount();
+        int getImageCount();
+
+    protected:
+
+        struct srtNode
+        {
+            const char* mExpression;    // 0 for stages
+            srtStage* mStage;
+            int mSrce[cMaxPorts];
+            int mSrceCount;
+            int mDest;                  // first output slot
+            int mDestCount;
+            int mParam;                 // offset into mParams
+            int mParamCount;
+            int mFusion;                // fused kernel of a point node
+            vector<int> mRelease;       // slots whose last reader is this node
+        };
+
+        // run of consecutive point nodes compiled into one kernel
+        struct srtFusion
+        {
+            int mFirst;
+            int mLast;
+            vector<int> mInputs;        // slots read from images
+            vector<int> mOutputs;       // slots written to images
+            oclKernel* mKernel;
+        };
+
+        int addNode(const char* iExpression, srtStage* iStage, int iSrceA, int iSrceB, int iDestCount, const cl_float* iParams, int iParamCount);
+        void plan();
+        void generate();
+
+        oclImage2D* acquire();
+        void release(oclImage2D* iImage);
+
+        vector<srtNode> mNodes;
+        vector<srtFusion> mFusions;
+        vector<cl_float> mParams;
+        vector<srtStage*> mOwned;
+        int mSlots;
+        int mOutput;
+        bool mChanged;
+        bool mParamsChanged;
+
+        // image pool
+        vector<oclImage2D*> mPool;
+        vector<oclImage2D*> mFree;
+        size_t mPoolWidth;
+        size_t mPoolHeight;
+
+        oclBuffer bfParams;
+        std::string mCode;
+
+        oclSobel mSobel;
+        oclTangent mTangent;
+};
+
+//
+// A non point-wise node of the pipeline, reads mInputs images and writes mOutputs
+// images of the source size.
+//
+
+struct srtStage
+{
+    srtStage(char* iName, int iInputs, int iOutputs);
+    virtual ~srtStage();
+
+    virtual int operator() (oclDevice& iDevice, oclImage2D** iSrce, oclImage2D** iDest) = 0;
+
+    char* mName;
+    int mInputs;
+    int mOutputs;
+};
+
+#endif
\ No newline at end of file
@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-__kernel void clCombine(__read_only image2d_t imageIn, __read_only image2d_t resultIn, __read_only image2d_t level0, __read_only image2d_t level1, int level, __write_only image2d_t resultOut)
+__kernel void clCombine(__read_only image2d_t imageIn, __read_only image2d_t resultIn, __read_only image2d_t level0, __read_only image2d_t level1, int level, __write_only image2d_t resultOut, int convert)
 {
     const sampler_t sampler = CLK_NORMALIZED_COORDS_TRUE | CLK_FILTER_LINEAR | CLK_ADDRESS_CLAMP_TO_EDGE;
 
@@ -24,6 +24,12 @@ __kernel void clCombine(__read_only image2d_t imageIn, __read_only image2d_t res
     float2 pixel = (float2)((x+0.5)/w,(y+0.5)/h);
     float4 l0 = read_imagef(level0, sampler, pixel);
     float4 l1 = read_imagef(level1, sampler, pixel);
+    if (convert)
+    {
+        // a shared pyramid holds the RGB source
+        l0 = RGBtoLAB(l0);
+        l1 = RGBtoLAB(l1);
+    }
 
     float lum0 = l0.x/100.0;
     float lum1 = l1.x/100.0;
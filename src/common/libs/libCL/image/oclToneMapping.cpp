@@ -13,7 +13,7 @@
 // limitations under the License.
 #include "oclToneMapping.h"
 
-oclToneMapping::oclToneMapping(oclContext& iContext)
+oclToneMapping::oclToneMapping(oclContext& iContext, oclBilinearPyramid* iPyramid)
 : oclProgram(iContext, "oclToneMapping")
 // buffers
 , bfTempA(iContext, "bfTempA")
@@ -22,13 +22,15 @@ oclToneMapping::oclToneMapping(oclContext& iContext)
 , clCombine(*this)
 // programs
 , mColor(iContext)
-, mPyramid(iContext)
+, mOwnPyramid(iContext)
+, mPyramid(iPyramid ? iPyramid : &mOwnPyramid)
 , mMemory(iContext)
 {
     cl_image_format lFormat = { CL_RGBA,  CL_HALF_FLOAT };
     bfTempA.create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lFormat, 256, 256);
     bfTempB.create(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lFormat, 256, 256);
 
+    addSourceFile("color/oclColor.cl");
     addSourceFile("image/oclToneMapping.cl");
 
     exportKernel(clCombine);
@@ -39,7 +41,7 @@ int oclToneMapping::compile()
     // release kernels
     clCombine = 0;
 
-    if (!mPyramid.compile() || !mColor.compile() ||  !mMemory.compile() || !oclProgram::compile())
+    if ((mPyramid == &mOwnPyramid && !mOwnPyramid.compile()) || !mColor.compile() ||  !mMemory.compile() || !oclProgram::compile())
     {
         return 0;
     }
@@ -64,14 +66,29 @@ int oclToneMapping::compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D&
     }
 
     mColor.RGBtoLAB(iDevice, bfSrce, bfTempA);
-    mPyramid.compute(iDevice, bfTempA);
+
+    // a shared pyramid is built from the RGB source by whichever effect updates it first,
+    // its levels are converted when sampled
+    cl_int lConvert = (mPyramid != &mOwnPyramid);
+    if (lConvert)
+    {
+        if (!mPyramid->update(iDevice, bfSrce))
+        {
+            return false;
+        }
+    }
+    else if (!mOwnPyramid.compute(iDevice, bfTempA))
+    {
+        return false;
+    }
+
     mMemory.memSet(iDevice, bfTempB, mMemory.c0000);
 
     size_t lGlobalSize[2];
     lGlobalSize[0] = lWidth;
     lGlobalSize[1] = lHeight;
-    oclImage2D* bfLevel0 = mPyramid.getLevel(0);
-    oclImage2D* bfLevel1 = mPyramid.getLevel(1);
+    oclImage2D* bfLevel0 = mPyramid->getLevel(0);
+    oclImage2D* bfLevel1 = mPyramid->getLevel(1);
     cl_int lLevel = 1;
     while (bfLevel1 != 0)
     {
@@ -81,12 +98,13 @@ int oclToneMapping::compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D&
         clSetKernelArg(clCombine, 3, sizeof(cl_mem), *bfLevel1);
         clSetKernelArg(clCombine, 4, sizeof(cl_int), &lLevel);
         clSetKernelArg(clCombine, 5, sizeof(cl_mem), bfTempB);
+        clSetKernelArg(clCombine, 6, sizeof(cl_int), &lConvert);
         sStatusCL = clEnqueueNDRangeKernel(iDevice, clCombine, 2, NULL, lGlobalSize, NULL, 0, NULL, clCombine.getEvent());
         ENQUEUE_VALIDATE
 
         lLevel++;
         bfLevel0 = bfLevel1;
-        bfLevel1 = mPyramid.getLevel(lLevel);
+        bfLevel1 = mPyramid->getLevel(lLevel);
     }
 
     mColor.LABtoRGB(iDevice, bfTempB, bfDest);
@@ -22,14 +22,17 @@ class oclToneMapping : public oclProgram
 {
     public: 
 
-        oclToneMapping(oclContext& iContext);
+        // the own pyramid is built from the LAB source; a shared pyramid holds the RGB source, its levels are
+        // converted when sampled. It has to be compiled by its owner, who invalidates it once per frame
+        oclToneMapping(oclContext& iContext, oclBilinearPyramid* iPyramid = 0);
 
         int compile();
         int compute(oclDevice& iDevice, oclImage2D& bfSrce, oclImage2D& bfDest);
 
     protected:
 
-        oclBilinearPyramid mPyramid;
+        oclBilinearPyramid mOwnPyramid;
+        oclBilinearPyramid* mPyramid;
         oclMemory mMemory;
 
         oclImage2D bfTempA;
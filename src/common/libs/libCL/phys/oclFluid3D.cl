@@ -63,6 +63,78 @@ __kernel void clHash(__global uint* cell, __global uint* index, __global const f
     index[particle] = particle;
 }
 
+//
+// temporal coherence, re-hash particles in the order of the last step
+//
+__kernel void clHashSorted(__global uint* cell, __global const uint* index, __global const float4* position, __global const System* param)
+{
+    const uint particle = get_global_id(0);
+
+    int4 grid = gridPosition(position[index[particle]], param->cellSize);
+    cell[particle] = hashKey(grid);
+}
+
+__kernel void clCountDisorder(__global const uint* cell, __global uint* disorder, uint size)
+{
+    const uint particle = get_global_id(0);
+
+    if (particle > 0 && particle < size && cell[particle] < cell[particle-1])
+    {
+        atomic_inc(disorder);
+    }
+}
+
+// sorts windows of SORT_WINDOW cells starting at offset, alternating offsets
+// moves particles across window borders
+#define SORT_WINDOW 256
+
+__kernel void clLocalSort(__global uint* cell, __global uint* index, uint offset, uint size)
+{
+    const uint threadid = get_local_id(0);
+    const uint particle = get_group_id(0)*SORT_WINDOW + offset + threadid;
+
+    __local uint key[SORT_WINDOW];
+    __local uint val[SORT_WINDOW];
+
+    key[threadid] = 0xFFFFFFFF;
+    val[threadid] = 0xFFFFFFFF;
+    if (particle < size)
+    {
+        key[threadid] = cell[particle];
+        val[threadid] = index[particle];
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // bitonic sort, padding sorts to the end of the window
+    for (uint k=2; k<=SORT_WINDOW; k<<=1)
+    {
+        for (uint j=k>>1; j>0; j>>=1)
+        {
+            uint other = threadid^j;
+            if (other > threadid)
+            {
+                uint keyA = key[threadid];
+                uint keyB = key[other];
+                if ((keyA > keyB) == ((threadid & k) == 0))
+                {
+                    uint valA = val[threadid];
+                    key[threadid] = keyB;
+                    key[other] = keyA;
+                    val[threadid] = val[other];
+                    val[other] = valA;
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    }
+
+    if (particle < size)
+    {
+        cell[particle] = key[threadid];
+        index[particle] = val[threadid];
+    }
+}
+
 __kernel void clReorder(__global const uint *index, __global const float4* posIn, __global const float4* velIn, __global float4* posOut,  __global float4* velOut)
 {
     const uint particle= get_global_id(0);
@@ -111,6 +183,16 @@ __kernel void clFindBounds(__global uint* cellStart, __global uint* cellEnd, __g
     }
 }
 
+// bounds from the bins of a counting sort, replaces clInitBounds and clFindBounds
+__kernel void clBinBounds(__global uint* cellStart, __global uint* cellEnd, __global const uint* binOffset, __global const uint* binCount)
+{
+    const uint index = get_global_id(0);
+    uint count = binCount[index];
+    uint start = binOffset[index];
+    cellStart[index] = count ? start : 0xFFFFFFFFU;
+    cellEnd[index] = count ? start + count : 0xFFFFFFFFU;
+}
+
 
 //
 // Compute smoothed particle hydrodynamics 
@@ -12,13 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "oclFluid3D.h"
+#include "oclFluid3DHost.h"
 
 const size_t oclFluid3D::cLocalSize = 256;
 const size_t oclFluid3D::cBucketCount = 16777216;
+const int oclFluid3D::cLocalSortPasses = 4;
 
 char* oclFluid3D::EVT_INTEGRATE = "OnIntegrate";
 
-oclFluid3D::oclFluid3D(oclContext& iContext)
+oclFluid3D::oclFluid3D(oclContext& iContext, int iBackend)
 : oclProgram(iContext, "oclFluid3D")
 // buffers
 , bfCell(iContext, "bfCell")
@@ -28,6 +30,7 @@ oclFluid3D::oclFluid3D(oclContext& iContext)
 , bfSortedPosition(iContext, "bfSortedPosition")
 , bfSortedVelocity(iContext, "bfSortedVelocity")
 , bfParams(iContext, "bfParams")
+, bfDisorder(iContext, "bfDisorder")
 , bfPosition(0)
 , bfVelocity(0)
 , bfForce(0)
@@ -38,15 +41,26 @@ oclFluid3D::oclFluid3D(oclContext& iContext)
 , clReorder(*this)
 , clInitBounds(*this)
 , clFindBounds(*this)
+, clBinBounds(*this)
 , clCalculateDensity(*this)
 , clCalculateForces(*this)
 , clInitFluid(*this)
 , clClipBox(*this)
 , clGravity(*this)
+, clHashSorted(*this)
+, clCountDisorder(*this)
+, clLocalSort(*this)
 // programs
 , mRadixSort(iContext)
 // members
 , mParticleCount(cLocalSize)
+, mIncrementalSort(false)
+, mSortThreshold(0.01f)
+, mSortValid(false)
+, mCountingSort(false)
+, mBinsValid(false)
+, mBackend(iBackend)
+, mHost(0)
 , mIntegrateCb(0)
 {
     bfCell.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mParticleCount);
@@ -56,6 +70,7 @@ oclFluid3D::oclFluid3D(oclContext& iContext)
     bfSortedPosition.create<cl_float4>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mParticleCount);
     bfSortedVelocity.create<cl_float4>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mParticleCount);
     bfParams.create<Params>(CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, 1, &mParams);
+    bfDisorder.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, 1);
 
    /*
     oclBuffer* ll = new oclBuffer(iContext, "dsdsdsdsd");
@@ -79,6 +94,12 @@ oclFluid3D::oclFluid3D(oclContext& iContext)
     bfVelocity->create<cl_float4>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mParticleCount);
     bfForce->create<cl_float4>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mParticleCount);
 
+    if (mBackend == BACKEND_HOST)
+    {
+        mHost = new oclFluid3DHost();
+        mHost->setParticleCount(mParticleCount);
+    }
+
     addSourceFile("phys/oclFluid3D.cl");
 
     exportKernel(clClipBox);
@@ -92,6 +113,7 @@ oclFluid3D::~oclFluid3D()
     deleteBuffer(bfPosition);
     deleteBuffer(bfVelocity);
     deleteBuffer(bfForce);
+    delete mHost;
 }
 
 void oclFluid3D::setParticleCount(size_t iSize)
@@ -99,6 +121,11 @@ void oclFluid3D::setParticleCount(size_t iSize)
     // JSTIER make sure mParticleCount is a mutliple of cLocalSize
 
     mParticleCount = iSize;
+    mSortValid = false;
+    if (mHost)
+    {
+        mHost->setParticleCount(mParticleCount);
+    }
 
     bfCell.resize<cl_uint>(mParticleCount);
     bfCellStart.resize<cl_uint>(cBucketCount);
@@ -142,6 +169,7 @@ int oclFluid3D::setPositionBuffer(oclBuffer* iBuffer)
     }
     deleteBuffer(bfPosition);
     bfPosition = iBuffer;
+    mSortValid = false;
     return bindBuffers();
 }
 
@@ -206,6 +234,27 @@ oclBuffer& oclFluid3D::getParamBuffer()
 }
 
 
+void oclFluid3D::setIncrementalSort(bool iEnable, float iThreshold)
+{
+    mIncrementalSort = iEnable;
+    mSortThreshold = iThreshold;
+}
+
+bool oclFluid3D::getIncrementalSort()
+{
+    return mIncrementalSort;
+}
+
+void oclFluid3D::setCountingSort(bool iEnable)
+{
+    mCountingSort = iEnable;
+}
+
+bool oclFluid3D::getCountingSort()
+{
+    return mCountingSort;
+}
+
 oclFluid3D::Params& oclFluid3D::getParameters()
 {
     return *bfParams.ptr<oclFluid3D::Params>();
@@ -230,6 +279,20 @@ int oclFluid3D::bindBuffers()
     clSetKernelArg(clHash, 2, sizeof(cl_mem), *bfPosition);
     clSetKernelArg(clHash, 3, sizeof(cl_mem), bfParams);
 
+    clSetKernelArg(clHashSorted, 0 ,sizeof(cl_mem), bfCell);
+    clSetKernelArg(clHashSorted, 1, sizeof(cl_mem), bfIndex);
+    clSetKernelArg(clHashSorted, 2, sizeof(cl_mem), *bfPosition);
+    clSetKernelArg(clHashSorted, 3, sizeof(cl_mem), bfParams);
+
+    cl_uint lSize = mParticleCount;
+    clSetKernelArg(clCountDisorder, 0, sizeof(cl_mem), bfCell);
+    clSetKernelArg(clCountDisorder, 1, sizeof(cl_mem), bfDisorder);
+    clSetKernelArg(clCountDisorder, 2, sizeof(cl_uint), &lSize);
+
+    clSetKernelArg(clLocalSort, 0, sizeof(cl_mem), bfCell);
+    clSetKernelArg(clLocalSort, 1, sizeof(cl_mem), bfIndex);
+    clSetKernelArg(clLocalSort, 3, sizeof(cl_uint), &lSize);
+
     clSetKernelArg(clReorder, 0, sizeof(cl_mem), bfIndex);
     clSetKernelArg(clReorder, 1, sizeof(cl_mem), *bfPosition);
     clSetKernelArg(clReorder, 2, sizeof(cl_mem), *bfVelocity);
@@ -283,6 +346,12 @@ int oclFluid3D::compile()
     clHash = 0;
     clReorder = 0;
     clInitBounds = 0;
+    clFindBounds = 0;
+    clBinBounds = 0;
+    clHashSorted = 0;
+    clCountDisorder = 0;
+    clLocalSort = 0;
+    mSortValid = false;
 
     if (!mRadixSort.compile())
     {
@@ -308,6 +377,8 @@ int oclFluid3D::compile()
     KERNEL_VALIDATE(clInitBounds)
     clFindBounds = createKernel("clFindBounds");
     KERNEL_VALIDATE(clFindBounds)
+    clBinBounds = createKernel("clBinBounds");
+    KERNEL_VALIDATE(clBinBounds)
     clCalculateDensity = createKernel("clCalculateDensity");
     KERNEL_VALIDATE(clCalculateDensity)
     clCalculateForces = createKernel("clCalculateForces");
@@ -316,6 +387,12 @@ int oclFluid3D::compile()
     KERNEL_VALIDATE(clGravity)
     clClipBox = createKernel("clClipBox");
     KERNEL_VALIDATE(clClipBox)
+    clHashSorted = createKernel("clHashSorted");
+    KERNEL_VALIDATE(clHashSorted)
+    clCountDisorder = createKernel("clCountDisorder");
+    KERNEL_VALIDATE(clCountDisorder)
+    clLocalSort = createKernel("clLocalSort");
+    KERNEL_VALIDATE(clLocalSort)
 
     // init fluid parameters
     clSetKernelArg(clInitFluid, 0, sizeof(cl_mem), bfParams);
@@ -331,13 +408,121 @@ void oclFluid3D::addEventHandler(srtEvent& iEvent)
     mIntegrateCb = getEventHandler(EVT_INTEGRATE);
 }
 
-int oclFluid3D::compute(oclDevice& iDevice)
+int oclFluid3D::countDisorder(oclDevice& iDevice, cl_uint& oDisorder)
 {
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clHash, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clHash.getEvent());
+    oDisorder = 0;
+    sStatusCL = clEnqueueWriteBuffer(iDevice, bfDisorder, CL_TRUE, 0, sizeof(cl_uint), &oDisorder, 0, NULL, NULL);
+    if (!oclSuccess("clEnqueueWriteBuffer", this))
+    {
+        return false;
+    }
+
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clCountDisorder, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clCountDisorder.getEvent());
     ENQUEUE_VALIDATE
 
+    sStatusCL = clEnqueueReadBuffer(iDevice, bfDisorder, CL_TRUE, 0, sizeof(cl_uint), &oDisorder, 0, NULL, NULL);
+    return oclSuccess("clEnqueueReadBuffer", this);
+}
+
+int oclFluid3D::sort(oclDevice& iDevice)
+{
+    mBinsValid = false;
+    if (mIncrementalSort && mSortValid)
+    {
+        // particles barely move between steps, so the last order is almost correct
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clHashSorted, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clHashSorted.getEvent());
+        ENQUEUE_VALIDATE
+
+        cl_uint lDisorder;
+        if (!countDisorder(iDevice, lDisorder))
+        {
+            return false;
+        }
+
+        for (int i=0; i<cLocalSortPasses && lDisorder && lDisorder <= mSortThreshold*mParticleCount; i++)
+        {
+            for (cl_uint lOffset = 0; lOffset < mParticleCount && lOffset <= cLocalSize/2; lOffset += cLocalSize/2)
+            {
+                size_t lGlobalSize = (mParticleCount - lOffset + cLocalSize - 1)/cLocalSize*cLocalSize;
+                clSetKernelArg(clLocalSort, 2, sizeof(cl_uint), &lOffset);
+                sStatusCL = clEnqueueNDRangeKernel(iDevice, clLocalSort, 1, NULL, &lGlobalSize, &cLocalSize, 0, NULL, clLocalSort.getEvent());
+                ENQUEUE_VALIDATE
+            }
+
+            if (!countDisorder(iDevice, lDisorder))
+            {
+                return false;
+            }
+        }
+
+        if (!lDisorder)
+        {
+            return true;
+        }
+
+        // too much disorder, sort the current permutation from scratch
+    }
+    else
+    {
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clHash, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clHash.getEvent());
+        ENQUEUE_VALIDATE
+    }
+
+    if (mCountingSort)
+    {
+        if (!mRadixSort.computeBins(iDevice, bfCell, bfIndex, cBucketCount))
+        {
+            return false;
+        }
+        mBinsValid = true;
+    }
+    else if (!mRadixSort.compute(iDevice, bfCell, bfIndex, 0, 24))
+    {
+        return false;
+    }
+    mSortValid = true;
+    return true;
+}
+
+int oclFluid3D::computeHost(oclDevice& iDevice)
+{
+    if (!bfPosition->map(CL_MAP_READ | CL_MAP_WRITE) || !bfVelocity->map(CL_MAP_READ | CL_MAP_WRITE) || !bfForce->map(CL_MAP_READ | CL_MAP_WRITE))
+    {
+        return false;
+    }
+
+    mHost->compute(bfPosition->ptr<cl_float4>(), bfVelocity->ptr<cl_float4>(), bfForce->ptr<cl_float4>(), getParameters(), mIntegrateCb == 0);
+
+    bfPosition->unmap();
+    bfVelocity->unmap();
+    bfForce->unmap();
+
+    if (mIntegrateCb)
+    {
+        // the handler works on the sorted device buffers
+        if (!bfSortedPosition.map(CL_MAP_WRITE) || !bfSortedVelocity.map(CL_MAP_WRITE) || !bfIndex.map(CL_MAP_WRITE))
+        {
+            return false;
+        }
+        mHost->getSorted(bfSortedPosition.ptr<cl_float4>(), bfSortedVelocity.ptr<cl_float4>(), bfIndex.ptr<cl_uint>());
+        bfSortedPosition.unmap();
+        bfSortedVelocity.unmap();
+        bfIndex.unmap();
+
+        (*mIntegrateCb)(*this);
+    }
+    return true;
+}
+
+int oclFluid3D::compute(oclDevice& iDevice)
+{
+    if (mHost)
+    {
+        return computeHost(iDevice);
+    }
+
      // sort
-    if (!mRadixSort.compute(iDevice, bfCell, bfIndex, 0, 24))
+    if (!sort(iDevice))
     {
         return false;
     }
@@ -345,10 +530,22 @@ int oclFluid3D::compute(oclDevice& iDevice)
     sStatusCL = clEnqueueNDRangeKernel(iDevice, clReorder, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clReorder.getEvent());
     ENQUEUE_VALIDATE
 
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clInitBounds, 1, NULL, &cBucketCount, &cLocalSize, 0, NULL, clInitBounds.getEvent());
-    ENQUEUE_VALIDATE
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clFindBounds, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clFindBounds.getEvent());
-    ENQUEUE_VALIDATE
+    if (mBinsValid)
+    {
+        clSetKernelArg(clBinBounds, 0, sizeof(cl_mem), bfCellStart);
+        clSetKernelArg(clBinBounds, 1, sizeof(cl_mem), bfCellEnd);
+        clSetKernelArg(clBinBounds, 2, sizeof(cl_mem), mRadixSort.getBinOffsetBuffer());
+        clSetKernelArg(clBinBounds, 3, sizeof(cl_mem), mRadixSort.getBinCountBuffer());
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clBinBounds, 1, NULL, &cBucketCount, &cLocalSize, 0, NULL, clBinBounds.getEvent());
+        ENQUEUE_VALIDATE
+    }
+    else
+    {
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clInitBounds, 1, NULL, &cBucketCount, &cLocalSize, 0, NULL, clInitBounds.getEvent());
+        ENQUEUE_VALIDATE
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clFindBounds, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clFindBounds.getEvent());
+        ENQUEUE_VALIDATE
+    }
 
     sStatusCL = clEnqueueNDRangeKernel(iDevice, clCalculateDensity, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clCalculateDensity.getEvent());
     ENQUEUE_VALIDATE
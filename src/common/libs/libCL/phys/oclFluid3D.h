@@ -18,11 +18,17 @@
 
 #include "sort/oclRadixSort.h"
 
+class oclFluid3DHost;
+
 class oclFluid3D : public oclProgram
 {
     public: 
 
-        oclFluid3D(oclContext& iContext);
+        // backends
+        static const int BACKEND_OPENCL = 0;
+        static const int BACKEND_HOST = 1;
+
+        oclFluid3D(oclContext& iContext, int iBackend = BACKEND_OPENCL);
        ~oclFluid3D();
 
         int compile();
@@ -45,6 +51,16 @@ class oclFluid3D : public oclProgram
 
         oclBuffer& getParamBuffer();
 
+        // reuse the particle order of the last step and only fix it locally,
+        // falls back to a full radix sort if more than iThreshold of the
+        // particles are out of order
+        void setIncrementalSort(bool iEnable, float iThreshold = 0.01f);
+        bool getIncrementalSort();
+
+        // bin particles with a counting sort over the cells instead of a radix sort
+        void setCountingSort(bool iEnable);
+        bool getCountingSort();
+
         typedef struct 
         {
             float deltaTime;
@@ -72,6 +88,7 @@ class oclFluid3D : public oclProgram
         // sizes
         static const size_t cLocalSize;
         static const size_t cBucketCount;
+        static const int cLocalSortPasses;
 
     protected:
 
@@ -83,11 +100,15 @@ class oclFluid3D : public oclProgram
         oclKernel clReorder;
         oclKernel clInitBounds;
         oclKernel clFindBounds;
+        oclKernel clBinBounds;
         oclKernel clCalculateDensity;
         oclKernel clCalculateForces;
         oclKernel clInitFluid;
         oclKernel clGravity;
         oclKernel clClipBox;
+        oclKernel clHashSorted;
+        oclKernel clCountDisorder;
+        oclKernel clLocalSort;
 
         oclBuffer bfCell;
         oclBuffer bfCellStart;
@@ -96,12 +117,16 @@ class oclFluid3D : public oclProgram
         oclBuffer bfSortedPosition;
         oclBuffer bfSortedVelocity;
         oclBuffer bfParams;
+        oclBuffer bfDisorder;
 
         oclBuffer* bfPosition;
         oclBuffer* bfVelocity;
         oclBuffer* bfForce;
     
         int bindBuffers();
+        int sort(oclDevice& iDevice);
+        int countDisorder(oclDevice& iDevice, cl_uint& oDisorder);
+        int computeHost(oclDevice& iDevice);
 
         void deleteBuffer(oclBuffer* iBuffer)
         {
@@ -115,6 +140,15 @@ class oclFluid3D : public oclProgram
 
         size_t mParticleCount;
 
+        bool mIncrementalSort;
+        float mSortThreshold;
+        bool mSortValid;
+        bool mCountingSort;
+        bool mBinsValid;
+
+        int mBackend;
+        oclFluid3DHost* mHost;
+
     private:
 
 
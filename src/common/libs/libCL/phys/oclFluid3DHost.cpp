@@ -0,0 +1,494 @@
+// Copyright [2011] [Geist Software Labs Inc.]
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "oclFluid3DHost.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define BUCKETS 16777216
+#define EMPTY 0xFFFFFFFFU
+
+#define EPSILON  0.00001f
+#define BOUNDARY_STIFFNESS  2000
+#define BOUNDARY_DAMPENING  256
+
+static inline int gridPosition(float iPosition, float iCellSize)
+{
+    return (int)floorf(iPosition/iCellSize);
+}
+
+static inline cl_uint hashKey(int iX, int iY, int iZ)
+{
+    const cl_uint p1 = 73856093;
+    const cl_uint p2 = 19349663;
+    const cl_uint p3 = 83492791;
+    cl_uint n = p1*(cl_uint)iX ^ p2*(cl_uint)iY ^ p3*(cl_uint)iZ;
+    return n % BUCKETS;
+}
+
+oclFluid3DHost::oclFluid3DHost()
+: mParticleCount(0)
+, mParallelSort(true)
+, mCellStart(BUCKETS, EMPTY)
+, mCellEnd(BUCKETS, EMPTY)
+{
+}
+
+void oclFluid3DHost::setParticleCount(size_t iSize)
+{
+    // forget the cells of the last step
+    for (size_t i=0; i<mCell.size(); i++)
+    {
+        mCellStart[mCell[i]] = EMPTY;
+        mCellEnd[mCell[i]] = EMPTY;
+    }
+
+    mParticleCount = iSize;
+
+    mCell.assign(iSize, 0);
+    mIndex.resize(iSize);
+    mTempCell.resize(iSize);
+    mTempIndex.resize(iSize);
+
+    mPosX.resize(iSize);
+    mPosY.resize(iSize);
+    mPosZ.resize(iSize);
+    mPosW.resize(iSize);
+    mVelX.resize(iSize);
+    mVelY.resize(iSize);
+    mVelZ.resize(iSize);
+    mVelW.resize(iSize);
+}
+
+size_t oclFluid3DHost::getParticleCount()
+{
+    return mParticleCount;
+}
+
+void oclFluid3DHost::initParameters(oclFluid3D::Params& oParams)
+{
+    oParams.deltaTime = 0.005f;
+
+    oParams.mass = 0.006f;
+    oParams.density = 1000;
+    oParams.viscosity = 6.0f;
+    oParams.pressure = 0;
+    oParams.velocitylimit = 500;
+    oParams.stiffness =  1;
+
+    oParams.spacing = 0.87f*powf(oParams.mass/oParams.density, 1/3.0f);
+    oParams.particleRadius = 0.5f*oParams.spacing;
+    oParams.cellSize = 2.0f*oParams.spacing;
+
+    float h = oParams.cellSize;
+    oParams.kernelConstant = (float)(315.0/(64.0*M_PI*pow(h, 9.0)));
+    oParams.viscosityConstant = (float)(-oParams.viscosity*(-45.0/(M_PI*pow(h, 6.0))));
+    oParams.pressureConstant = (float)(45.0/(M_PI*pow(h, 6.0)));
+}
+
+void oclFluid3DHost::getSorted(cl_float4* oPosition, cl_float4* oVelocity, cl_uint* oIndex)
+{
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        oPosition[i].s[0] = mPosX[i];
+        oPosition[i].s[1] = mPosY[i];
+        oPosition[i].s[2] = mPosZ[i];
+        oPosition[i].s[3] = mPosW[i];
+        oVelocity[i].s[0] = mVelX[i];
+        oVelocity[i].s[1] = mVelY[i];
+        oVelocity[i].s[2] = mVelZ[i];
+        oVelocity[i].s[3] = mVelW[i];
+        oIndex[i] = mIndex[i];
+    }
+}
+
+void oclFluid3DHost::setParallelSort(bool iEnable)
+{
+    mParallelSort = iEnable;
+}
+
+bool oclFluid3DHost::getParallelSort()
+{
+    return mParallelSort;
+}
+
+//
+//
+//
+
+void oclFluid3DHost::compute(cl_float4* ioPosition, cl_float4* ioVelocity, cl_float4* ioForce, const oclFluid3D::Params& iParams, bool iIntegrate)
+{
+    hash(ioPosition, iParams);
+    sort();
+    reorder(ioPosition, ioVelocity);
+    findBounds();
+    calculateDensity(iParams);
+    calculateForces(ioForce, iParams);
+
+    if (iIntegrate)
+    {
+        clipBox(ioForce, iParams);
+        integrate(ioPosition, ioVelocity, ioForce, iParams);
+    }
+}
+
+void oclFluid3DHost::hash(const cl_float4* iPosition, const oclFluid3D::Params& iParams)
+{
+    int lCount = (int)mParticleCount;
+
+    // reset the cells binned in the last step instead of all buckets
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        mCellStart[mCell[i]] = EMPTY;
+        mCellEnd[mCell[i]] = EMPTY;
+    }
+
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        const cl_float4& lPos = iPosition[i];
+        mCell[i] = hashKey(gridPosition(lPos.s[0], iParams.cellSize),
+                           gridPosition(lPos.s[1], iParams.cellSize),
+                           gridPosition(lPos.s[2], iParams.cellSize));
+        mIndex[i] = i;
+    }
+}
+
+void oclFluid3DHost::sort()
+{
+    // stable LSD radix sort over the 24 bit cells, same order as oclRadixSort. Every thread
+    // counts and scatters a contiguous chunk, the offsets are prefixed over (bucket, thread)
+    // so the chunks keep their order inside each bucket
+    int lThreads = 1;
+#ifdef _OPENMP
+    if (mParallelSort)
+    {
+        lThreads = omp_get_max_threads();
+    }
+#endif
+    lThreads = std::max(1, std::min(lThreads, (int)(mParticleCount/4096)));
+    mHistogram.resize(lThreads*256);
+
+    cl_uint* lCell = &mCell[0];
+    cl_uint* lIndex = &mIndex[0];
+    cl_uint* lTempCell = &mTempCell[0];
+    cl_uint* lTempIndex = &mTempIndex[0];
+    size_t* lHistogram = &mHistogram[0];
+    size_t lCount = mParticleCount;
+
+    for (int lShift = 0; lShift < 24; lShift += 8)
+    {
+        #pragma omp parallel for num_threads(lThreads)
+        for (int t=0; t<lThreads; t++)
+        {
+            size_t* lOffset = lHistogram + t*256;
+            memset(lOffset, 0, 256*sizeof(size_t));
+            for (size_t i=lCount*t/lThreads; i<lCount*(t+1)/lThreads; i++)
+            {
+                lOffset[(lCell[i] >> lShift) & 0xFF]++;
+            }
+        }
+
+        size_t lSum = 0;
+        for (int i=0; i<256; i++)
+        {
+            for (int t=0; t<lThreads; t++)
+            {
+                size_t lBucket = lHistogram[t*256 + i];
+                lHistogram[t*256 + i] = lSum;
+                lSum += lBucket;
+            }
+        }
+
+        #pragma omp parallel for num_threads(lThreads)
+        for (int t=0; t<lThreads; t++)
+        {
+            size_t* lOffset = lHistogram + t*256;
+            for (size_t i=lCount*t/lThreads; i<lCount*(t+1)/lThreads; i++)
+            {
+                size_t lTarget = lOffset[(lCell[i] >> lShift) & 0xFF]++;
+                lTempCell[lTarget] = lCell[i];
+                lTempIndex[lTarget] = lIndex[i];
+            }
+        }
+
+        std::swap(lCell, lTempCell);
+        std::swap(lIndex, lTempIndex);
+    }
+
+    // three passes, the result is in the temp arrays
+    mCell.swap(mTempCell);
+    mIndex.swap(mTempIndex);
+}
+
+void oclFluid3DHost::reorder(const cl_float4* iPosition, const cl_float4* iVelocity)
+{
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        const cl_float4& lPos = iPosition[mIndex[i]];
+        const cl_float4& lVel = iVelocity[mIndex[i]];
+        mPosX[i] = lPos.s[0];
+        mPosY[i] = lPos.s[1];
+        mPosZ[i] = lPos.s[2];
+        mPosW[i] = lPos.s[3];
+        mVelX[i] = lVel.s[0];
+        mVelY[i] = lVel.s[1];
+        mVelZ[i] = lVel.s[2];
+        mVelW[i] = lVel.s[3];
+    }
+}
+
+void oclFluid3DHost::findBounds()
+{
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        cl_uint lCell = mCell[i];
+        if (i == 0 || lCell != mCell[i-1])
+        {
+            mCellStart[lCell] = i;
+        }
+        if (i == lCount-1 || lCell != mCell[i+1])
+        {
+            mCellEnd[lCell] = i+1;
+        }
+    }
+}
+
+//
+// smoothed particle hydrodynamics
+//
+
+void oclFluid3DHost::calculateDensity(const oclFluid3D::Params& iParams)
+{
+    const float h = iParams.cellSize;
+    const float* lPosX = &mPosX[0];
+    const float* lPosY = &mPosY[0];
+    const float* lPosZ = &mPosZ[0];
+
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        float lX = lPosX[i];
+        float lY = lPosY[i];
+        float lZ = lPosZ[i];
+        int lGridX = gridPosition(lX, h);
+        int lGridY = gridPosition(lY, h);
+        int lGridZ = gridPosition(lZ, h);
+
+        float lDensity = 0;
+        int lNeighbors = 0;
+        for (int z = -1; z <= 1; z++)
+        {
+            for (int y = -1; y <= 1; y++)
+            {
+                for (int x = -1; x <= 1; x++)
+                {
+                    cl_uint lCell = hashKey(lGridX + x, lGridY + y, lGridZ + z);
+                    cl_uint lStart = mCellStart[lCell];
+                    if (lStart == EMPTY)
+                    {
+                        continue;
+                    }
+
+                    // branch free, so the loop over the cell vectorizes
+                    int lEnd = (int)mCellEnd[lCell];
+                    for (int j = (int)lStart; j < lEnd; j++)
+                    {
+                        float lDX = lX - lPosX[j];
+                        float lDY = lY - lPosY[j];
+                        float lDZ = lZ - lPosZ[j];
+                        float lLength = sqrtf(lDX*lDX + lDY*lDY + lDZ*lDZ);
+                        float lDiff = h*h - lLength*lLength;
+                        int lInside = (j != i) & (lLength < h);
+                        lDensity += lInside ? lDiff*lDiff*lDiff : 0.0f;
+                        lNeighbors += lInside;
+                    }
+                }
+            }
+        }
+
+        if (lNeighbors > 2)
+        {
+            lDensity = std::max(1.0f, iParams.mass*iParams.kernelConstant*lDensity);
+            mPosW[i] = lDensity;
+            mVelW[i] = iParams.pressure + iParams.stiffness*(lDensity - iParams.density);
+        }
+        else
+        {
+            mPosW[i] = iParams.density;
+            mVelW[i] = iParams.pressure;
+        }
+    }
+}
+
+void oclFluid3DHost::calculateForces(cl_float4* ioForce, const oclFluid3D::Params& iParams)
+{
+    const float h = iParams.cellSize;
+    const float* lPosX = &mPosX[0];
+    const float* lPosY = &mPosY[0];
+    const float* lPosZ = &mPosZ[0];
+    const float* lPosW = &mPosW[0];
+    const float* lVelX = &mVelX[0];
+    const float* lVelY = &mVelY[0];
+    const float* lVelZ = &mVelZ[0];
+    const float* lVelW = &mVelW[0];
+
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        float lX = lPosX[i];
+        float lY = lPosY[i];
+        float lZ = lPosZ[i];
+        float lDensity = lPosW[i];
+        float lVX = lVelX[i];
+        float lVY = lVelY[i];
+        float lVZ = lVelZ[i];
+        float lPressure = lVelW[i];
+        int lGridX = gridPosition(lX, h);
+        int lGridY = gridPosition(lY, h);
+        int lGridZ = gridPosition(lZ, h);
+
+        float lPressureX = 0, lPressureY = 0, lPressureZ = 0;
+        float lViscosityX = 0, lViscosityY = 0, lViscosityZ = 0;
+        for (int z = -1; z <= 1; z++)
+        {
+            for (int y = -1; y <= 1; y++)
+            {
+                for (int x = -1; x <= 1; x++)
+                {
+                    cl_uint lCell = hashKey(lGridX + x, lGridY + y, lGridZ + z);
+                    cl_uint lStart = mCellStart[lCell];
+                    if (lStart == EMPTY)
+                    {
+                        continue;
+                    }
+
+                    int lEnd = (int)mCellEnd[lCell];
+                    for (int j = (int)lStart; j < lEnd; j++)
+                    {
+                        float lDX = lX - lPosX[j];
+                        float lDY = lY - lPosY[j];
+                        float lDZ = lZ - lPosZ[j];
+                        float lLength = sqrtf(lDX*lDX + lDY*lDY + lDZ*lDZ);
+                        if (j == i || !(lLength < h))
+                        {
+                            continue;
+                        }
+
+                        float lDensity2 = lDensity*lPosW[j];
+                        float lPressure2 = lPressure + lVelW[j];
+                        float lDistance = h - lLength;
+
+                        float lScale = lPressure2/lDensity2*lDistance*lDistance/lLength;
+                        lPressureX += lScale*lDX;
+                        lPressureY += lScale*lDY;
+                        lPressureZ += lScale*lDZ;
+
+                        lScale = lDistance/lDensity2;
+                        lViscosityX += (lVelX[j] - lVX)*lScale;
+                        lViscosityY += (lVelY[j] - lVY)*lScale;
+                        lViscosityZ += (lVelZ[j] - lVZ)*lScale;
+                    }
+                }
+            }
+        }
+
+        cl_float4& lForce = ioForce[mIndex[i]];
+        lForce.s[0] += (iParams.pressureConstant*lPressureX + iParams.viscosityConstant*lViscosityX)*iParams.mass;
+        lForce.s[1] += (iParams.pressureConstant*lPressureY + iParams.viscosityConstant*lViscosityY)*iParams.mass;
+        lForce.s[2] += (iParams.pressureConstant*lPressureZ + iParams.viscosityConstant*lViscosityZ)*iParams.mass;
+        lForce.s[3] = 0;
+    }
+}
+
+//
+// collide with the bounding box and integrate
+//
+
+void oclFluid3DHost::clipBox(cl_float4* ioForce, const oclFluid3D::Params& iParams)
+{
+    const float lMin[3] = { -1, -1, -1 };
+    const float lMax[3] = {  1,  1,  1 };
+
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        float lPos[3] = { mPosX[i], mPosY[i], mPosZ[i] };
+        float lVel[3] = { mVelX[i], mVelY[i], mVelZ[i] };
+        cl_float4& lForce = ioForce[mIndex[i]];
+
+        for (int lAxis = 0; lAxis < 3; lAxis++)
+        {
+            float lDiff = iParams.particleRadius - (lPos[lAxis] - lMin[lAxis]);
+            if (lDiff > EPSILON)
+            {
+                lForce.s[lAxis] += BOUNDARY_STIFFNESS*lDiff - BOUNDARY_DAMPENING*lVel[lAxis];
+            }
+
+            lDiff = iParams.particleRadius - (lMax[lAxis] - lPos[lAxis]);
+            if (lDiff > EPSILON)
+            {
+                lForce.s[lAxis] -= BOUNDARY_STIFFNESS*lDiff + BOUNDARY_DAMPENING*lVel[lAxis];
+            }
+        }
+    }
+}
+
+void oclFluid3DHost::integrate(cl_float4* ioPosition, cl_float4* ioVelocity, cl_float4* ioForce, const oclFluid3D::Params& iParams)
+{
+    int lCount = (int)mParticleCount;
+    #pragma omp parallel for
+    for (int i=0; i<lCount; i++)
+    {
+        cl_float4& lPos = ioPosition[i];
+        cl_float4& lVel = ioVelocity[i];
+        cl_float4& lForce = ioForce[i];
+
+        // clIntegrateForce
+        float lSpeed = sqrtf(lForce.s[0]*lForce.s[0] + lForce.s[1]*lForce.s[1] + lForce.s[2]*lForce.s[2] + lForce.s[3]*lForce.s[3]);
+        float lScale = lSpeed > iParams.velocitylimit ? iParams.velocitylimit/lSpeed : 1.0f;
+        for (int k=0; k<4; k++)
+        {
+            lVel.s[k] += lForce.s[k]*lScale*iParams.deltaTime;
+        }
+
+        // clGravity
+        lForce.s[0] = 0;
+        lForce.s[1] = 0;
+        lForce.s[2] = -9.8f;
+        lForce.s[3] = 0;
+
+        // clIntegrateVelocity
+        for (int k=0; k<4; k++)
+        {
+            lPos.s[k] += lVel.s[k]*iParams.deltaTime;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+// Copyright [2011] [Geist Software Labs Inc.]
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef _oclFluid3DHost
+#define _oclFluid3DHost
+
+#include <vector>
+
+#include "oclFluid3D.h"
+
+//
+// multi-threaded host implementation of the oclFluid3D kernels, the sorted
+// particle state is stored as structure of arrays for vectorized neighbor loops
+//
+class oclFluid3DHost
+{
+    public:
+
+        oclFluid3DHost();
+
+        void setParticleCount(size_t iSize);
+        size_t getParticleCount();
+
+        // same values as clInitFluid
+        static void initParameters(oclFluid3D::Params& oParams);
+
+        // one simulation step on the particle ordered buffers, integrate is
+        // skipped if the caller resolves the constraints itself
+        void compute(cl_float4* ioPosition, cl_float4* ioVelocity, cl_float4* ioForce, const oclFluid3D::Params& iParams, bool iIntegrate);
+
+        // sorted state of the last step, as written by clReorder and clCalculateDensity
+        void getSorted(cl_float4* oPosition, cl_float4* oVelocity, cl_uint* oIndex);
+
+        // radix sort the cells with all threads instead of one, both give the same order
+        void setParallelSort(bool iEnable);
+        bool getParallelSort();
+
+    protected:
+
+        void hash(const cl_float4* iPosition, const oclFluid3D::Params& iParams);
+        void sort();
+        void reorder(const cl_float4* iPosition, const cl_float4* iVelocity);
+        void findBounds();
+        void calculateDensity(const oclFluid3D::Params& iParams);
+        void calculateForces(cl_float4* ioForce, const oclFluid3D::Params& iParams);
+        void clipBox(cl_float4* ioForce, const oclFluid3D::Params& iParams);
+        void integrate(cl_float4* ioPosition, cl_float4* ioVelocity, cl_float4* ioForce, const oclFluid3D::Params& iParams);
+
+        size_t mParticleCount;
+        bool mParallelSort;
+
+        std::vector<cl_uint> mCell;
+        std::vector<cl_uint> mIndex;
+        std::vector<cl_uint> mTempCell;
+        std::vector<cl_uint> mTempIndex;
+
+        // 256 bucket offsets per sort thread
+        std::vector<size_t> mHistogram;
+
+        // cells are only reset where particles were binned in the last step
+        std::vector<cl_uint> mCellStart;
+        std::vector<cl_uint> mCellEnd;
+
+        // sorted state, w holds density and pressure like in the kernels
+        std::vector<float> mPosX;
+        std::vector<float> mPosY;
+        std::vector<float> mPosZ;
+        std::vector<float> mPosW;
+        std::vector<float> mVelX;
+        std::vector<float> mVelY;
+        std::vector<float> mVelZ;
+        std::vector<float> mVelW;
+};
+
+#endif
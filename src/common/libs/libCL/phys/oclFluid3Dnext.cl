@@ -39,6 +39,10 @@ __kernel void clHash(__global uint* cell, __global uint* index, __global float4*
     int2 grid;
     grid.x = (int)floor(state[particle].x/param->cellSize);
     grid.y = (int)floor(state[particle].y/param->cellSize);
+
+    // particles outside the domain are binned into the border cells, the bin buffers only hold cellCountX*cellCountY cells
+    grid.x = clamp(grid.x, 0, param->cellCountX-1);
+    grid.y = clamp(grid.y, 0, param->cellCountY-1);
     cell[particle] = grid.y*param->cellCountX + grid.x;
     index[particle] = particle;
 }
@@ -87,6 +91,16 @@ __kernel void clFindBounds(__global uint* cellStart, __global uint* cellEnd, __g
     }
 }
 
+// bounds from the bins of a counting sort, replaces clInitBounds and clFindBounds
+__kernel void clBinBounds(__global uint* cellStart, __global uint* cellEnd, __global const uint* binOffset, __global const uint* binCount)
+{
+    const uint index = get_global_id(0);
+    uint count = binCount[index];
+    uint start = binOffset[index];
+    cellStart[index] = count ? start : 0xFFFFFFFFU;
+    cellEnd[index] = count ? start + count : 0xFFFFFFFFU;
+}
+
 
 //
 // Compute smoothed particle hydrodynamics 
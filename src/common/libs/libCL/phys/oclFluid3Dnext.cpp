@@ -37,6 +37,7 @@ oclFluid3Dnext::oclFluid3Dnext(oclContext& iContext)
 , clReorder(*this)
 , clInitBounds(*this)
 , clFindBounds(*this)
+, clBinBounds(*this)
 
 , clInitFluid(*this)
 
@@ -53,6 +54,7 @@ oclFluid3Dnext::oclFluid3Dnext(oclContext& iContext)
 , mIntegrateCb(0)
 
 , mCellCount(256)
+, mCountingSort(false)
 {
     bfCell.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mParticleCount);
     bfCellStart.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, mCellCount);
@@ -164,6 +166,16 @@ oclBuffer& oclFluid3Dnext::getParamBuffer()
 }
 
 
+void oclFluid3Dnext::setCountingSort(bool iEnable)
+{
+    mCountingSort = iEnable;
+}
+
+bool oclFluid3Dnext::getCountingSort()
+{
+    return mCountingSort;
+}
+
 oclFluid3Dnext::Params& oclFluid3Dnext::getParameters()
 {
     return *bfParams.ptr<oclFluid3Dnext::Params>();
@@ -251,6 +263,7 @@ int oclFluid3Dnext::compile()
     clReorder = 0;
     clInitBounds = 0;
     clFindBounds = 0;
+    clBinBounds = 0;
 
     clInitFluid = 0;
 
@@ -277,6 +290,8 @@ int oclFluid3Dnext::compile()
     KERNEL_VALIDATE(clInitBounds)
     clFindBounds = createKernel("clFindBounds");
     KERNEL_VALIDATE(clFindBounds)
+    clBinBounds = createKernel("clBinBounds");
+    KERNEL_VALIDATE(clBinBounds)
 
     clInitFluid = createKernel("clInitFluid");
     KERNEL_VALIDATE(clInitFluid)
@@ -317,7 +332,14 @@ int oclFluid3Dnext::compute(oclDevice& iDevice)
     ENQUEUE_VALIDATE
 
     // sort
-    if (!mRadixSort.compute(iDevice, bfCell, bfIndex, 0, 24))
+    if (mCountingSort)
+    {
+        if (!mRadixSort.computeBins(iDevice, bfCell, bfIndex, mCellCount))
+        {
+            return false;
+        }
+    }
+    else if (!mRadixSort.compute(iDevice, bfCell, bfIndex, 0, 24))
     {
         return false;
     }
@@ -325,10 +347,22 @@ int oclFluid3Dnext::compute(oclDevice& iDevice)
     sStatusCL = clEnqueueNDRangeKernel(iDevice, clReorder, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clReorder.getEvent());
     ENQUEUE_VALIDATE
 
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clInitBounds, 1, NULL, &mCellCount, &cLocalSize, 0, NULL, clInitBounds.getEvent());
-    ENQUEUE_VALIDATE
-    sStatusCL = clEnqueueNDRangeKernel(iDevice, clFindBounds, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clFindBounds.getEvent());
-    ENQUEUE_VALIDATE
+    if (mCountingSort)
+    {
+        clSetKernelArg(clBinBounds, 0, sizeof(cl_mem), bfCellStart);
+        clSetKernelArg(clBinBounds, 1, sizeof(cl_mem), bfCellEnd);
+        clSetKernelArg(clBinBounds, 2, sizeof(cl_mem), mRadixSort.getBinOffsetBuffer());
+        clSetKernelArg(clBinBounds, 3, sizeof(cl_mem), mRadixSort.getBinCountBuffer());
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clBinBounds, 1, NULL, &mCellCount, &cLocalSize, 0, NULL, clBinBounds.getEvent());
+        ENQUEUE_VALIDATE
+    }
+    else
+    {
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clInitBounds, 1, NULL, &mCellCount, &cLocalSize, 0, NULL, clInitBounds.getEvent());
+        ENQUEUE_VALIDATE
+        sStatusCL = clEnqueueNDRangeKernel(iDevice, clFindBounds, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clFindBounds.getEvent());
+        ENQUEUE_VALIDATE
+    }
     sStatusCL = clEnqueueNDRangeKernel(iDevice, clComputePressure, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clComputePressure.getEvent());
     ENQUEUE_VALIDATE
     sStatusCL = clEnqueueNDRangeKernel(iDevice, clComputeForces, 1, NULL, &mParticleCount, &cLocalSize, 0, NULL, clComputeForces.getEvent());
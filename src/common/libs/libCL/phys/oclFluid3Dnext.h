@@ -47,6 +47,10 @@ class oclFluid3Dnext : public oclProgram
 
         oclBuffer& getParamBuffer();
 
+        // bin particles with a counting sort over the cells instead of a radix sort
+        void setCountingSort(bool iEnable);
+        bool getCountingSort();
+
         typedef struct 
         {
             float deltaTime;
@@ -83,6 +87,7 @@ class oclFluid3Dnext : public oclProgram
         oclKernel clReorder;
         oclKernel clInitBounds;
         oclKernel clFindBounds;
+        oclKernel clBinBounds;
 
         oclKernel clInitFluid;
 
@@ -120,6 +125,7 @@ class oclFluid3Dnext : public oclProgram
 
         size_t mParticleCount;
         size_t mCellCount;
+        bool mCountingSort;
 
 
     private:
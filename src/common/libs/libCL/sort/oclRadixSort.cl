@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// the digit width is usually prepended by the host
+#ifndef BITS
 #define BITS 4
+#endif
 #define RADIX (1<<BITS)
 #define WARPSIZE 32
 #define BLOCKSIZE 256
@@ -77,7 +80,7 @@ __kernel void clBlockSort(__global uint* keyIn,
     {
         offset[threadid] = 0;
     }
-    key[threadid] = (key[threadid] >> startbit) & 0xF;
+    key[threadid] = (key[threadid] >> startbit) & (RADIX-1);
     barrier(CLK_LOCAL_MEM_FENCE);
 
     if(threadid > 0 && key[threadid] != key[threadid - 1]) 
@@ -111,16 +114,26 @@ __kernel void clBlockSort(__global uint* keyIn,
 
 }
 
-__kernel void clBlockScan(__global uint4* blockScan, __global uint* scanSum, uint size)
+// Scans the elements in [offset, offset+size) of data in place (exclusive) and writes
+// the total of every work group to sums[sumOffset+blockid]. Scanning the sums again
+// and adding them back with clBlockPrefix yields a scan of arbitrary length.
+__kernel void clBlockScan(__global uint* data, uint offset, __global uint* sums, uint sumOffset, uint size)
 {
     int globalId = get_global_id(0);
     int threadid = get_local_id(0);
     int blockid = get_group_id(0);
 
+    uint index = globalId*4;
     uint4 value4 = 0;
-    if (globalId < size)
+    if (index + 3 < size)
+    {
+        value4 = vload4(0, data + offset + index);
+    }
+    else
     {
-        value4 = blockScan[globalId];
+        value4.x = index     < size ? data[offset + index] : 0;
+        value4.y = index + 1 < size ? data[offset + index + 1] : 0;
+        value4.z = index + 2 < size ? data[offset + index + 2] : 0;
     }
 
     __local uint prefixSum[BLOCKSIZE];
@@ -133,56 +146,48 @@ __kernel void clBlockScan(__global uint4* blockScan, __global uint* scanSum, uin
     prefixSum[threadid] = sum.w;
     barrier(CLK_LOCAL_MEM_FENCE);
 
-    if (threadid == BLOCKSIZE - 1)
+    for (int i=1; i<BLOCKSIZE; i<<=1)
     {
-        for (int i=1; i<BLOCKSIZE; i++)
-        {
-            prefixSum[i] += prefixSum[i-1]; 
-        }
+        uint partial = threadid >= i ? prefixSum[threadid-i] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        prefixSum[threadid] += partial;
+        barrier(CLK_LOCAL_MEM_FENCE);
     }
-    barrier(CLK_LOCAL_MEM_FENCE);
 
     uint count = prefixSum[threadid] - sum.w; 
-    if (globalId < size)
+    uint4 result;
+    result.x = count;
+    result.y = count + sum.x;
+    result.z = count + sum.y;
+    result.w = count + sum.z;
+    if (index + 3 < size)
     {
-        uint4 result;
-        result.x = count;
-        result.y = count + sum.x;
-        result.z = count + sum.y;
-        result.w = count + sum.z;
-        blockScan[globalId] = result; 
+        vstore4(result, 0, data + offset + index);
+    }
+    else
+    {
+        if (index     < size) data[offset + index]     = result.x;
+        if (index + 1 < size) data[offset + index + 1] = result.y;
+        if (index + 2 < size) data[offset + index + 2] = result.z;
     }
-    barrier(CLK_LOCAL_MEM_FENCE);
 
     if (threadid == BLOCKSIZE-1)
     {
-        scanSum[blockid] = count + sum.w; // exclusive -> inclusive
+        sums[sumOffset + blockid] = count + sum.w; // exclusive -> inclusive
     }
 }
 
-__kernel void clBlockPrefix(__global uint4* blockScan, __global uint* blockSum, uint size)
+// Adds the scanned work group totals of the next level to the elements of a level.
+__kernel void clBlockPrefix(__global uint* data, uint offset, __global uint* sums, uint sumOffset, uint size)
 {
     int globalId = get_global_id(0);
-    int threadid = get_local_id(0);
     int blockid = get_group_id(0);
 
-    __local uint prefixSum[BLOCKSIZE];
-
-    prefixSum[threadid] = blockSum[threadid];
-    barrier(CLK_LOCAL_MEM_FENCE);
-
-    if (threadid == BLOCKSIZE - 1)
-    {
-        for (int i=1; i<BLOCKSIZE; i++)
-        {
-            prefixSum[i] += prefixSum[i-1];
-        }
-    }
-    barrier(CLK_LOCAL_MEM_FENCE);
-
-    if (blockid > 0 && globalId < size)
+    uint prefix = sums[sumOffset + blockid];
+    uint index = globalId*4;
+    for (uint i=index; i<index+4 && i<size; i++)
     {
-        blockScan[globalId] = blockScan[globalId] + prefixSum[blockid-1];
+        data[offset + i] += prefix;
     }
 }
 
@@ -214,9 +219,46 @@ __kernel void clReorder(__global uint* keyIn,
 
     uint key = keyIn[globalId];
     uint val = valIn[globalId];
-    uint radix = (key >> startbit) & 0xF;
+    uint radix = (key >> startbit) & (RADIX-1);
     uint index = totalOffset[radix] + threadid - blockOffset[radix];
 
     keyOut[index] = key;
     valOut[index] = val;
 }
+
+//
+// counting sort
+//
+__kernel void clBinClear(__global uint* binCount, uint size)
+{
+    int globalId = get_global_id(0);
+    if (globalId < size)
+    {
+        binCount[globalId] = 0;
+    }
+}
+
+__kernel void clBinCount(__global const uint* key, __global uint* binCount, __global uint* rank, uint size)
+{
+    int globalId = get_global_id(0);
+    if (globalId < size)
+    {
+        rank[globalId] = atomic_inc(&binCount[key[globalId]]);
+    }
+}
+
+__kernel void clBinScatter(__global const uint* keyIn, 
+                           __global uint* keyOut, 
+                           __global const uint* valIn, 
+                           __global uint* valOut, 
+                           __global const uint* binOffset, __global const uint* rank, uint size)
+{
+    int globalId = get_global_id(0);
+    if (globalId < size)
+    {
+        uint key = keyIn[globalId];
+        uint index = binOffset[key] + rank[globalId];
+        keyOut[index] = key;
+        valOut[index] = valIn[globalId];
+    }
+}
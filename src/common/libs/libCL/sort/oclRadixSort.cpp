@@ -14,42 +14,56 @@
 #include "oclRadixSort.h"
 
 #include <math.h>
+#include <stdio.h>
+#include <vector>
 
-#define CBITS 4
 #define BLOCK_SIZE 256
-#define BLOCK_SIZE_CUBE BLOCK_SIZE*BLOCK_SIZE*BLOCK_SIZE
 
-const int oclRadixSort::cBits = CBITS;
 const size_t oclRadixSort::cBlockSize = BLOCK_SIZE;
-const size_t oclRadixSort::cMaxArraySize = BLOCK_SIZE_CUBE*4/(1<<CBITS);
+const size_t oclRadixSort::cScanSize = BLOCK_SIZE*4; // elements scanned per work group
 
 
-oclRadixSort::oclRadixSort(oclContext& iContext)
+oclRadixSort::oclRadixSort(oclContext& iContext, int iBits)
 : oclProgram(iContext, "oclRadixSort")
+, mBits(iBits < 1 ? 1 : (iBits > 8 ? 8 : iBits))
 // buffers
 , bfTempKey(iContext, "bfTempKey")
 , bfTempVal(iContext, "bfTempVal")
 , bfBlockScan(iContext, "bfBlockScan")
 , bfBlockOffset(iContext, "bfBlockOffset")
 , bfBlockSum(iContext, "bfBlockSum")
+, bfBinCount(iContext, "bfBinCount")
+, bfBinOffset(iContext, "bfBinOffset")
+, bfBinRank(iContext, "bfBinRank")
 // kernels
 , clBlockSort(*this)
 , clBlockScan(*this)
 , clBlockPrefix(*this)
 , clReorder(*this)
+, clBinClear(*this)
+, clBinCount(*this)
+, clBinScatter(*this)
 {
     bfTempKey.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
     bfTempVal.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
     bfBlockScan.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
     bfBlockOffset.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
     bfBlockSum.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
+    bfBinCount.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
+    bfBinOffset.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
+    bfBinRank.create<cl_uint>(CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, cBlockSize);
 
+    sprintf(mDefines, "#define BITS %d\n", mBits);
+    addSourceCode(mDefines);
     addSourceFile("sort/oclRadixSort.cl");
 
     exportKernel(clBlockSort);
     exportKernel(clBlockScan);
     exportKernel(clBlockPrefix);
     exportKernel(clReorder);
+    exportKernel(clBinClear);
+    exportKernel(clBinCount);
+    exportKernel(clBinScatter);
 }
 
 void oclRadixSort::fit(oclBuffer& iBuffer, size_t iElements) 
@@ -63,6 +77,21 @@ void oclRadixSort::fit(oclBuffer& iBuffer, size_t iElements)
     }
 }
 
+int oclRadixSort::getBits()
+{
+    return mBits;
+}
+
+oclBuffer& oclRadixSort::getBinOffsetBuffer()
+{
+    return bfBinOffset;
+}
+
+oclBuffer& oclRadixSort::getBinCountBuffer()
+{
+    return bfBinCount;
+}
+
 //
 //
 //
@@ -82,6 +111,12 @@ int oclRadixSort::compile()
     KERNEL_VALIDATE(clBlockPrefix)
     clReorder = createKernel("clReorder");
     KERNEL_VALIDATE(clReorder)
+    clBinClear = createKernel("clBinClear");
+    KERNEL_VALIDATE(clBinClear)
+    clBinCount = createKernel("clBinCount");
+    KERNEL_VALIDATE(clBinCount)
+    clBinScatter = createKernel("clBinScatter");
+    KERNEL_VALIDATE(clBinScatter)
     return 1;
 }
 
@@ -94,32 +129,24 @@ int oclRadixSort::compute(oclDevice& iDevice, oclBuffer& bfKey, oclBuffer& bfVal
         return false;
     }
 
-    if (bfKey.count<cl_uint>() >= cMaxArraySize)
-    {
-        Log(ERR, this, __FILE__, __LINE__) << "maximum sortable array size = " << cMaxArraySize;
-        return false;
-    } 
-
-    if ((iEndBit - iStartBit) % cBits != 0)
+    if ((iEndBit - iStartBit) % mBits != 0)
     {
-        Log(ERR, this, __FILE__, __LINE__) << "end bit(" << iEndBit << ") - start bit(" << iStartBit << ") must be divisible by 4";
+        Log(ERR, this, __FILE__, __LINE__) << "end bit(" << iEndBit << ") - start bit(" << iStartBit << ") must be divisible by " << mBits;
         return false;
     } 
 
     size_t lBlockCount = ceil((float)bfKey.count<cl_uint>()/cBlockSize);
-    fit(bfBlockScan, lBlockCount*(1<<cBits));
-    fit(bfBlockOffset, lBlockCount*(1<<cBits));
-    fit(bfBlockSum, cBlockSize);
+    size_t lScanCount = lBlockCount*(1<<mBits);
+    fit(bfBlockScan, lScanCount);
+    fit(bfBlockOffset, lScanCount);
 
     size_t lElementCount = bfKey.count<cl_uint>();
     fit(bfTempKey, lElementCount);
     fit(bfTempVal, lElementCount);
 
     size_t lGlobalSize = lBlockCount*cBlockSize;
-    size_t lScanCount = lBlockCount*(1<<cBits)/4;
-    size_t lScanSize = ceil((float)lScanCount/cBlockSize)*cBlockSize;
 
-    for (int j=iStartBit; j<iEndBit; j+=cBits)
+    for (int j=iStartBit; j<iEndBit; j+=mBits)
     {
         clSetKernelArg(clBlockSort, 0, sizeof(cl_mem), bfKey);
         clSetKernelArg(clBlockSort, 1, sizeof(cl_mem), bfTempKey);
@@ -135,20 +162,7 @@ int oclRadixSort::compute(oclDevice& iDevice, oclBuffer& bfKey, oclBuffer& bfVal
             return false;
         } 
 
-        clSetKernelArg(clBlockScan, 0, sizeof(cl_mem), bfBlockScan);
-        clSetKernelArg(clBlockScan, 1, sizeof(cl_mem), bfBlockSum);
-        clSetKernelArg(clBlockScan, 2, sizeof(cl_uint), &lScanCount);
-        sStatusCL = clEnqueueNDRangeKernel(iDevice.getQueue(), clBlockScan, 1, NULL, &lScanSize, &cBlockSize, 0, NULL, clBlockScan.getEvent());
-        if (!oclSuccess("clEnqueueNDRangeKernel", this))
-        {
-            return false;
-        }
-
-        clSetKernelArg(clBlockPrefix, 0, sizeof(cl_mem), bfBlockScan);
-        clSetKernelArg(clBlockPrefix, 1, sizeof(cl_mem), bfBlockSum);
-        clSetKernelArg(clBlockPrefix, 2, sizeof(cl_uint), &lScanCount);
-        sStatusCL = clEnqueueNDRangeKernel(iDevice.getQueue(), clBlockPrefix, 1, NULL, &lScanSize, &cBlockSize, 0, NULL, clBlockPrefix.getEvent());
-        if (!oclSuccess("clEnqueueNDRangeKernel", this))
+        if (!scan(iDevice, bfBlockScan, lScanCount))
         {
             return false;
         }
@@ -169,3 +183,134 @@ int oclRadixSort::compute(oclDevice& iDevice, oclBuffer& bfKey, oclBuffer& bfVal
     }
     return true;
 };
+
+//
+//
+//
+
+int oclRadixSort::computeBins(oclDevice& iDevice, oclBuffer& bfKey, oclBuffer& bfVal, size_t iBinCount)
+{
+    if (bfKey.dim(0) != bfVal.dim(0))
+    {
+        Log(ERR, this, __FILE__, __LINE__) << "key and value arrays are of different size ( " << bfKey.getMemObjectInfo<size_t>(CL_MEM_SIZE) << "," << bfVal.getMemObjectInfo<size_t>(CL_MEM_SIZE) << ")";
+        return false;
+    }
+
+    cl_uint lElementCount = bfKey.count<cl_uint>();
+    cl_uint lBinCount = iBinCount;
+    fit(bfTempKey, lElementCount);
+    fit(bfTempVal, lElementCount);
+    fit(bfBinRank, lElementCount);
+    fit(bfBinCount, lBinCount);
+    fit(bfBinOffset, lBinCount);
+
+    size_t lGlobalSize = (lElementCount + cBlockSize - 1)/cBlockSize*cBlockSize;
+    size_t lBinSize = (lBinCount + cBlockSize - 1)/cBlockSize*cBlockSize;
+
+    clSetKernelArg(clBinClear, 0, sizeof(cl_mem), bfBinCount);
+    clSetKernelArg(clBinClear, 1, sizeof(cl_uint), &lBinCount);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clBinClear, 1, NULL, &lBinSize, &cBlockSize, 0, NULL, clBinClear.getEvent());
+    ENQUEUE_VALIDATE
+
+    // histogram of the keys, every element remembers its rank within its bin
+    clSetKernelArg(clBinCount, 0, sizeof(cl_mem), bfKey);
+    clSetKernelArg(clBinCount, 1, sizeof(cl_mem), bfBinCount);
+    clSetKernelArg(clBinCount, 2, sizeof(cl_mem), bfBinRank);
+    clSetKernelArg(clBinCount, 3, sizeof(cl_uint), &lElementCount);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clBinCount, 1, NULL, &lGlobalSize, &cBlockSize, 0, NULL, clBinCount.getEvent());
+    ENQUEUE_VALIDATE
+
+    sStatusCL = clEnqueueCopyBuffer(iDevice, bfBinCount, bfBinOffset, 0, 0, lBinCount*sizeof(cl_uint), 0, NULL, NULL);
+    if (!oclSuccess("clEnqueueCopyBuffer", this))
+    {
+        return false;
+    }
+
+    if (!scan(iDevice, bfBinOffset, lBinCount))
+    {
+        return false;
+    }
+
+    clSetKernelArg(clBinScatter, 0, sizeof(cl_mem), bfKey);
+    clSetKernelArg(clBinScatter, 1, sizeof(cl_mem), bfTempKey);
+    clSetKernelArg(clBinScatter, 2, sizeof(cl_mem), bfVal);
+    clSetKernelArg(clBinScatter, 3, sizeof(cl_mem), bfTempVal);
+    clSetKernelArg(clBinScatter, 4, sizeof(cl_mem), bfBinOffset);
+    clSetKernelArg(clBinScatter, 5, sizeof(cl_mem), bfBinRank);
+    clSetKernelArg(clBinScatter, 6, sizeof(cl_uint), &lElementCount);
+    sStatusCL = clEnqueueNDRangeKernel(iDevice, clBinScatter, 1, NULL, &lGlobalSize, &cBlockSize, 0, NULL, clBinScatter.getEvent());
+    ENQUEUE_VALIDATE
+
+    sStatusCL = clEnqueueCopyBuffer(iDevice, bfTempKey, bfKey, 0, 0, lElementCount*sizeof(cl_uint), 0, NULL, NULL);
+    if (!oclSuccess("clEnqueueCopyBuffer", this))
+    {
+        return false;
+    }
+    sStatusCL = clEnqueueCopyBuffer(iDevice, bfTempVal, bfVal, 0, 0, lElementCount*sizeof(cl_uint), 0, NULL, NULL);
+    return oclSuccess("clEnqueueCopyBuffer", this);
+}
+
+//
+//
+//
+
+int oclRadixSort::scan(oclDevice& iDevice, oclBuffer& bfData, size_t iCount)
+{
+    // the work group totals of all scan levels are stored one after another in bfBlockSum
+    size_t lSumCount = 0;
+    for (size_t lLevel = iCount; lLevel > 1; lLevel = (lLevel + cScanSize - 1)/cScanSize)
+    {
+        lSumCount += (lLevel + cScanSize - 1)/cScanSize;
+    }
+    fit(bfBlockSum, lSumCount);
+
+    // element count and offset into bfBlockSum of every level, level 0 is bfData
+    std::vector<cl_uint> lCount;
+    std::vector<cl_uint> lOffset;
+    lCount.push_back(iCount);
+    lOffset.push_back(0);
+    cl_uint lSumOffset = 0;
+    while (lCount.back() > cScanSize)
+    {
+        lOffset.push_back(lSumOffset);
+        lCount.push_back((lCount.back() + cScanSize - 1)/cScanSize);
+        lSumOffset += lCount.back();
+    }
+    // totals of the top level are not needed but written nevertheless
+    lOffset.push_back(lSumOffset);
+
+    // scan upwards, every level scans the work group totals of the previous one
+    for (size_t i=0; i<lCount.size(); i++)
+    {
+        cl_mem lData = i ? (cl_mem)bfBlockSum : (cl_mem)bfData;
+        size_t lGlobalSize = (lCount[i] + cScanSize - 1)/cScanSize*cBlockSize;
+        clSetKernelArg(clBlockScan, 0, sizeof(cl_mem), &lData);
+        clSetKernelArg(clBlockScan, 1, sizeof(cl_uint), &lOffset[i]);
+        clSetKernelArg(clBlockScan, 2, sizeof(cl_mem), bfBlockSum);
+        clSetKernelArg(clBlockScan, 3, sizeof(cl_uint), &lOffset[i+1]);
+        clSetKernelArg(clBlockScan, 4, sizeof(cl_uint), &lCount[i]);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice.getQueue(), clBlockScan, 1, NULL, &lGlobalSize, &cBlockSize, 0, NULL, clBlockScan.getEvent());
+        if (!oclSuccess("clEnqueueNDRangeKernel", this))
+        {
+            return false;
+        }
+    }
+
+    // propagate the scanned totals back down
+    for (int i=(int)lCount.size()-2; i>=0; i--)
+    {
+        cl_mem lData = i ? (cl_mem)bfBlockSum : (cl_mem)bfData;
+        size_t lGlobalSize = (lCount[i] + cScanSize - 1)/cScanSize*cBlockSize;
+        clSetKernelArg(clBlockPrefix, 0, sizeof(cl_mem), &lData);
+        clSetKernelArg(clBlockPrefix, 1, sizeof(cl_uint), &lOffset[i]);
+        clSetKernelArg(clBlockPrefix, 2, sizeof(cl_mem), bfBlockSum);
+        clSetKernelArg(clBlockPrefix, 3, sizeof(cl_uint), &lOffset[i+1]);
+        clSetKernelArg(clBlockPrefix, 4, sizeof(cl_uint), &lCount[i]);
+        sStatusCL = clEnqueueNDRangeKernel(iDevice.getQueue(), clBlockPrefix, 1, NULL, &lGlobalSize, &cBlockSize, 0, NULL, clBlockPrefix.getEvent());
+        if (!oclSuccess("clEnqueueNDRangeKernel", this))
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -23,29 +23,47 @@ class oclRadixSort : public oclProgram
 {
     public: 
 
-        oclRadixSort(oclContext& iContext);
+        // iBits selects the digit width sorted per pass (1 to 8 bits)
+        oclRadixSort(oclContext& iContext, int iBits = 4);
 
         int compile();
         int compute(oclDevice& iDevice, oclBuffer& bfKey, oclBuffer& bfVal, int iStartBit, int iEndBit);
 
+        // single pass counting sort for keys smaller than iBinCount, afterwards
+        // the bin buffers hold the first element and size of every bin
+        int computeBins(oclDevice& iDevice, oclBuffer& bfKey, oclBuffer& bfVal, size_t iBinCount);
+        oclBuffer& getBinOffsetBuffer();
+        oclBuffer& getBinCountBuffer();
+
+        int getBits();
+
     protected:
 
-        static const int cBits;
         static const size_t cBlockSize;
-        static const size_t cMaxArraySize;
+        static const size_t cScanSize;
+
+        int mBits;
+        char mDefines[64];
 
         oclKernel clBlockSort;
         oclKernel clBlockScan;
         oclKernel clBlockPrefix;
         oclKernel clReorder;
+        oclKernel clBinClear;
+        oclKernel clBinCount;
+        oclKernel clBinScatter;
 
         oclBuffer bfTempKey;
         oclBuffer bfTempVal;
         oclBuffer bfBlockScan;
         oclBuffer bfBlockSum;
         oclBuffer bfBlockOffset;
+        oclBuffer bfBinCount;
+        oclBuffer bfBinOffset;
+        oclBuffer bfBinRank;
 
         void fit(oclBuffer& iBuffer, size_t iElements) ;
+        int scan(oclDevice& iDevice, oclBuffer& bfData, size_t iCount);
 
 };      
 
@@ -16,9 +16,10 @@ struct Run
 {
     const string taskDescription;
     size_t size;
+    double workload; // amount of work in the plugin's throughput unit, 0 if the plugin reports none
 
-    Run(string taskDescription, size_t size)
-        : taskDescription(taskDescription), size(size)
+    Run(string taskDescription, size_t size, double workload = 0.0)
+        : taskDescription(taskDescription), size(size), workload(workload)
     {
     }
 };
@@ -37,8 +38,8 @@ struct CPURun : public Run
     bool exceptionOccured;
     string exceptionMsg;
 
-    CPURun(string taskDescription, size_t size)
-        : Run(taskDescription, size), exceptionOccured(false)
+    CPURun(string taskDescription, size_t size, double workload = 0.0)
+        : Run(taskDescription, size, workload), exceptionOccured(false)
     {
     }
 };
@@ -80,8 +81,8 @@ struct CLRun : public Run
     double avgRunTime;
     double avgDownloadTime;
 
-    CLRun(string taskDescription, size_t size)
-        : Run(taskDescription, size)
+    CLRun(string taskDescription, size_t size, double workload = 0.0)
+        : Run(taskDescription, size, workload)
     {
     }
 };
\ No newline at end of file
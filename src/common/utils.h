@@ -8,6 +8,7 @@
 #include <iterator>
 #include <algorithm>
 #include <iostream>
+#include <string.h>
 
 #include "structs.h"
 
@@ -54,6 +55,10 @@ string getTypeName()
         return "double";
     if(typeid(T) == typeid(unsigned int) || typeid(T) == typeid(cl_uint))
         return "uint";
+    if(typeid(T) == typeid(cl_ulong))
+        return "ulong";
+    if(typeid(T) == typeid(cl_float4))
+        return "float4";
     return "unknown";
 }
 
@@ -82,6 +87,66 @@ void printArrQuad(T* arr, size_t edgeLength)
     printArr2D(arr, edgeLength * edgeLength, edgeLength);
 }
 
+/**
+ * Counter based pseudo random number generator.
+ * Returns the counter-th number of the random stream identified by seed using the SplitMix64 mixing function.
+ * Every number only depends on seed and counter, so arrays can be filled in parallel and yield the same values on every platform and for any number of threads.
+ */
+inline uint64_t randomAt(uint64_t seed, uint64_t counter)
+{
+    uint64_t z = seed * 0xbf58476d1ce4e5b9ULL + (counter + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Converts a random number created by randomAt into a double in [0, 1).
+ */
+inline double randomToUnit(uint64_t random)
+{
+    return (random >> 11) * (1.0 / 9007199254740992.0);
+}
+
+const size_t PARALLEL_CHUNK_SIZE = 1 << 16;
+
+/**
+ * Fills the given array in parallel with generator(randomAt(seed, i)) for every index i.
+ */
+template <typename T, typename F>
+void fillRandom(T* data, size_t size, uint64_t seed, F generator)
+{
+    int chunks = (int)((size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
+
+    #pragma omp parallel for
+    for(int c = 0; c < chunks; c++)
+    {
+        size_t begin = c * PARALLEL_CHUNK_SIZE;
+        size_t end = min(begin + PARALLEL_CHUNK_SIZE, size);
+
+        for(size_t i = begin; i < end; i++)
+            data[i] = generator(randomAt(seed, i));
+    }
+}
+
+/**
+ * Copies count elements from source to destination using multiple threads.
+ */
+template <typename T>
+void parallelCopy(T* destination, const T* source, size_t count)
+{
+    int chunks = (int)((count + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
+
+    #pragma omp parallel for
+    for(int c = 0; c < chunks; c++)
+    {
+        size_t begin = c * PARALLEL_CHUNK_SIZE;
+        size_t end = min(begin + PARALLEL_CHUNK_SIZE, count);
+
+        memcpy(destination + begin, source + begin, (end - begin) * sizeof(T));
+    }
+}
+
 unsigned int ctz(unsigned int);
 unsigned int clz(unsigned int);
 
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+/**
+* Filters benchmarked by the ImagePlugin. Every algorithm implements exactly one of them.
+*/
+enum class FilterType
+{
+    RecursiveGaussian, // Young / van Vliet IIR gaussian, columns first
+    Sobel,             // x and y gradients, the result holds the dx image followed by the dy image
+    Convolution,       // separable gaussian convolution, x axis first
+    Bilateral,         // brute force bilateral filter on the luminance
+    BilateralGrid,     // splat, blur and slice through a bilateral grid
+    ToneMapping,       // multi scale tone mapping of a high dynamic range image
+    Bloom              // threshold, blur and add of the bright parts
+};
+
+inline const string filterTypeToString(FilterType filter)
+{
+    switch(filter)
+    {
+    case FilterType::RecursiveGaussian: return "recursive gaussian";
+    case FilterType::Sobel:             return "sobel";
+    case FilterType::Convolution:       return "convolution";
+    case FilterType::Bilateral:         return "bilateral";
+    case FilterType::BilateralGrid:     return "bilateral grid";
+    case FilterType::ToneMapping:       return "tone mapping";
+    case FilterType::Bloom:             return "bloom";
+    }
+    return "unknown";
+}
+
+// filter parameters shared by the CPU references and the OpenCL algorithms
+const float GAUSSIAN_SIGMA = 10.1f;
+const int CONVOLUTION_RADIUS = 4;
+const float CONVOLUTION_SIGMA = 2.0f;
+const int BILATERAL_RADIUS = 4;
+const float BILATERAL_RANGE = 0.2f;
+const size_t BILATERAL_GRID_CELL = 16; // pixels per grid cell along x and y
+const size_t BILATERAL_GRID_DEPTH = 32;
+const int BILATERAL_GRID_RADIUS = 2;
+const float BILATERAL_GRID_SIGMA = 1.0f;
+const float BLOOM_THRESHOLD = 0.9f;
+const float BLOOM_INTENSITY = 0.9f;
+const float LUMINANCE[4] = { 0.2126f, 0.7152f, 0.0722f, 0.0f }; // Rec. 709 weights, also the range mask of the bilateral filters
+
+class ImageAlgorithm
+{
+    public:
+        virtual FilterType getFilterType() = 0;
+
+        /**
+        * The problem size is the image height, the width follows from a 16:9 aspect ratio (e.g. 1080 -> 1920x1080).
+        */
+        static size_t getWidth(size_t height)
+        {
+            return height * 16 / 9;
+        }
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "ImageAlgorithm.h"
+#include "cpu/Filters.h"
+
+using namespace std;
+
+/**
+* Images generated by the ImagePlugin. All pixels are RGBA with an alpha of 1.
+*/
+enum class ImagePattern
+{
+    Noise,           // uniform random channels in [0, 1)
+    Gradient,        // smooth ramps along x, y and the diagonal
+    Blocks,          // constant colored blocks with a little noise, gives edges and flat areas
+    HighDynamicRange // blocks whose brightness spans 2^-4 to 2^8
+};
+
+inline const string imagePatternToString(ImagePattern pattern)
+{
+    switch(pattern)
+    {
+    case ImagePattern::Noise:            return "noise";
+    case ImagePattern::Gradient:         return "gradient";
+    case ImagePattern::Blocks:           return "blocks";
+    case ImagePattern::HighDynamicRange: return "high dynamic range";
+    }
+    return "unknown";
+}
+
+template <typename T>
+class ImagePlugin
+{
+    public:
+        typedef ImageAlgorithm AlgorithmType;
+
+        ImagePlugin()
+            : filter(FilterType::RecursiveGaussian), pattern(ImagePattern::Blocks), referenceSize(0)
+        {
+        }
+
+        /**
+        * Sets the filter which is verified. Algorithms computing a different filter fail the verification.
+        */
+        void setFilter(FilterType filter)
+        {
+            this->filter = filter;
+            referenceSize = 0;
+        }
+
+        FilterType getFilter()
+        {
+            return filter;
+        }
+
+        /**
+        * Sets the image created by genInput.
+        */
+        void setPattern(ImagePattern pattern)
+        {
+            this->pattern = pattern;
+            referenceSize = 0;
+        }
+
+        const string getTaskDescription(size_t size)
+        {
+            stringstream ss;
+            ss << "Filtering (" << filterTypeToString(filter) << ") " << ImageAlgorithm::getWidth(size) << "x" << size << " RGBA image of type " << getTypeName<T>() << " (" << sizeToString(getInputLength(size) * sizeof(T)) << ", " << imagePatternToString(pattern) << ")";
+            return ss.str();
+        }
+
+        /**
+        * Million pixels per image, the writers report MPixel/s.
+        */
+        double getWorkload(size_t size)
+        {
+            return ImageAlgorithm::getWidth(size) * size / 1e6;
+        }
+
+        const string getThroughputUnit()
+        {
+            return "MPixel/s";
+        }
+
+        size_t getInputLength(size_t size)
+        {
+            return ImageAlgorithm::getWidth(size) * size * 4;
+        }
+
+        T* genInput(size_t size)
+        {
+            size_t width = ImageAlgorithm::getWidth(size);
+            size_t blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+            T* data = new T[getInputLength(size)];
+
+            // all random numbers are derived from the seed and the pixel or block index, so the result does not depend on the scheduling
+            #pragma omp parallel for
+            for(int y = 0; y < (int)size; y++)
+                for(size_t x = 0; x < width; x++)
+                {
+                    size_t pixel = y * width + x;
+                    size_t block = (y / BLOCK_SIZE) * blocksX + x / BLOCK_SIZE;
+                    T* p = data + pixel * 4;
+
+                    switch(pattern)
+                    {
+                    case ImagePattern::Noise:
+                        for(int c = 0; c < 3; c++)
+                            p[c] = (T)randomToUnit(randomAt(SEED, pixel * 4 + c));
+                        break;
+                    case ImagePattern::Gradient:
+                        p[0] = (T)x / (T)width;
+                        p[1] = (T)y / (T)size;
+                        p[2] = (T)(x + y) / (T)(width + size);
+                        break;
+                    case ImagePattern::Blocks:
+                    case ImagePattern::HighDynamicRange:
+                    {
+                        T scale = 1;
+                        if(pattern == ImagePattern::HighDynamicRange)
+                            scale = (T)pow(2.0, -4.0 + 12.0 * randomToUnit(randomAt(SEED + 1, block)));
+
+                        for(int c = 0; c < 3; c++)
+                        {
+                            double noise = (randomToUnit(randomAt(SEED + 2, pixel * 4 + c)) - 0.5) * 0.1;
+                            double value = randomToUnit(randomAt(SEED, block * 4 + c)) + noise;
+                            p[c] = (T)min(max(value, 0.0), 1.0) * scale;
+                        }
+                        break;
+                    }
+                    }
+
+                    p[3] = 1;
+                }
+
+            return data;
+        }
+
+        T* genResult(size_t size)
+        {
+            // the sobel filter writes two gradient images
+            return new T[getInputLength(size) * (filter == FilterType::Sobel ? 2 : 1)];
+        }
+
+        void freeInput(T* data)
+        {
+            delete[] data;
+        }
+
+        void freeResult(T* result)
+        {
+            delete[] result;
+        }
+
+        bool verifyResult(ImageAlgorithm* alg, T* data, T* result, size_t size)
+        {
+            if(alg->getFilterType() != filter)
+                return false;
+
+            size_t length = getInputLength(size) * (filter == FilterType::Sobel ? 2 : 1);
+
+            // the tone mapping reads bilinear filtered half float pyramid levels and switches the level on a threshold,
+            // so there is no reference it could be compared against, it only has to produce a valid image
+            if(filter == FilterType::ToneMapping)
+            {
+                bool success = true;
+
+                #pragma omp parallel for reduction(&&:success)
+                for(int i = 0; i < (int)length; i++)
+                    success = success && fabs(result[i]) <= numeric_limits<T>::max();
+
+                return success;
+            }
+
+            // the input is the same for every run of a size, so the reference is only computed once
+            if(referenceSize != size)
+            {
+                computeReference(data, size);
+                referenceSize = size;
+            }
+
+            T tolerance = getTolerance();
+            bool success = true;
+
+            #pragma omp parallel for reduction(&&:success)
+            for(int i = 0; i < (int)length; i++)
+                success = success && compare(result[i], reference[i], tolerance);
+
+            return success;
+        }
+
+    private:
+        static const size_t BLOCK_SIZE = 32;
+        static const uint64_t SEED = 0;
+
+        void computeReference(T* data, size_t size)
+        {
+            size_t width = ImageAlgorithm::getWidth(size);
+            size_t length = getInputLength(size);
+
+            reference.resize(length * (filter == FilterType::Sobel ? 2 : 1));
+
+            switch(filter)
+            {
+            case FilterType::RecursiveGaussian:
+                cpu::filters::recursiveGaussian(data, reference.data(), width, size, GAUSSIAN_SIGMA);
+                break;
+            case FilterType::Sobel:
+                cpu::filters::sobel(data, reference.data(), reference.data() + length, width, size);
+                break;
+            case FilterType::Convolution:
+                cpu::filters::convolution(data, reference.data(), width, size, CONVOLUTION_SIGMA, CONVOLUTION_RADIUS);
+                break;
+            case FilterType::Bilateral:
+                cpu::filters::bilateral(data, reference.data(), width, size, BILATERAL_RADIUS, BILATERAL_RANGE, LUMINANCE);
+                break;
+            case FilterType::BilateralGrid:
+                cpu::filters::bilateralGrid(data, reference.data(), width, size, BILATERAL_GRID_CELL, BILATERAL_GRID_DEPTH, BILATERAL_GRID_SIGMA, BILATERAL_GRID_RADIUS, LUMINANCE);
+                break;
+            case FilterType::Bloom:
+                cpu::filters::bloom(data, reference.data(), width, size, BLOOM_THRESHOLD, BLOOM_INTENSITY, GAUSSIAN_SIGMA);
+                break;
+            case FilterType::ToneMapping:
+                break;
+            }
+        }
+
+        /**
+        * Relative tolerance of a filter, values below 1 are compared absolutely.
+        */
+        T getTolerance()
+        {
+            switch(filter)
+            {
+            case FilterType::Sobel:
+            case FilterType::Convolution:
+                return (T)1e-4;
+            case FilterType::RecursiveGaussian:
+            case FilterType::Bilateral:
+                return (T)1e-3;
+            case FilterType::BilateralGrid: // the linear sampler of the grid uses 8 bit weights on most devices
+            case FilterType::Bloom:         // the bright pass is blurred in half float images
+            default:
+                return (T)2e-2;
+            }
+        }
+
+        inline bool compare(T value, T expected, T tolerance)
+        {
+            // empty bilateral grid cells divide 0 by 0 on both sides
+            if(std::isnan(expected))
+                return std::isnan(value);
+            return fabs(value - expected) <= tolerance * max((T)1, (T)fabs(expected));
+        }
+
+        FilterType filter;
+        ImagePattern pattern;
+
+        vector<T> reference;
+        size_t referenceSize;
+};
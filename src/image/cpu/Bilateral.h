@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../common/CPUAlgorithm.h"
+#include "../ImageAlgorithm.h"
+#include "Filters.h"
+
+namespace cpu
+{
+    /**
+    * Parallel reference implementation, also used by the ImagePlugin for verification.
+    */
+    template<typename T>
+    class Bilateral : public CPUAlgorithm<T>, public ImageAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Bilateral filter (OpenMP)";
+            }
+
+            FilterType getFilterType() override
+            {
+                return FilterType::Bilateral;
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                cpu::filters::bilateral(data, result, ImageAlgorithm::getWidth(size), size, BILATERAL_RADIUS, BILATERAL_RANGE, LUMINANCE);
+            }
+
+            virtual ~Bilateral() {}
+    };
+}
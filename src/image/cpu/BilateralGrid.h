@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../common/CPUAlgorithm.h"
+#include "../ImageAlgorithm.h"
+#include "Filters.h"
+
+namespace cpu
+{
+    /**
+    * Parallel reference implementation, also used by the ImagePlugin for verification.
+    */
+    template<typename T>
+    class BilateralGrid : public CPUAlgorithm<T>, public ImageAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Bilateral grid (OpenMP)";
+            }
+
+            FilterType getFilterType() override
+            {
+                return FilterType::BilateralGrid;
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                cpu::filters::bilateralGrid(data, result, ImageAlgorithm::getWidth(size), size, BILATERAL_GRID_CELL, BILATERAL_GRID_DEPTH, BILATERAL_GRID_SIGMA, BILATERAL_GRID_RADIUS, LUMINANCE);
+            }
+
+            virtual ~BilateralGrid() {}
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../common/CPUAlgorithm.h"
+#include "../ImageAlgorithm.h"
+#include "Filters.h"
+
+namespace cpu
+{
+    /**
+    * Parallel reference implementation, also used by the ImagePlugin for verification.
+    */
+    template<typename T>
+    class Bloom : public CPUAlgorithm<T>, public ImageAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Bloom (OpenMP)";
+            }
+
+            FilterType getFilterType() override
+            {
+                return FilterType::Bloom;
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                cpu::filters::bloom(data, result, ImageAlgorithm::getWidth(size), size, BLOOM_THRESHOLD, BLOOM_INTENSITY, GAUSSIAN_SIGMA);
+            }
+
+            virtual ~Bloom() {}
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../common/CPUAlgorithm.h"
+#include "../ImageAlgorithm.h"
+#include "Filters.h"
+
+namespace cpu
+{
+    /**
+    * Parallel reference implementation, also used by the ImagePlugin for verification.
+    */
+    template<typename T>
+    class Convolution : public CPUAlgorithm<T>, public ImageAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Separable gaussian convolution (OpenMP)";
+            }
+
+            FilterType getFilterType() override
+            {
+                return FilterType::Convolution;
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                cpu::filters::convolution(data, result, ImageAlgorithm::getWidth(size), size, CONVOLUTION_SIGMA, CONVOLUTION_RADIUS);
+            }
+
+            virtual ~Convolution() {}
+    };
+}
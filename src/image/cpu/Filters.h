@@ -0,0 +1,378 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "../ImageAlgorithm.h"
+
+using namespace std;
+
+/**
+* Reference implementations of the filters benchmarked by the ImagePlugin.
+* They follow the libCL kernels operation by operation, so the OpenCL results only differ by rounding.
+* Images are RGBA float, stored row by row with four interleaved channels per pixel.
+*/
+namespace cpu
+{
+    namespace filters
+    {
+        inline float dot4(const float* a, const float* b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        }
+
+        inline size_t clampIndex(long long i, size_t size)
+        {
+            return (size_t)min(max(i, 0LL), (long long)size - 1);
+        }
+
+        /**
+        * Normalized gaussian weights for 2 * radius + 1 taps, like oclConvolute::gauss1D.
+        */
+        inline vector<float> gaussWeights(float sigma, int radius)
+        {
+            vector<float> weights(2 * radius + 1);
+            float total = 0.0f;
+            for(int i = -radius; i <= radius; i++)
+            {
+                weights[radius + i] = exp(-i * i / (2.0f * sigma * sigma));
+                total += weights[radius + i];
+            }
+            for(float& weight : weights)
+                weight /= total;
+            return weights;
+        }
+
+        struct RecursiveGaussianCoefficients
+        {
+            float a0, a1, a2, a3, b1, b2, coefp, coefn;
+
+            /**
+            * Same computation as oclRecursiveGaussian::setSigma.
+            */
+            RecursiveGaussianCoefficients(float sigma)
+            {
+                float alpha = 1.695f / sigma;
+                float ema = exp(-alpha);
+                float ema2 = exp(-2.0f * alpha);
+                b1 = -2.0f * ema;
+                b2 = ema2;
+
+                float k = (1.0f - ema) * (1.0f - ema) / (1.0f + (2.0f * alpha * ema) - ema2);
+                a0 = k;
+                a1 = k * (alpha - 1.0f) * ema;
+                a2 = k * (alpha + 1.0f) * ema;
+                a3 = -k * ema2;
+                coefp = (a0 + a1) / (1.0f + b1 + b2);
+                coefn = (a2 + a3) / (1.0f + b1 + b2);
+            }
+        };
+
+        /**
+        * Filters one line of count pixels, which are stride pixels apart. line is scratch space for count pixels.
+        */
+        inline void recursiveGaussianLine(const float* in, float* out, size_t count, size_t stride, const RecursiveGaussianCoefficients& k, float* line)
+        {
+            for(int c = 0; c < 4; c++)
+            {
+                // causal pass
+                float xp = in[c];
+                float yp = xp * k.coefp;
+                float yb = yp;
+                for(size_t i = 0; i < count; i++)
+                {
+                    float xc = in[i * stride * 4 + c];
+                    float yc = (xc * k.a0) + (xp * k.a1) - (yp * k.b1) - (yb * k.b2);
+                    line[i * 4 + c] = yc;
+                    xp = xc;
+                    yb = yp;
+                    yp = yc;
+                }
+
+                // anti causal pass
+                float xn = in[(count - 1) * stride * 4 + c];
+                float xa = xn;
+                float yn = xn * k.coefn;
+                float ya = yn;
+                for(long long i = (long long)count - 1; i >= 0; i--)
+                {
+                    float xc = in[i * stride * 4 + c];
+                    float yc = (xn * k.a2) + (xa * k.a3) - (yn * k.b1) - (ya * k.b2);
+                    xa = xn;
+                    xn = xc;
+                    ya = yn;
+                    yn = yc;
+                    out[i * stride * 4 + c] = line[i * 4 + c] + yc;
+                }
+            }
+        }
+
+        /**
+        * Recursive gaussian, filtering all columns and afterwards all rows like oclRecursiveGaussian.
+        */
+        inline void recursiveGaussian(const float* in, float* out, size_t width, size_t height, float sigma)
+        {
+            RecursiveGaussianCoefficients k(sigma);
+            vector<float> temp(width * height * 4);
+
+            #pragma omp parallel
+            {
+                vector<float> line(max(width, height) * 4);
+
+                #pragma omp for
+                for(int x = 0; x < (int)width; x++)
+                    recursiveGaussianLine(in + x * 4, temp.data() + x * 4, height, width, k, line.data());
+
+                #pragma omp for
+                for(int y = 0; y < (int)height; y++)
+                    recursiveGaussianLine(temp.data() + y * width * 4, out + y * width * 4, width, 1, k, line.data());
+            }
+        }
+
+        /**
+        * 3x3 sobel operator with clamp to edge addressing like oclSobel.
+        */
+        inline void sobel(const float* in, float* dx, float* dy, size_t width, size_t height)
+        {
+            const float kx[3][3] = { { -1.0f, 0.0f, 1.0f }, { -2.0f, 0.0f, 2.0f }, { -1.0f, 0.0f, 1.0f } };
+            const float ky[3][3] = { { -1.0f, -2.0f, -1.0f }, { 0.0f, 0.0f, 0.0f }, { 1.0f, 2.0f, 1.0f } };
+
+            #pragma omp parallel for
+            for(int y = 0; y < (int)height; y++)
+                for(size_t x = 0; x < width; x++)
+                {
+                    float rx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    float ry[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    for(int i = -1; i <= 1; i++)
+                        for(int j = -1; j <= 1; j++)
+                        {
+                            const float* p = in + (clampIndex(y + i, height) * width + clampIndex((long long)x + j, width)) * 4;
+                            for(int c = 0; c < 4; c++)
+                            {
+                                rx[c] += p[c] * kx[i + 1][j + 1];
+                                ry[c] += p[c] * ky[i + 1][j + 1];
+                            }
+                        }
+
+                    for(int c = 0; c < 4; c++)
+                    {
+                        dx[(y * width + x) * 4 + c] = rx[c];
+                        dy[(y * width + x) * 4 + c] = ry[c];
+                    }
+                }
+        }
+
+        /**
+        * One pass of a separable convolution along the x (axisX) or y axis with clamp to edge addressing like oclConvolute::iso2Dsep.
+        */
+        inline void convolutionPass(const float* in, float* out, size_t width, size_t height, bool axisX, const vector<float>& weights)
+        {
+            int r = (int)weights.size() / 2;
+
+            #pragma omp parallel for
+            for(int y = 0; y < (int)height; y++)
+                for(size_t x = 0; x < width; x++)
+                {
+                    float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    for(int i = -r; i <= r; i++)
+                    {
+                        size_t sx = axisX ? clampIndex((long long)x + i, width) : x;
+                        size_t sy = axisX ? y : clampIndex(y + i, height);
+                        const float* p = in + (sy * width + sx) * 4;
+                        for(int c = 0; c < 4; c++)
+                            sum[c] += p[c] * weights[i + r];
+                    }
+
+                    for(int c = 0; c < 4; c++)
+                        out[(y * width + x) * 4 + c] = sum[c];
+                }
+        }
+
+        /**
+        * Separable gaussian convolution, x axis first.
+        */
+        inline void convolution(const float* in, float* out, size_t width, size_t height, float sigma, int radius)
+        {
+            vector<float> weights = gaussWeights(sigma, radius);
+            vector<float> temp(width * height * 4);
+
+            convolutionPass(in, temp.data(), width, height, true, weights);
+            convolutionPass(temp.data(), out, width, height, false, weights);
+        }
+
+        /**
+        * Bilateral filter with the weight function of oclBilateral, the range is measured on dot(pixel, mask).
+        */
+        inline void bilateral(const float* in, float* out, size_t width, size_t height, int radius, float range, const float* mask)
+        {
+            float scalar = 0.5f / (range * range);
+
+            #pragma omp parallel for
+            for(int y = 0; y < (int)height; y++)
+                for(size_t x = 0; x < width; x++)
+                {
+                    const float* center = in + (y * width + x) * 4;
+                    float cRange = dot4(center, mask);
+
+                    float nom[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    float den = 0.0f;
+                    for(int i = -radius; i <= radius; i++)
+                        for(int j = -radius; j <= radius; j++)
+                        {
+                            const float* p = in + (clampIndex(y + i, height) * width + clampIndex((long long)x + j, width)) * 4;
+                            float sRange = dot4(p, mask);
+
+                            float r2 = scalar * (cRange - sRange);
+                            float gr = exp(-r2 * r2);
+                            float gs = exp(-sRange * sRange);
+                            float factor = gs * gr;
+
+                            for(int c = 0; c < 4; c++)
+                                nom[c] += p[c] * factor;
+                            den += factor;
+                        }
+
+                    for(int c = 0; c < 4; c++)
+                        out[(y * width + x) * 4 + c] = nom[c] / den;
+                }
+        }
+
+        /**
+        * Bilateral grid of oclBilateralGrid: splat every cell of cell x cell pixels into depth bins of dot(pixel, mask),
+        * smooth the grid along x, y and z and slice it with trilinear interpolation.
+        */
+        inline void bilateralGrid(const float* in, float* out, size_t width, size_t height, size_t cell, size_t depth, float sigma, int radius, const float* mask)
+        {
+            size_t gw = width / cell;
+            size_t gh = height / cell;
+            size_t gd = depth;
+            size_t sw = width / gw;
+            size_t sh = height / gh;
+
+            vector<float> grid(gw * gh * gd * 4, 0.0f);
+            vector<float> temp(gw * gh * gd * 4);
+
+            // splat, every cell visits its pixels in the order of clSplit
+            #pragma omp parallel for
+            for(int g = 0; g < (int)(gw * gh); g++)
+            {
+                size_t gx = g % gw;
+                size_t gy = g / gw;
+                for(size_t x = 0; x < sw; x++)
+                    for(size_t y = 0; y < sh; y++)
+                    {
+                        const float* p = in + ((y + gy * sh) * width + x + gx * sw) * 4;
+                        int z = (int)(dot4(p, mask) * (gd - 1) + 0.5f);
+                        if(z < 0 || z >= (int)gd)
+                            continue;
+
+                        float* bin = grid.data() + ((z * gh + gy) * gw + gx) * 4;
+                        bin[0] += p[0];
+                        bin[1] += p[1];
+                        bin[2] += p[2];
+                        bin[3] += 1.0f;
+                    }
+            }
+
+            // smooth, the result ends up in temp
+            vector<float> weights = gaussWeights(sigma, radius);
+            size_t extent[3] = { gw, gh, gd };
+            float* passes[4] = { grid.data(), temp.data(), grid.data(), temp.data() };
+            for(int axis = 0; axis < 3; axis++)
+            {
+                const float* src = passes[axis];
+                float* dst = passes[axis + 1];
+
+                #pragma omp parallel for
+                for(int z = 0; z < (int)gd; z++)
+                    for(size_t y = 0; y < gh; y++)
+                        for(size_t x = 0; x < gw; x++)
+                        {
+                            float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                            for(int i = -radius; i <= radius; i++)
+                            {
+                                long long pos[3] = { (long long)x, (long long)y, (long long)z };
+                                pos[axis] = clampIndex(pos[axis] + i, extent[axis]);
+                                const float* p = src + ((pos[2] * gh + pos[1]) * gw + pos[0]) * 4;
+                                for(int c = 0; c < 4; c++)
+                                    sum[c] += p[c] * weights[i + radius];
+                            }
+
+                            for(int c = 0; c < 4; c++)
+                                dst[((z * gh + y) * gw + x) * 4 + c] = sum[c];
+                        }
+            }
+
+            // slice with normalized coordinates, linear filtering and clamp addressing, so texels outside the grid are 0
+            auto fetch = [&](long long x, long long y, long long z, int c) -> float
+            {
+                if(x < 0 || y < 0 || z < 0 || x >= (long long)gw || y >= (long long)gh || z >= (long long)gd)
+                    return 0.0f;
+                return temp[((z * gh + y) * gw + x) * 4 + c];
+            };
+
+            #pragma omp parallel for
+            for(int y = 0; y < (int)height; y++)
+                for(size_t x = 0; x < width; x++)
+                {
+                    const float* p = in + (y * width + x) * 4;
+
+                    float u = (float)x / (float)width * gw - 0.5f;
+                    float v = (float)y / (float)height * gh - 0.5f;
+                    float s = dot4(p, mask) * gd - 0.5f;
+                    long long i0 = (long long)floor(u);
+                    long long j0 = (long long)floor(v);
+                    long long k0 = (long long)floor(s);
+                    float a = u - i0;
+                    float b = v - j0;
+                    float d = s - k0;
+
+                    float sample[4];
+                    for(int c = 0; c < 4; c++)
+                        sample[c] = (1 - a) * (1 - b) * (1 - d) * fetch(i0, j0, k0, c)
+                                  + a * (1 - b) * (1 - d) * fetch(i0 + 1, j0, k0, c)
+                                  + (1 - a) * b * (1 - d) * fetch(i0, j0 + 1, k0, c)
+                                  + a * b * (1 - d) * fetch(i0 + 1, j0 + 1, k0, c)
+                                  + (1 - a) * (1 - b) * d * fetch(i0, j0, k0 + 1, c)
+                                  + a * (1 - b) * d * fetch(i0 + 1, j0, k0 + 1, c)
+                                  + (1 - a) * b * d * fetch(i0, j0 + 1, k0 + 1, c)
+                                  + a * b * d * fetch(i0 + 1, j0 + 1, k0 + 1, c);
+
+                    float* o = out + (y * width + x) * 4;
+                    o[0] = sample[0] / sample[3];
+                    o[1] = sample[1] / sample[3];
+                    o[2] = sample[2] / sample[3];
+                    o[3] = 1.0f;
+                }
+        }
+
+        /**
+        * Bloom of oclBloom: keeps the pixels brighter than threshold, blurs them with a recursive gaussian and adds them scaled by the source luminance.
+        */
+        inline void bloom(const float* in, float* out, size_t width, size_t height, float threshold, float intensity, float sigma)
+        {
+            size_t pixels = width * height;
+            vector<float> bright(pixels * 4);
+            vector<float> blurred(pixels * 4);
+
+            #pragma omp parallel for
+            for(int i = 0; i < (int)pixels; i++)
+            {
+                bool keep = dot4(in + i * 4, LUMINANCE) > threshold;
+                for(int c = 0; c < 4; c++)
+                    bright[i * 4 + c] = keep ? in[i * 4 + c] : 0.0f;
+            }
+
+            recursiveGaussian(bright.data(), blurred.data(), width, height, sigma);
+
+            #pragma omp parallel for
+            for(int i = 0; i < (int)pixels; i++)
+            {
+                float scale = exp(intensity * dot4(in + i * 4, LUMINANCE));
+                for(int c = 0; c < 4; c++)
+                    out[i * 4 + c] = in[i * 4 + c] + blurred[i * 4 + c] * scale;
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../common/CPUAlgorithm.h"
+#include "../ImageAlgorithm.h"
+#include "Filters.h"
+
+namespace cpu
+{
+    /**
+    * Parallel reference implementation, also used by the ImagePlugin for verification.
+    */
+    template<typename T>
+    class RecursiveGaussian : public CPUAlgorithm<T>, public ImageAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Recursive gaussian (OpenMP)";
+            }
+
+            FilterType getFilterType() override
+            {
+                return FilterType::RecursiveGaussian;
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                cpu::filters::recursiveGaussian(data, result, ImageAlgorithm::getWidth(size), size, GAUSSIAN_SIGMA);
+            }
+
+            virtual ~RecursiveGaussian() {}
+    };
+}
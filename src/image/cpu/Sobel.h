@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../../common/CPUAlgorithm.h"
+#include "../ImageAlgorithm.h"
+#include "Filters.h"
+
+namespace cpu
+{
+    /**
+    * Parallel reference implementation, also used by the ImagePlugin for verification.
+    */
+    template<typename T>
+    class Sobel : public CPUAlgorithm<T>, public ImageAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Sobel (OpenMP)";
+            }
+
+            FilterType getFilterType() override
+            {
+                return FilterType::Sobel;
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                size_t width = ImageAlgorithm::getWidth(size);
+                cpu::filters::sobel(data, result, result + width * size * 4, width, size);
+            }
+
+            virtual ~Sobel() {}
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../../../common/libs/libCL/filter/oclBilateral.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        /**
+        * oclBilateral::iso2D, tiled through local memory in BilateralTiled.
+        */
+        template<typename T>
+        class Bilateral : public ImageFilter<T>
+        {
+            public:
+                Bilateral()
+                    : tiled(false)
+                {
+                }
+
+                const string getName() override
+                {
+                    return "Bilateral filter (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::Bilateral;
+                }
+
+                void cleanup() override
+                {
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~Bilateral() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclBilateral(*this->ctx);
+                    return program->compile() != 0;
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    cl_float4 mask = { { LUMINANCE[0], LUMINANCE[1], LUMINANCE[2], LUMINANCE[3] } };
+                    return program->iso2D(device, *this->bfSource, *this->bfDest, BILATERAL_RADIUS, BILATERAL_RANGE, mask, tiled) != 0;
+                }
+
+                oclBilateral* program;
+
+                bool tiled;
+        };
+    }
+}
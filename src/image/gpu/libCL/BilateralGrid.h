@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../../../common/libs/libCL/filter/oclBilateralGrid.h"
+#include "../../../common/libs/libCL/filter/oclConvolute.h"
+#include "../../../common/libs/libCL/oclBuffer.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        /**
+        * Splat, smooth and slice of oclBilateralGrid with a grid resolution following the image size.
+        */
+        template<typename T>
+        class BilateralGrid : public ImageFilter<T>
+        {
+            public:
+                const string getName() override
+                {
+                    return "Bilateral grid (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::BilateralGrid;
+                }
+
+                void cleanup() override
+                {
+                    delete bfFilter;
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~BilateralGrid() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclBilateralGrid(*this->ctx);
+                    if(!program->compile())
+                        return false;
+
+                    bfFilter = new oclBuffer(*this->ctx, "bfFilter");
+                    if(!bfFilter->create<cl_float>(CL_MEM_READ_ONLY, 2 * BILATERAL_GRID_RADIUS + 1))
+                        return false;
+                    return oclConvolute::gauss1D(BILATERAL_GRID_SIGMA, *bfFilter);
+                }
+
+                void allocate() override
+                {
+                    // one grid cell per BILATERAL_GRID_CELL x BILATERAL_GRID_CELL pixels
+                    program->resize((cl_uint)(this->width / BILATERAL_GRID_CELL), (cl_uint)(this->height / BILATERAL_GRID_CELL), (cl_uint)BILATERAL_GRID_DEPTH);
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    cl_float4 mask = { { LUMINANCE[0], LUMINANCE[1], LUMINANCE[2], LUMINANCE[3] } };
+                    return program->split(device, *this->bfSource, mask) && program->smoothXYZ(device, *bfFilter) && program->slice(device, *this->bfSource, mask, *this->bfDest);
+                }
+
+                oclBilateralGrid* program;
+                oclBuffer* bfFilter;
+        };
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Bilateral.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        template<typename T>
+        class BilateralTiled : public Bilateral<T>
+        {
+            public:
+                BilateralTiled()
+                {
+                    this->tiled = true;
+                }
+
+                const string getName() override
+                {
+                    return "Bilateral filter tiled (LibCL)";
+                }
+
+                virtual ~BilateralTiled() {}
+        };
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../../../common/libs/libCL/image/oclBloom.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        template<typename T>
+        class Bloom : public ImageFilter<T>
+        {
+            public:
+                const string getName() override
+                {
+                    return "Bloom (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::Bloom;
+                }
+
+                void cleanup() override
+                {
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~Bloom() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclBloom(*this->ctx);
+                    if(!program->compile())
+                        return false;
+
+                    program->setSmoothing(GAUSSIAN_SIGMA);
+                    program->setThreshold(BLOOM_THRESHOLD);
+                    program->setIntensity(BLOOM_INTENSITY);
+                    return true;
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    return program->compute(device, *this->bfSource, *this->bfDest) != 0;
+                }
+
+                oclBloom* program;
+        };
+    }
+}
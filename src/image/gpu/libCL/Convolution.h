@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../../../common/libs/libCL/filter/oclConvolute.h"
+#include "../../../common/libs/libCL/oclBuffer.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        /**
+        * Two passes of oclConvolute::iso2Dsep, tiled through local memory in ConvolutionTiled.
+        */
+        template<typename T>
+        class Convolution : public ImageFilter<T>
+        {
+            public:
+                Convolution()
+                    : tiled(false)
+                {
+                }
+
+                const string getName() override
+                {
+                    return "Separable gaussian convolution (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::Convolution;
+                }
+
+                void cleanup() override
+                {
+                    delete bfFilter;
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~Convolution() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclConvolute(*this->ctx);
+                    if(!program->compile())
+                        return false;
+
+                    bfFilter = new oclBuffer(*this->ctx, "bfFilter");
+                    if(!bfFilter->create<cl_float>(CL_MEM_READ_ONLY, 2 * CONVOLUTION_RADIUS + 1))
+                        return false;
+                    return oclConvolute::gauss1D(CONVOLUTION_SIGMA, *bfFilter);
+                }
+
+                void allocate() override
+                {
+                    bfTemp = this->createImage("bfTemp");
+                }
+
+                void release() override
+                {
+                    delete bfTemp;
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    cl_int2 axisX = { { 1, 0 } };
+                    cl_int2 axisY = { { 0, 1 } };
+                    return program->iso2Dsep(device, *this->bfSource, *bfTemp, axisX, *bfFilter, tiled) && program->iso2Dsep(device, *bfTemp, *this->bfDest, axisY, *bfFilter, tiled);
+                }
+
+                oclConvolute* program;
+                oclBuffer* bfFilter;
+                oclImage2D* bfTemp;
+
+                bool tiled;
+        };
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Convolution.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        template<typename T>
+        class ConvolutionTiled : public Convolution<T>
+        {
+            public:
+                ConvolutionTiled()
+                {
+                    this->tiled = true;
+                }
+
+                const string getName() override
+                {
+                    return "Separable gaussian convolution tiled (LibCL)";
+                }
+
+                virtual ~ConvolutionTiled() {}
+        };
+    }
+}
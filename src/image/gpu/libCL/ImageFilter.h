@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../../../common/libs/libCL/oclContext.h"
+#include "../../../common/libs/libCL/oclImage2D.h"
+
+#include "../../../common/CLAlgorithm.h"
+#include "../../ImageAlgorithm.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        /**
+        * Base of the libCL filters. Uploads the input into an RGBA float image and reads the filtered image back.
+        * libCL works on the context of the runner, but its device uses an own command queue, so run waits for it.
+        */
+        template<typename T>
+        class ImageFilter : public CLAlgorithm<T>, public ImageAlgorithm
+        {
+            public:
+                void init() override
+                {
+                    oclInit("../common/libs/libCL");
+
+                    ctx = new oclContext(this->context->getCLContext(), oclContext::VENDOR_UNKNOWN);
+
+                    if(!compile())
+                        throw OpenCLException("compilation failed!");
+                }
+
+                void upload(size_t workGroupSize, T* data, size_t size) override
+                {
+                    width = getWidth(size);
+                    height = size;
+
+                    cl_image_format format = { CL_RGBA, CL_FLOAT };
+                    bfSource = new oclImage2D(*ctx, "bfSource");
+                    if(!bfSource->create(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, format, width, height, data))
+                        throw OpenCLException("creating the source image failed!");
+
+                    bfDest = createImage("bfDest");
+                    allocate();
+                }
+
+                void run(size_t workGroupSize, size_t size) override
+                {
+                    if(!compute(ctx->getDevice(0)))
+                        throw OpenCLException("filter failed!");
+
+                    clFinish(ctx->getDevice(0));
+                }
+
+                void download(T* result, size_t size) override
+                {
+                    readImage(*bfDest, result);
+
+                    release();
+                    delete bfSource;
+                    delete bfDest;
+                }
+
+                void cleanup() override
+                {
+                    delete ctx;
+                }
+
+                virtual ~ImageFilter() {}
+
+            protected:
+                virtual bool compile() = 0;
+                virtual bool compute(oclDevice& device) = 0;
+
+                /**
+                * Creates and releases the temporary images of a filter for the current size.
+                */
+                virtual void allocate() {}
+                virtual void release() {}
+
+                oclImage2D* createImage(char* name)
+                {
+                    cl_image_format format = { CL_RGBA, CL_FLOAT };
+                    oclImage2D* image = new oclImage2D(*ctx, name);
+                    if(!image->create(CL_MEM_READ_WRITE, format, width, height))
+                    {
+                        delete image;
+                        throw OpenCLException("creating an image failed!");
+                    }
+                    return image;
+                }
+
+                void readImage(oclImage2D& image, T* result)
+                {
+                    size_t origin[3] = { 0, 0, 0 };
+                    size_t region[3] = { width, height, 1 };
+                    if(clEnqueueReadImage(ctx->getDevice(0), image, CL_TRUE, origin, region, 0, 0, result, 0, 0, 0) != CL_SUCCESS)
+                        throw OpenCLException("reading the image failed!");
+                }
+
+                oclContext* ctx;
+                oclImage2D* bfSource;
+                oclImage2D* bfDest;
+
+                size_t width;
+                size_t height;
+        };
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../../../common/libs/libCL/filter/oclRecursiveGaussian.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        template<typename T>
+        class RecursiveGaussian : public ImageFilter<T>
+        {
+            public:
+                const string getName() override
+                {
+                    return "Recursive gaussian (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::RecursiveGaussian;
+                }
+
+                void cleanup() override
+                {
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~RecursiveGaussian() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclRecursiveGaussian(*this->ctx);
+                    if(!program->compile())
+                        return false;
+
+                    program->setSigma(GAUSSIAN_SIGMA);
+                    return true;
+                }
+
+                void allocate() override
+                {
+                    bfTemp = this->createImage("bfTemp");
+                }
+
+                void release() override
+                {
+                    delete bfTemp;
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    return program->compute(device, *this->bfSource, *bfTemp, *this->bfDest) != 0;
+                }
+
+                oclRecursiveGaussian* program;
+                oclImage2D* bfTemp;
+        };
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../../../common/libs/libCL/filter/oclSobel.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        template<typename T>
+        class Sobel : public ImageFilter<T>
+        {
+            public:
+                const string getName() override
+                {
+                    return "Sobel (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::Sobel;
+                }
+
+                void download(T* result, size_t size) override
+                {
+                    // dy follows dx
+                    this->readImage(*bfDestY, result + this->width * this->height * 4);
+                    ImageFilter<T>::download(result, size);
+                }
+
+                void cleanup() override
+                {
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~Sobel() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclSobel(*this->ctx);
+                    return program->compile() != 0;
+                }
+
+                void allocate() override
+                {
+                    bfDestY = this->createImage("bfDestY");
+                }
+
+                void release() override
+                {
+                    delete bfDestY;
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    return program->compute(device, *this->bfSource, *this->bfDest, *bfDestY) != 0;
+                }
+
+                oclSobel* program;
+                oclImage2D* bfDestY;
+        };
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../../../common/libs/libCL/image/oclToneMapping.h"
+
+#include "ImageFilter.h"
+
+namespace gpu
+{
+    namespace libcl
+    {
+        template<typename T>
+        class ToneMapping : public ImageFilter<T>
+        {
+            public:
+                const string getName() override
+                {
+                    return "Tone mapping (LibCL)";
+                }
+
+                FilterType getFilterType() override
+                {
+                    return FilterType::ToneMapping;
+                }
+
+                void cleanup() override
+                {
+                    delete program;
+                    ImageFilter<T>::cleanup();
+                }
+
+                virtual ~ToneMapping() {}
+
+            protected:
+                bool compile() override
+                {
+                    program = new oclToneMapping(*this->ctx);
+                    return program->compile() != 0;
+                }
+
+                bool compute(oclDevice& device) override
+                {
+                    return program->compute(device, *this->bfSource, *this->bfDest) != 0;
+                }
+
+                oclToneMapping* program;
+        };
+    }
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <fstream>
+#include <array>
+
+#include "../common/Runner.h"
+#include "ImagePlugin.h"
+
+#include "cpu/RecursiveGaussian.h"
+#include "cpu/Sobel.h"
+#include "cpu/Convolution.h"
+#include "cpu/Bilateral.h"
+#include "cpu/BilateralGrid.h"
+#include "cpu/Bloom.h"
+
+#include "gpu/libCL/RecursiveGaussian.h"
+#include "gpu/libCL/Sobel.h"
+#include "gpu/libCL/Convolution.h"
+#include "gpu/libCL/ConvolutionTiled.h"
+#include "gpu/libCL/Bilateral.h"
+#include "gpu/libCL/BilateralTiled.h"
+#include "gpu/libCL/BilateralGrid.h"
+#include "gpu/libCL/ToneMapping.h"
+#include "gpu/libCL/Bloom.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // image heights from 720p to 8K UHD, the widths follow from 16:9
+        array<size_t, 6> sizes = { 720, 1080, 1440, 2160, 2880, 4320 };
+
+        Runner<float, ImagePlugin> runner(3, sizes.begin(), sizes.end());
+
+        //runner.writeGPUDeviceInfo("gpuinfo.csv");
+
+        vector<FilterType> filters = { FilterType::RecursiveGaussian, FilterType::Sobel, FilterType::Convolution, FilterType::Bilateral, FilterType::BilateralGrid, FilterType::ToneMapping, FilterType::Bloom };
+
+        // every filter is written to its own stats file
+        for(FilterType filter : filters)
+        {
+            runner.getPlugin()->setFilter(filter);
+            runner.getPlugin()->setPattern(filter == FilterType::ToneMapping ? ImagePattern::HighDynamicRange : ImagePattern::Blocks);
+
+            string name = filterTypeToString(filter);
+            replace(name.begin(), name.end(), ' ', '_');
+            runner.start("stats_" + name + ".csv");
+
+            switch(filter)
+            {
+            case FilterType::RecursiveGaussian:
+                runner.run<cpu::RecursiveGaussian>();
+                runner.run<gpu::libcl::RecursiveGaussian>(CLRunType::GPU);
+                break;
+            case FilterType::Sobel:
+                runner.run<cpu::Sobel>();
+                runner.run<gpu::libcl::Sobel>(CLRunType::GPU);
+                break;
+            case FilterType::Convolution:
+                runner.run<cpu::Convolution>();
+                runner.run<gpu::libcl::Convolution>(CLRunType::GPU);
+                runner.run<gpu::libcl::ConvolutionTiled>(CLRunType::GPU);
+                break;
+            case FilterType::Bilateral:
+                runner.run<cpu::Bilateral>();
+                runner.run<gpu::libcl::Bilateral>(CLRunType::GPU);
+                runner.run<gpu::libcl::BilateralTiled>(CLRunType::GPU);
+                break;
+            case FilterType::BilateralGrid:
+                runner.run<cpu::BilateralGrid>();
+                runner.run<gpu::libcl::BilateralGrid>(CLRunType::GPU);
+                break;
+            case FilterType::ToneMapping:
+                runner.run<gpu::libcl::ToneMapping>(CLRunType::GPU);
+                break;
+            case FilterType::Bloom:
+                runner.run<cpu::Bloom>();
+                runner.run<gpu::libcl::Bloom>(CLRunType::GPU);
+                break;
+            }
+
+            runner.finish();
+        }
+    }
+    catch(const exception& e)
+    {
+        cerr << e.what() << endl;
+    }
+
+    getchar();
+
+    return 0;
+}
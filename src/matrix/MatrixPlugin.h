@@ -2,9 +2,15 @@
 
 #include <stdlib.h>
 #include <sstream>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cmath>
 
 #include "MatrixAlgorithm.h"
 
+//#define FULL_VERIFY
+
 using namespace std;
 
 template <typename T>
@@ -13,6 +19,20 @@ class MatrixPlugin
     public:
         typedef MatrixAlgorithm AlgorithmType;
 
+        MatrixPlugin()
+            : dataset(nullptr)
+        {
+        }
+
+        /**
+        * Uses the elements of the given dataset as input instead of generating them.
+        * The data is accessed directly inside the memory mapping. The dataset is not owned by the plugin.
+        */
+        void setDataset(Dataset* dataset)
+        {
+            this->dataset = dataset;
+        }
+
         const string getTaskDescription(size_t size)
         {
             //return "Processing " << size << " elements of type " << getTypeName<T>() << " (" << sizeToString(size * sizeof(T)) << ")";
@@ -21,15 +41,39 @@ class MatrixPlugin
             return ss.str();
         }
 
+        size_t getInputLength(size_t size)
+        {
+            return size * size * 2; // two size x size matrixes
+        }
+
+        /**
+        * The matrix multiplications only read the two input matrixes.
+        */
+        bool isInputReadOnly()
+        {
+            return true;
+        }
+
         T* genInput(size_t size)
         {
-            size_t bufferSize = size * size * 2;
+            if(dataset)
+            {
+                if(dataset->getDimensions() != 3 || dataset->getShape(0) != 2 || dataset->getShape(1) != size || dataset->getShape(2) != size)
+                {
+                    stringstream ss;
+                    ss << "Dataset does not contain two " << size << "x" << size << " matrixes";
+                    throw runtime_error(ss.str());
+                }
+                return dataset->getData<T>(getInputLength(size));
+            }
+
+            size_t bufferSize = getInputLength(size);
 
-            T* data = new T[bufferSize]; // two size x size matrixes
+            T* data = new T[bufferSize];
 
-            generate(data, data + bufferSize, []() -> T
+            fillRandom(data, bufferSize, SEED, [](uint64_t random) -> T
             {
-                return (T) (rand() % 100);
+                return (T) (random % 100);
             });
 
             return data;
@@ -42,7 +86,8 @@ class MatrixPlugin
 
         void freeInput(T* data)
         {
-            delete[] data;
+            if(!dataset)
+                delete[] data;
         }
 
         void freeResult(T* result)
@@ -52,41 +97,150 @@ class MatrixPlugin
 
         bool verifyResult(MatrixAlgorithm* alg, T* data, T* result, size_t size)
         {
-            T* a = (T*)data;
+#ifdef FULL_VERIFY
+            return verifyFull(data, result, size);
+#else
+            return verifyFreivalds(data, result, size);
+#endif
+        }
+
+    private:
+        static const size_t VERIFY_ROUNDS = 8;
+        static const size_t VERIFY_BLOCK_SIZE = 64;
+        static const uint64_t SEED = 0;
+
+        /**
+        * Freivalds' algorithm. Checks A * (B * r) == C * r for VERIFY_ROUNDS random 0/1 vectors r.
+        * Each round costs O(n^2) and lets a wrong product slip through with a probability of at most 1/2.
+        */
+        bool verifyFreivalds(T* data, T* result, size_t size)
+        {
+            T* a = data;
             T* b = a + size * size;
-            T* c = (T*) result;
+            T* c = result;
 
-            bool success = true;
+            vector<T> r(size);
+            vector<T> br(size);
+            vector<T> brAbs(size);
 
-            #pragma omp parallel for
-            for(int i = 0; i < size; i++)
+            for(size_t round = 0; round < VERIFY_ROUNDS; round++)
             {
-                if(success)
+                uniform_int_distribution<int> dist(0, 1);
+                for(size_t i = 0; i < size; i++)
+                    r[i] = (T)dist(generator);
+
+                // br = B * r, brAbs = |B| * r
+                #pragma omp parallel for
+                for(int i = 0; i < (int)size; i++)
+                {
+                    T sum = 0;
+                    T sumAbs = 0;
+                    for(size_t j = 0; j < size; j++)
+                    {
+                        sum += b[i * size + j] * r[j];
+                        sumAbs += abs(b[i * size + j]) * r[j];
+                    }
+                    br[i] = sum;
+                    brAbs[i] = sumAbs;
+                }
+
+                // compare A * br against C * r, using |A| * brAbs as magnitude for the tolerance
+                bool success = true;
+
+                #pragma omp parallel for
+                for(int i = 0; i < (int)size; i++)
+                {
+                    T abr = 0;
+                    T abrAbs = 0;
+                    T cr = 0;
                     for(size_t j = 0; j < size; j++)
                     {
-                        T sum = 0;
-                        for(size_t k = 0; k < size; k++)
-                            sum += a[i * size + k] * b[k * size + j];
-                        if(!compare(c[i * size + j], sum))
-                        {
-                            success = false;
-                            //cout << "Value " << c[i * size + j] << " vs " << sum << endl;
-                        }
+                        abr += a[i * size + j] * br[j];
+                        abrAbs += abs(a[i * size + j]) * brAbs[j];
+                        cr += c[i * size + j] * r[j];
                     }
+                    if(!compare(cr, abr, abrAbs, size))
+                        success = false;
+                }
+
+                if(!success)
+                    return false;
             }
 
+            return true;
+        }
+
+        /**
+        * Exact reference using a blocked product parallelized over row blocks.
+        */
+        bool verifyFull(T* data, T* result, size_t size)
+        {
+            T* a = data;
+            T* b = a + size * size;
+            T* c = result;
+
+            vector<T> ref(size * size, 0);
+            vector<T> refAbs(size * size, 0);
+
+            int blocks = (int)((size + VERIFY_BLOCK_SIZE - 1) / VERIFY_BLOCK_SIZE);
+
+            #pragma omp parallel for
+            for(int ib = 0; ib < blocks; ib++)
+            {
+                size_t iEnd = min((ib + 1) * VERIFY_BLOCK_SIZE, size);
+                for(size_t kb = 0; kb < size; kb += VERIFY_BLOCK_SIZE)
+                {
+                    size_t kEnd = min(kb + VERIFY_BLOCK_SIZE, size);
+                    for(size_t jb = 0; jb < size; jb += VERIFY_BLOCK_SIZE)
+                    {
+                        size_t jEnd = min(jb + VERIFY_BLOCK_SIZE, size);
+                        for(size_t i = ib * VERIFY_BLOCK_SIZE; i < iEnd; i++)
+                            for(size_t k = kb; k < kEnd; k++)
+                            {
+                                T aik = a[i * size + k];
+                                for(size_t j = jb; j < jEnd; j++)
+                                {
+                                    ref[i * size + j] += aik * b[k * size + j];
+                                    refAbs[i * size + j] += abs(aik) * abs(b[k * size + j]);
+                                }
+                            }
+                    }
+                }
+            }
+
+            bool success = true;
+
+            #pragma omp parallel for
+            for(int i = 0; i < (int)size; i++)
+                for(size_t j = 0; j < size; j++)
+                    if(!compare(c[i * size + j], ref[i * size + j], refAbs[i * size + j], size))
+                        success = false;
+
             return success;
         }
 
-    private:
-        inline bool compare(T a, T b)
+        /**
+        * Compares a computed value against the reference.
+        * magnitude is the sum of absolute values of all summed products and bounds the rounding error.
+        */
+        inline bool compare(T a, T b, T magnitude, size_t n)
         {
             return a == b;
         }
+
+        default_random_engine generator;
+
+        Dataset* dataset;
 };
 
 template<>
-inline bool MatrixPlugin<float>::compare(float a, float b)
+inline bool MatrixPlugin<float>::compare(float a, float b, float magnitude, size_t n)
+{
+    return fabs(a - b) <= 2.0f * n * numeric_limits<float>::epsilon() * magnitude + 0.001f;
+}
+
+template<>
+inline bool MatrixPlugin<double>::compare(double a, double b, double magnitude, size_t n)
 {
-    return fabs(a - b) < 0.001;
+    return fabs(a - b) <= 2.0 * n * numeric_limits<double>::epsilon() * magnitude + 0.001;
 }
@@ -34,14 +34,28 @@
 
 using namespace std;
 
-int main()
-{ 
+int main(int argc, char* argv[])
+{
+    Dataset* dataset = nullptr;
+    int exitCode = 0;
+
     try
     {
         //vector<size_t> sizes = { 1, 25, 50, 75, 100, 200, 300, 400, 500, 600, 700, 800, 900, 1000, 1100, 1200, 1300, 1400, 1500, 1600, 1700, 1800, 1900, 2000, 2100, 2200, 2300, 2400, 2500, 2600, 2700, 2800, 2900, 3000, 3100, 3200, 3300, 3400, 3500, 3600, 3700, 3800, 3900, 4000 };
         array<size_t, 44> sizes = { 1, 25, 50, 75, 100, 200, 300, 400, 500, 600, 700, 800, 900, 1000, 1100, 1200, 1300, 1400, 1500, 1600, 1700, 1800, 1900, 2000, 2100, 2200, 2300, 2400, 2500, 2600, 2700, 2800, 2900, 3000, 3100, 3200, 3300, 3400, 3500, 3600, 3700, 3800, 3900, 4000 };
 
-        Runner<float, MatrixPlugin> runner(3, sizes.begin(), sizes.end(), false);
+        // an optional dataset file given on the command line replaces the generated input
+        // it contains the two size x size input matrixes, its shape is { 2, size, size }
+        if(argc > 1)
+        {
+            dataset = new Dataset(argv[1]);
+            sizes.fill((size_t)dataset->getShape(1));
+        }
+
+        Runner<float, MatrixPlugin> runner(3, sizes.begin(), dataset ? sizes.begin() + 1 : sizes.end());
+
+        if(dataset)
+            runner.getPlugin()->setDataset(dataset);
 
         //runner.writeGPUDeviceInfo("gpuinfo.csv");
 
@@ -82,9 +96,12 @@ int main()
     catch(const exception& e)
     {
         cerr << e.what() << endl;
+        exitCode = 1;
     }
 
+    delete dataset;
+
     getchar();
 
-    return 0;
+    return exitCode;
 }
@@ -1,6 +1,6 @@
 #ifndef MESHTRANSFORMPLUGIN_H
 #define MESHTRANSFORMPLUGIN_H
-
+
 #include <string.h>
 #include <sstream>
 
@@ -16,6 +16,20 @@ class MeshTransformPlugin
 
         static const size_t MATRIX_SIZE = MeshTransformAlgorithm::MATRIX_SIZE;
 
+        MeshTransformPlugin()
+            : dataset(nullptr)
+        {
+        }
+
+        /**
+        * Uses the elements of the given dataset as input instead of generating them.
+        * The data is accessed directly inside the memory mapping. The dataset is not owned by the plugin.
+        */
+        void setDataset(Dataset* dataset)
+        {
+            this->dataset = dataset;
+        }
+
         const string getTaskDescription(size_t size)
         {
             stringstream ss;
@@ -23,9 +37,17 @@ class MeshTransformPlugin
             return ss.str();
         }
 
+        size_t getInputLength(size_t size)
+        {
+            return MATRIX_SIZE + size * 3;
+        }
+
         T* genInput(size_t size)
         {
-            T* data = new T[MATRIX_SIZE + size * 3];
+            if(dataset)
+                return dataset->getData<T>(getInputLength(size));
+
+            T* data = new T[getInputLength(size)];
 
             /*T matrix[] = {1, 0, 0, 0,
                           0, 1, 0, 0,
@@ -34,9 +56,9 @@ class MeshTransformPlugin
 
             memcpy(data, matrix, MATRIX_SIZE * sizeof(T));*/
 
-            generate(data, data + MATRIX_SIZE + size * 3, []()
+            fillRandom(data, getInputLength(size), 0, [](uint64_t random) -> T
             {
-                return rand() % 10;
+                return (T)(random % 10);
             });
 
             return data;
@@ -49,7 +71,8 @@ class MeshTransformPlugin
 
         void freeInput(T* data)
         {
-            delete[] (T*)data;
+            if(!dataset)
+                delete[] (T*)data;
         }
 
         void freeResult(T* result)
@@ -80,6 +103,9 @@ class MeshTransformPlugin
             r[1] = m[4] * v[0] + m[5] * v[1] + m[6] * v[2] + m[7];
             r[2] = m[8] * v[0] + m[9] * v[1] + m[10] * v[2] + m[11];
         }
+
+    private:
+        Dataset* dataset;
 };
 
 #endif // MESHTRANSFORMPLUGIN_H
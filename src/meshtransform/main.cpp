@@ -12,11 +12,25 @@
 
 using namespace std;
 
-int main()
+int main(int argc, char* argv[])
 {
+    Dataset* dataset = nullptr;
+
     try
     {
-        Runner<float, MeshTransformPlugin> runner(3, { 1<<18, 1<<19, 1<<20, 1<<21, 1<<22, 1<<23, 1<<24, 1<<25 });
+        vector<size_t> sizes = { 1<<18, 1<<19, 1<<20, 1<<21, 1<<22, 1<<23, 1<<24, 1<<25 };
+
+        // an optional dataset file given on the command line replaces the generated input, see objconvert
+        if(argc > 1)
+        {
+            dataset = new Dataset(argv[1]);
+            sizes.assign(1, (size_t)dataset->getShape(0));
+        }
+
+        Runner<float, MeshTransformPlugin> runner(3, sizes.begin(), sizes.end());
+
+        if(dataset)
+            runner.getPlugin()->setDataset(dataset);
 
         runner.run<cpu::dixxi::Transform>(RunType::CPU);
         runner.run<cpu::dixxi::TransformMulti>(RunType::CPU);
@@ -27,11 +41,14 @@ int main()
         runner.writeStats("stats.csv");
         runner.writeGPUDeviceInfo("gpuinfo.csv");
     }
-    catch(OpenCLException& e)
+    catch(const exception& e)
     {
         cerr << e.what() << endl;
+        delete dataset;
         return 1;
     }
 
+    delete dataset;
+
     return 0;
 }
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+
+#include "../common/Dataset.h"
+
+using namespace std;
+
+static const size_t MATRIX_SIZE = 16;
+
+/**
+* Converts the vertices of a Wavefront OBJ file (like meshtransform/meshes/heart.obj) into a dataset for the meshtransform runner.
+* The dataset contains a 4x4 identity transformation matrix followed by the x, y, z coordinates of all vertices.
+* Its shape is { vertices, 3 }.
+*/
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " <input.obj> <output.bin>" << endl;
+        return 1;
+    }
+
+    try
+    {
+        ifstream obj(argv[1]);
+        if(!obj)
+            throw runtime_error(string("Failed to open ") + argv[1]);
+
+        vector<float> data = { 1, 0, 0, 0,
+                               0, 1, 0, 0,
+                               0, 0, 1, 0,
+                               0, 0, 0, 1 };
+
+        string line;
+        while(getline(obj, line))
+        {
+            // only vertex positions are needed, normals (vn), texture coordinates (vt) and faces are skipped
+            if(line.size() < 2 || line[0] != 'v' || line[1] != ' ')
+                continue;
+
+            stringstream ss(line.substr(2));
+            float x, y, z;
+            if(!(ss >> x >> y >> z))
+                throw runtime_error("Invalid vertex: " + line);
+
+            data.push_back(x);
+            data.push_back(y);
+            data.push_back(z);
+        }
+
+        size_t vertices = (data.size() - MATRIX_SIZE) / 3;
+
+        Dataset::write(argv[2], ElementType::Float, data.data(), data.size(), { vertices, 3 });
+
+        cout << "Wrote " << vertices << " vertices to " << argv[2] << endl;
+    }
+    catch(const exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
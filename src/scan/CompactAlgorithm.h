@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+* Base of the algorithms benchmarked by the CompactPlugin.
+* The input holds the threshold followed by the elements, an element is kept when it is smaller than the threshold.
+* The result holds the number of kept elements followed by the partitioned elements, the kept ones first. The compaction is the first part.
+*/
+class CompactAlgorithm
+{
+    public:
+        virtual ~CompactAlgorithm() {}
+
+        /**
+        * A stable algorithm keeps the input order in both parts of the result.
+        */
+        virtual bool isStable()
+        {
+            return true;
+        }
+
+        template <typename T>
+        static T getThreshold(const T* data)
+        {
+            return data[0];
+        }
+
+        template <typename T>
+        static T* getElements(T* data)
+        {
+            return data + 1;
+        }
+
+        template <typename T>
+        static size_t getCount(const T* result)
+        {
+            return (size_t)result[0];
+        }
+
+        template <typename T>
+        static T* getPartition(T* result)
+        {
+            return result + 1;
+        }
+};
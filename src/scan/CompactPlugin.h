@@ -0,0 +1,189 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include "CompactAlgorithm.h"
+
+using namespace std;
+
+/**
+* Stream compaction and partition of elements by a threshold. The problem size is the number of elements, see CompactAlgorithm for the input and result layout.
+*/
+template <typename T>
+class CompactPlugin
+{
+public:
+    typedef CompactAlgorithm AlgorithmType;
+
+    CompactPlugin()
+        : selectivity(0.5)
+    {
+    }
+
+    /**
+    * Sets the fraction of the elements which are kept, between 0 and 1.
+    */
+    void setSelectivity(double selectivity)
+    {
+        this->selectivity = min(max(selectivity, 0.0), 1.0);
+    }
+
+    double getSelectivity()
+    {
+        return selectivity;
+    }
+
+    const string getTaskDescription(size_t size)
+    {
+        stringstream ss;
+        ss << "Compacting " << size << " elements of type " << getTypeName<T>() << " keeping " << selectivity * 100 << "% (" << sizeToString(size * sizeof(T)) << ")";
+        return ss.str();
+    }
+
+    /**
+    * Million elements per call, the writers report MElem/s.
+    */
+    double getWorkload(size_t size)
+    {
+        return size / 1e6;
+    }
+
+    const string getThroughputUnit()
+    {
+        return "MElem/s";
+    }
+
+    size_t getInputLength(size_t size)
+    {
+        return 1 + size;
+    }
+
+    T* genInput(size_t size)
+    {
+        T* data = new T[getInputLength(size)];
+
+        // the elements are uniformly distributed, so the threshold keeps the selectivity of them
+        data[0] = (T)min(selectivity * 4294967296.0, 4294967295.0);
+
+        fillRandom(CompactAlgorithm::getElements(data), size, SEED, [](uint64_t random) -> T
+        {
+            return (T)random;
+        });
+
+        return data;
+    }
+
+    T* genResult(size_t size)
+    {
+        return new T[1 + size];
+    }
+
+    void freeInput(T* data)
+    {
+        delete[] data;
+    }
+
+    void freeResult(T* result)
+    {
+        delete[] result;
+    }
+
+    /**
+    * The result has to hold the kept elements followed by the others. A stable algorithm has to keep the input order in both parts,
+    * for the others both parts only have to be permutations of the expected ones.
+    */
+    bool verifyResult(CompactAlgorithm* alg, T* data, T* result, size_t size)
+    {
+        T threshold = CompactAlgorithm::getThreshold(data);
+        const T* elements = CompactAlgorithm::getElements(data);
+        const T* partition = CompactAlgorithm::getPartition(result);
+
+        // count the kept elements per chunk, the exclusive scan of the counts gives the position of every chunk in the kept part
+        int chunks = (int)((size + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+        vector<size_t> keptBefore(chunks + 1, 0);
+
+        #pragma omp parallel for
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t begin = c * VERIFY_CHUNK_SIZE;
+            size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+            size_t kept = 0;
+            for(size_t i = begin; i < end; i++)
+                kept += elements[i] < threshold;
+            keptBefore[c + 1] = kept;
+        }
+
+        for(int c = 0; c < chunks; c++)
+            keptBefore[c + 1] += keptBefore[c];
+
+        size_t count = keptBefore[chunks];
+        if(CompactAlgorithm::getCount(result) != count)
+            return false;
+
+        bool success = true;
+
+        if(alg->isStable())
+        {
+            #pragma omp parallel for reduction(&&:success)
+            for(int c = 0; c < chunks; c++)
+            {
+                size_t begin = c * VERIFY_CHUNK_SIZE;
+                size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+                size_t kept = keptBefore[c];
+                size_t rejected = count + begin - keptBefore[c];
+                size_t errors = 0;
+                for(size_t i = begin; i < end; i++)
+                {
+                    if(elements[i] < threshold)
+                        errors += partition[kept++] != elements[i];
+                    else
+                        errors += partition[rejected++] != elements[i];
+                }
+
+                success = success && errors == 0;
+            }
+        }
+        else
+        {
+            // both parts have to hold the right elements and the result has to be a permutation of the input, compared by hash sums
+            uint64_t sum = 0, xorSum = 0;
+
+            #pragma omp parallel for reduction(&&:success) reduction(+:sum) reduction(^:xorSum)
+            for(int c = 0; c < chunks; c++)
+            {
+                size_t begin = c * VERIFY_CHUNK_SIZE;
+                size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+                size_t errors = 0;
+                for(size_t i = begin; i < end; i++)
+                {
+                    errors += (partition[i] < threshold) != (i < count);
+
+                    uint64_t h = randomAt(0, elements[i]);
+                    sum += h;
+                    xorSum ^= h;
+
+                    h = randomAt(0, partition[i]);
+                    sum -= h;
+                    xorSum ^= h;
+                }
+
+                success = success && errors == 0;
+            }
+
+            success = success && sum == 0 && xorSum == 0;
+        }
+
+        return success;
+    }
+
+private:
+    static const size_t VERIFY_CHUNK_SIZE = 1 << 16;
+    static const uint64_t SEED = 0;
+
+    double selectivity;
+};
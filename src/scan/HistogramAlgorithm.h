@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+* Base of the algorithms benchmarked by the HistogramPlugin.
+* The input holds the number of bins followed by the values, every value is the index of its bin and smaller than the number of bins.
+* The result holds the number of values in every bin.
+*/
+class HistogramAlgorithm
+{
+    public:
+        virtual ~HistogramAlgorithm() {}
+
+        template <typename T>
+        static size_t getBinCount(const T* data)
+        {
+            return (size_t)data[0];
+        }
+
+        template <typename T>
+        static T* getValues(T* data)
+        {
+            return data + 1;
+        }
+};
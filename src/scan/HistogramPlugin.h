@@ -0,0 +1,174 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "HistogramAlgorithm.h"
+
+using namespace std;
+
+/**
+* Distributions of the values generated by the HistogramPlugin.
+*/
+enum class HistogramDistribution
+{
+    Uniform, // every bin is equally likely
+    Skewed   // the bin is bins * u^8 for a uniform u in [0, 1), from 70% (16 bins) to 25% (64K bins) of the values fall into the first bin
+};
+
+inline const string histogramDistributionToString(HistogramDistribution distribution)
+{
+    switch(distribution)
+    {
+    case HistogramDistribution::Uniform: return "uniform";
+    case HistogramDistribution::Skewed:  return "skewed";
+    }
+    return "unknown";
+}
+
+/**
+* Counting values into bins. The problem size is the number of values, see HistogramAlgorithm for the input and result layout.
+*/
+template <typename T>
+class HistogramPlugin
+{
+public:
+    typedef HistogramAlgorithm AlgorithmType;
+
+    HistogramPlugin()
+        : binCount(256), distribution(HistogramDistribution::Uniform)
+    {
+    }
+
+    /**
+    * Sets the number of bins, at least one.
+    */
+    void setBinCount(size_t binCount)
+    {
+        this->binCount = max(binCount, (size_t)1);
+    }
+
+    size_t getBinCount()
+    {
+        return binCount;
+    }
+
+    /**
+    * Sets the distribution of the values over the bins.
+    */
+    void setDistribution(HistogramDistribution distribution)
+    {
+        this->distribution = distribution;
+    }
+
+    HistogramDistribution getDistribution()
+    {
+        return distribution;
+    }
+
+    const string getTaskDescription(size_t size)
+    {
+        stringstream ss;
+        ss << "Histogram of " << size << " elements of type " << getTypeName<T>() << " into " << binCount << " bins (" << histogramDistributionToString(distribution) << ", " << sizeToString(size * sizeof(T)) << ")";
+        return ss.str();
+    }
+
+    /**
+    * Million elements per call, the writers report MElem/s.
+    */
+    double getWorkload(size_t size)
+    {
+        return size / 1e6;
+    }
+
+    const string getThroughputUnit()
+    {
+        return "MElem/s";
+    }
+
+    size_t getInputLength(size_t size)
+    {
+        return 1 + size;
+    }
+
+    T* genInput(size_t size)
+    {
+        T* data = new T[getInputLength(size)];
+
+        data[0] = (T)binCount;
+
+        size_t bins = binCount;
+        HistogramDistribution distribution = this->distribution;
+        fillRandom(HistogramAlgorithm::getValues(data), size, SEED, [bins, distribution](uint64_t random) -> T
+        {
+            if(distribution == HistogramDistribution::Skewed)
+                return (T)min((size_t)(bins * pow(randomToUnit(random), 8.0)), bins - 1);
+            return (T)(random % bins);
+        });
+
+        return data;
+    }
+
+    T* genResult(size_t size)
+    {
+        return new T[binCount];
+    }
+
+    void freeInput(T* data)
+    {
+        delete[] data;
+    }
+
+    void freeResult(T* result)
+    {
+        delete[] result;
+    }
+
+    /**
+    * Every bin has to match a count on the host. Every chunk of values is counted on its own, the chunk histograms are added bin by bin.
+    */
+    bool verifyResult(HistogramAlgorithm* alg, T* data, T* result, size_t size)
+    {
+        int bins = (int)HistogramAlgorithm::getBinCount(data);
+        const T* values = HistogramAlgorithm::getValues(data);
+
+        // limit the number of chunk histograms for large bin counts
+        size_t chunkSize = max((size_t)VERIFY_CHUNK_SIZE, (size + MAX_VERIFY_CHUNKS - 1) / MAX_VERIFY_CHUNKS);
+        int chunks = (int)((size + chunkSize - 1) / chunkSize);
+        vector<size_t> histograms((size_t)chunks * bins, 0);
+
+        #pragma omp parallel for
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t begin = c * chunkSize;
+            size_t end = min(begin + chunkSize, size);
+
+            size_t* histogram = &histograms[(size_t)c * bins];
+            for(size_t i = begin; i < end; i++)
+                histogram[values[i]]++;
+        }
+
+        size_t violations = 0;
+
+        #pragma omp parallel for reduction(+:violations)
+        for(int b = 0; b < bins; b++)
+        {
+            size_t count = 0;
+            for(int c = 0; c < chunks; c++)
+                count += histograms[(size_t)c * bins + b];
+            violations += result[b] != count;
+        }
+
+        return violations == 0;
+    }
+
+private:
+    static const size_t VERIFY_CHUNK_SIZE = 1 << 16;
+    static const size_t MAX_VERIFY_CHUNKS = 64;
+    static const uint64_t SEED = 0;
+
+    size_t binCount;
+    HistogramDistribution distribution;
+};
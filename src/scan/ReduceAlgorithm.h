@@ -0,0 +1,73 @@
+#pragma once
+
+#include <CL/cl.h>
+#include <string>
+
+#include "ScanOperator.h"
+
+using namespace std;
+
+/**
+* Operators of the reductions. ArgMax finds the maximum and its first index.
+*/
+enum class ReduceOperator
+{
+    Sum,
+    Min,
+    Max,
+    ArgMax
+};
+
+inline const string reduceOperatorToString(ReduceOperator op)
+{
+    switch(op)
+    {
+    case ReduceOperator::Sum:    return "sum";
+    case ReduceOperator::Min:    return "min";
+    case ReduceOperator::Max:    return "max";
+    case ReduceOperator::ArgMax: return "argmax";
+    }
+    return "unknown";
+}
+
+/**
+* The operator combining the values, so ScanTraits and the scan build options can be reused.
+*/
+inline ScanOperator toScanOperator(ReduceOperator op)
+{
+    switch(op)
+    {
+    case ReduceOperator::Min: return ScanOperator::Min;
+    case ReduceOperator::Max:
+    case ReduceOperator::ArgMax: return ScanOperator::Max;
+    default: return ScanOperator::Add;
+    }
+}
+
+/**
+* A value together with its index, the intermediate result of ReduceOperator::ArgMax. Has the layout of the corresponding struct in the kernels.
+*/
+template <typename T>
+struct ReducePair
+{
+    T value;
+    cl_uint index;
+};
+
+/**
+* Base of the algorithms benchmarked by the ReducePlugin.
+* The result holds the reduced value. For ReduceOperator::ArgMax the bytes of the second element hold the index of the maximum as cl_uint.
+*/
+class ReduceAlgorithm
+{
+    public:
+        virtual ~ReduceAlgorithm() {}
+
+        virtual ReduceOperator getOperator() = 0;
+
+        template <typename T>
+        static cl_uint& getIndex(T* result)
+        {
+            return *reinterpret_cast<cl_uint*>(result + 1);
+        }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include "ReduceAlgorithm.h"
+
+using namespace std;
+
+/**
+* Reduction of an array to a single value, see ReduceAlgorithm for the result layout.
+*/
+template <typename T>
+class ReducePlugin
+{
+public:
+    typedef ReduceAlgorithm AlgorithmType;
+
+    const string getTaskDescription(size_t size)
+    {
+        stringstream ss;
+        ss << "Reducing " << size << " elements of type " << getTypeName<T>() << " (" << sizeToString(size * sizeof(T)) << ")";
+        return ss.str();
+    }
+
+    /**
+    * A reduction reads every element once, the writers report GB/s.
+    */
+    double getWorkload(size_t size)
+    {
+        return size * sizeof(T) / 1e9;
+    }
+
+    const string getThroughputUnit()
+    {
+        return "GB/s";
+    }
+
+    size_t getInputLength(size_t size)
+    {
+        return size;
+    }
+
+    T* genInput(size_t size)
+    {
+        T* data = new T[size];
+
+        fillRandom(data, size, SEED, [](uint64_t random) -> T
+        {
+            return ScanTraits<T>::fromRandom(random);
+        });
+
+        return data;
+    }
+
+    T* genResult(size_t size)
+    {
+        return new T[2];
+    }
+
+    void freeInput(T* data)
+    {
+        delete[] data;
+    }
+
+    void freeResult(T* result)
+    {
+        delete[] result;
+    }
+
+    /**
+    * The value is compared against a reduction on the host in the wide type of ScanTraits, an ArgMax index has to point to the maximum.
+    */
+    bool verifyResult(ReduceAlgorithm* alg, T* data, T* result, size_t size)
+    {
+        typedef ScanTraits<T> Traits;
+        typedef typename Traits::Wide Wide;
+
+        ReduceOperator op = alg->getOperator();
+        ScanOperator scanOp = toScanOperator(op);
+
+        int chunks = (int)((size + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+        vector<Wide> partials(chunks);
+
+        #pragma omp parallel for
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t begin = c * VERIFY_CHUNK_SIZE;
+            size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+            Wide partial = Traits::identity(scanOp);
+            for(size_t i = begin; i < end; i++)
+                partial = Traits::apply(scanOp, partial, Traits::widen(data[i]));
+            partials[c] = partial;
+        }
+
+        Wide expected = Traits::identity(scanOp);
+        for(int c = 0; c < chunks; c++)
+            expected = Traits::apply(scanOp, expected, partials[c]);
+
+        if(!Traits::matches(result[0], expected))
+            return false;
+
+        if(op == ReduceOperator::ArgMax)
+        {
+            cl_uint index = ReduceAlgorithm::getIndex(result);
+            return index < size && data[index] == result[0];
+        }
+
+        return true;
+    }
+
+private:
+    static const size_t VERIFY_CHUNK_SIZE = 1 << 16;
+    static const uint64_t SEED = 0;
+
+};
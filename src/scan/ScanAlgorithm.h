@@ -1,7 +1,56 @@
 #pragma once
 
+#include <vector>
+
+#include "ScanOperator.h"
+#include "../common/utils.h"
+
 class ScanAlgorithm
 {
     public:
         virtual bool isInclusiv() = 0;
+
+        /**
+        * The associative operator the scan combines the elements with.
+        */
+        virtual ScanOperator getOperator()
+        {
+            return ScanOperator::Add;
+        }
+
+        /**
+        * A segmented scan restarts at every element for which isSegmentHead is true.
+        */
+        virtual bool isSegmented()
+        {
+            return false;
+        }
+
+        /**
+        * Head flags of the segmented scans. They only depend on the index, so the plugin and the algorithms agree on them without passing them along.
+        * Segments are SEGMENT_LENGTH elements long on average.
+        */
+        static bool isSegmentHead(size_t i)
+        {
+            return randomAt(SEGMENT_SEED, i) % SEGMENT_LENGTH == 0;
+        }
+
+        /**
+        * Fills heads with the head flags of the first size elements, nothing is done if it already has this size.
+        */
+        static void fillSegmentHeads(vector<cl_uint>& heads, size_t size)
+        {
+            if(heads.size() == size)
+                return;
+
+            heads.resize(size);
+
+            #pragma omp parallel for
+            for(int i = 0; i < (int)size; i++)
+                heads[i] = isSegmentHead(i);
+        }
+
+    private:
+        static const size_t SEGMENT_LENGTH = 1024;
+        static const uint64_t SEGMENT_SEED = 1;
 };
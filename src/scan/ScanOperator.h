@@ -0,0 +1,255 @@
+#pragma once
+
+#include <CL/cl.h>
+#include <string>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/**
+* Associative operators of the generic scans.
+*/
+enum class ScanOperator
+{
+    Add,
+    Max,
+    Min
+};
+
+inline const string scanOperatorToString(ScanOperator op)
+{
+    switch(op)
+    {
+    case ScanOperator::Add: return "+";
+    case ScanOperator::Max: return "max";
+    case ScanOperator::Min: return "min";
+    }
+    return "unknown";
+}
+
+/**
+* Describes an element type of the generic scans on the host and in OpenCL C.
+* Wide is the type the host computes the expected results in, apply and identity work on it, matches compares a result against it.
+*/
+template <typename T>
+struct ScanTraits;
+
+/**
+* Shared part of the scalar types.
+*/
+template <typename T, typename W>
+struct ScalarScanTraits
+{
+    typedef W Wide;
+
+    static Wide widen(T value)
+    {
+        return (Wide)value;
+    }
+
+    static Wide apply(ScanOperator op, Wide a, Wide b)
+    {
+        switch(op)
+        {
+        case ScanOperator::Max: return max(a, b);
+        case ScanOperator::Min: return min(a, b);
+        default:                return a + b;
+        }
+    }
+
+    static Wide identity(ScanOperator op)
+    {
+        switch(op)
+        {
+        case ScanOperator::Max: return numeric_limits<Wide>::has_infinity ? -numeric_limits<Wide>::infinity() : numeric_limits<Wide>::lowest();
+        case ScanOperator::Min: return numeric_limits<Wide>::has_infinity ? numeric_limits<Wide>::infinity() : numeric_limits<Wide>::max();
+        default:                return 0;
+        }
+    }
+
+    static T fromRandom(uint64_t random)
+    {
+        return (T)(random % 100);
+    }
+};
+
+template <>
+struct ScanTraits<cl_int> : public ScalarScanTraits<cl_int, cl_int>
+{
+    static const string getCLType()
+    {
+        return "int";
+    }
+
+    static const string getCLIdentity(ScanOperator op)
+    {
+        switch(op)
+        {
+        case ScanOperator::Max: return "INT_MIN";
+        case ScanOperator::Min: return "INT_MAX";
+        default:                return "0";
+        }
+    }
+
+    // sums wrap around like on the device
+    static Wide apply(ScanOperator op, Wide a, Wide b)
+    {
+        if(op == ScanOperator::Add)
+            return (Wide)((cl_uint)a + (cl_uint)b);
+        return ScalarScanTraits<cl_int, cl_int>::apply(op, a, b);
+    }
+
+    static bool matches(cl_int value, Wide expected)
+    {
+        return value == expected;
+    }
+};
+
+template <>
+struct ScanTraits<cl_ulong> : public ScalarScanTraits<cl_ulong, cl_ulong>
+{
+    static const string getCLType()
+    {
+        return "ulong";
+    }
+
+    static const string getCLIdentity(ScanOperator op)
+    {
+        switch(op)
+        {
+        case ScanOperator::Min: return "ULONG_MAX";
+        default:                return "0";
+        }
+    }
+
+    static bool matches(cl_ulong value, Wide expected)
+    {
+        return value == expected;
+    }
+};
+
+template <>
+struct ScanTraits<cl_float> : public ScalarScanTraits<cl_float, double>
+{
+    static const string getCLType()
+    {
+        return "float";
+    }
+
+    static const string getCLIdentity(ScanOperator op)
+    {
+        switch(op)
+        {
+        case ScanOperator::Max: return "-INFINITY";
+        case ScanOperator::Min: return "INFINITY";
+        default:                return "0.0f";
+        }
+    }
+
+    // the device sums in single precision in a different order, so sums only match relatively
+    static bool matches(cl_float value, Wide expected)
+    {
+        return value == expected || fabs(value - expected) <= 1e-4 * max(1.0, fabs(expected));
+    }
+};
+
+template <>
+struct ScanTraits<cl_double> : public ScalarScanTraits<cl_double, double>
+{
+    static const string getCLType()
+    {
+        return "double";
+    }
+
+    static const string getCLIdentity(ScanOperator op)
+    {
+        switch(op)
+        {
+        case ScanOperator::Max: return "-INFINITY";
+        case ScanOperator::Min: return "INFINITY";
+        default:                return "0.0";
+        }
+    }
+
+    // only the order of the additions differs from the device
+    static bool matches(cl_double value, Wide expected)
+    {
+        return value == expected || fabs(value - expected) <= 1e-9 * max(1.0, fabs(expected));
+    }
+};
+
+template <>
+struct ScanTraits<cl_float4>
+{
+    typedef array<double, 4> Wide;
+
+    static const string getCLType()
+    {
+        return "float4";
+    }
+
+    static const string getCLIdentity(ScanOperator op)
+    {
+        string identity = ScanTraits<cl_float>::getCLIdentity(op);
+        return "((float4)(" + identity + "," + identity + "," + identity + "," + identity + "))";
+    }
+
+    static Wide widen(cl_float4 value)
+    {
+        Wide wide = { { value.s[0], value.s[1], value.s[2], value.s[3] } };
+        return wide;
+    }
+
+    static Wide apply(ScanOperator op, const Wide& a, const Wide& b)
+    {
+        Wide result;
+        for(int c = 0; c < 4; c++)
+            result[c] = ScanTraits<cl_float>::apply(op, a[c], b[c]);
+        return result;
+    }
+
+    static Wide identity(ScanOperator op)
+    {
+        Wide result;
+        result.fill(ScanTraits<cl_float>::identity(op));
+        return result;
+    }
+
+    static bool matches(const cl_float4& value, const Wide& expected)
+    {
+        for(int c = 0; c < 4; c++)
+            if(!ScanTraits<cl_float>::matches(value.s[c], expected[c]))
+                return false;
+        return true;
+    }
+
+    // every component from a different part of the random number
+    static cl_float4 fromRandom(uint64_t random)
+    {
+        cl_float4 value;
+        for(int c = 0; c < 4; c++)
+            value.s[c] = (cl_float)((random >> (16 * c)) % 100);
+        return value;
+    }
+};
+
+/**
+* Build options defining OP(a, b) and IDENTITY of the given operator for the element type T.
+*/
+template <typename T>
+const string getScanOperatorOptions(ScanOperator op)
+{
+    string function;
+    switch(op)
+    {
+    case ScanOperator::Max: function = "max(a,b)"; break;
+    case ScanOperator::Min: function = "min(a,b)"; break;
+    default:                function = "(a)+(b)"; break;
+    }
+
+    // the definitions must not contain spaces, as not every platform supports quoted build options
+    return "-D T=" + ScanTraits<T>::getCLType() + " -D OP(a,b)=" + function + " -D IDENTITY=" + ScanTraits<T>::getCLIdentity(op);
+}
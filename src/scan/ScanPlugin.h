@@ -1,6 +1,7 @@
 #pragma once
 
 #include <sstream>
+#include <vector>
 
 #include "ScanAlgorithm.h"
 
@@ -12,6 +13,20 @@ class ScanPlugin
     public:
         typedef ScanAlgorithm AlgorithmType;
 
+        ScanPlugin()
+            : dataset(nullptr)
+        {
+        }
+
+        /**
+        * Uses the elements of the given dataset as input instead of generating them.
+        * The data is accessed directly inside the memory mapping. The dataset is not owned by the plugin.
+        */
+        void setDataset(Dataset* dataset)
+        {
+            this->dataset = dataset;
+        }
+
         const string getTaskDescription(size_t size)
         {
             stringstream ss;
@@ -19,13 +34,21 @@ class ScanPlugin
             return ss.str();
         }
 
+        size_t getInputLength(size_t size)
+        {
+            return size;
+        }
+
         T* genInput(size_t size)
         {
+            if(dataset)
+                return dataset->getData<T>(size);
+
             T* data = new T[size];
 
-            generate(data, data + size, []()
+            fillRandom(data, size, SEED, [](uint64_t random) -> T
             {
-                return rand() % 100;
+                return ScanTraits<T>::fromRandom(random);
                 //return 1;
             });
 
@@ -39,7 +62,8 @@ class ScanPlugin
 
         void freeInput(T* data)
         {
-            delete[] (T*)data;
+            if(!dataset)
+                delete[] (T*)data;
         }
 
         void freeResult(T* result)
@@ -47,29 +71,84 @@ class ScanPlugin
             delete[] (T*)result;
         }
 
+        /**
+        * Computes the expected scan on the host in chunks: every chunk reduces its elements, the chunk totals are scanned sequentially and every chunk then compares its elements starting from its carry.
+        * A segment head resets the scan, so a chunk total is the pair of (contains a head, total since its last head).
+        */
         bool verifyResult(ScanAlgorithm* alg, T* data, T* result, size_t size)
         {
-            if(alg->isInclusiv())
-            {
-                if(data[0] != result[0])
-                    return false;
+            typedef ScanTraits<T> Traits;
+            typedef typename Traits::Wide Wide;
+
+            ScanOperator op = alg->getOperator();
+            bool segmented = alg->isSegmented();
+            bool inclusiv = alg->isInclusiv();
 
-                for(size_t i = 1; i < size; i++)
-                    if(result[i] != result[i - 1] + data[i])
-                        return false;
+            int chunks = (int)((size + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+            vector<Wide> carries(chunks);
+            vector<char> heads(chunks);
 
-                return true;
+            #pragma omp parallel for
+            for(int c = 0; c < chunks; c++)
+            {
+                size_t begin = c * VERIFY_CHUNK_SIZE;
+                size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+                Wide total = Traits::identity(op);
+                bool head = false;
+                for(size_t i = begin; i < end; i++)
+                {
+                    if(segmented && ScanAlgorithm::isSegmentHead(i))
+                    {
+                        total = Traits::identity(op);
+                        head = true;
+                    }
+                    total = Traits::apply(op, total, Traits::widen(data[i]));
+                }
+
+                carries[c] = total;
+                heads[c] = head;
             }
-            else
+
+            // exclusive scan of the chunk totals
+            Wide carry = Traits::identity(op);
+            for(int c = 0; c < chunks; c++)
             {
-                if(result[0] != 0)
-                    return false;
+                Wide total = carries[c];
+                carries[c] = carry;
+                carry = heads[c] ? total : Traits::apply(op, carry, total);
+            }
 
-                for(size_t i = 1; i < size; i++)
-                    if(result[i] != result[i - 1] + data[i - 1])
-                        return false;
+            bool success = true;
 
-                return true;
+            #pragma omp parallel for reduction(&&:success)
+            for(int c = 0; c < chunks; c++)
+            {
+                size_t begin = c * VERIFY_CHUNK_SIZE;
+                size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+                Wide running = carries[c];
+                size_t errors = 0;
+                for(size_t i = begin; i < end; i++)
+                {
+                    if(segmented && ScanAlgorithm::isSegmentHead(i))
+                        running = Traits::identity(op);
+
+                    // an inclusive scan adds the current element, an exclusive scan only the previous ones
+                    Wide next = Traits::apply(op, running, Traits::widen(data[i]));
+                    errors += !Traits::matches(result[i], inclusiv ? next : running);
+                    running = next;
+                }
+
+                success = success && errors == 0;
             }
+
+            return success;
         }
+
+    private:
+        static const size_t VERIFY_CHUNK_SIZE = 1 << 16;
+        static const uint64_t SEED = 0;
+
+        Dataset* dataset;
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+
+#include "../../common/CPUAlgorithm.h"
+#include "../CompactAlgorithm.h"
+
+namespace cpu
+{
+    /**
+    * Counts the kept elements first, so the other ones can be copied behind them in the same pass.
+    */
+    template<typename T>
+    class Compact : public CPUAlgorithm<T>, public CompactAlgorithm
+    {
+    public:
+        const string getName() override
+        {
+            return "Compact (C++ STL algorithm partition_copy)";
+        }
+
+        void run(T* data, T* result, size_t size) override
+        {
+            T threshold = getThreshold(data);
+            T* elements = getElements(data);
+            T* partition = getPartition(result);
+
+            auto keep = [threshold](T value) { return value < threshold; };
+
+            size_t count = count_if(elements, elements + size, keep);
+            partition_copy(elements, elements + size, partition, partition + count, keep);
+
+            result[0] = (T)count;
+        }
+
+        virtual ~Compact() {}
+    };
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../common/CPUAlgorithm.h"
+#include "../../common/utils.h"
+#include "../HistogramAlgorithm.h"
+
+using namespace std;
+
+namespace cpu
+{
+    /**
+    * Every thread counts a contiguous part of the values into its own histogram, so no counter is shared between threads.
+    * The private histograms are added bin by bin in parallel afterwards.
+    */
+    template<typename T>
+    class Histogram : public CPUAlgorithm<T>, public HistogramAlgorithm
+    {
+        static const size_t MAX_PARTS = 64; // bounds the memory of the private histograms for large bin counts
+
+    public:
+        const string getName() override
+        {
+            return "Histogram (OpenMP private histograms)";
+        }
+
+        void run(T* data, T* result, size_t size) override
+        {
+            size_t bins = getBinCount(data);
+            const T* values = getValues(data);
+
+            size_t partSize = max((size_t)PARALLEL_CHUNK_SIZE, (size + MAX_PARTS - 1) / MAX_PARTS);
+            int parts = (int)((size + partSize - 1) / partSize);
+            histograms.assign(parts * bins, 0);
+
+            #pragma omp parallel for
+            for(int p = 0; p < parts; p++)
+            {
+                size_t begin = p * partSize;
+                size_t end = min(begin + partSize, size);
+
+                T* histogram = &histograms[p * bins];
+                for(size_t i = begin; i < end; i++)
+                    histogram[values[i]]++;
+            }
+
+            #pragma omp parallel for
+            for(int b = 0; b < (int)bins; b++)
+            {
+                T count = 0;
+                for(int p = 0; p < parts; p++)
+                    count += histograms[p * bins + b];
+                result[b] = count;
+            }
+        }
+
+        virtual ~Histogram() {}
+
+    private:
+        vector<T> histograms;
+    };
+}
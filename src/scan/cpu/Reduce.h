@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "../../common/CPUAlgorithm.h"
+#include "../../common/utils.h"
+#include "../ReduceAlgorithm.h"
+
+namespace cpu
+{
+    /**
+    * Reduces chunks of the array in parallel and combines the chunk results sequentially.
+    * Every chunk is reduced into LANES independent accumulators, which the compiler can keep in SIMD registers.
+    */
+    template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+    class Reduce : public CPUAlgorithm<T>, public ReduceAlgorithm
+    {
+        static const int LANES = 8;
+
+    public:
+        const string getName() override
+        {
+            return "Reduce (" + reduceOperatorToString(Op) + ") (OpenMP, " + to_string(LANES) + " SIMD lanes)";
+        }
+
+        ReduceOperator getOperator() override
+        {
+            return Op;
+        }
+
+        void run(T* data, T* result, size_t size) override
+        {
+            int chunks = (int)((size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
+            vector<ReducePair<T>> partials(chunks);
+
+            #pragma omp parallel for
+            for(int c = 0; c < chunks; c++)
+            {
+                size_t begin = c * PARALLEL_CHUNK_SIZE;
+                size_t end = min(begin + PARALLEL_CHUNK_SIZE, size);
+
+                partials[c] = Op == ReduceOperator::ArgMax ? reduceArgMax(data, begin, end) : reduceLanes(data, begin, end);
+            }
+
+            ReducePair<T> total = partials[0];
+            for(int c = 1; c < chunks; c++)
+            {
+                // chunks are combined in order, so the first index of the maximum is kept
+                if(Op == ReduceOperator::ArgMax)
+                    total = partials[c].value > total.value ? partials[c] : total;
+                else
+                    total.value = apply(total.value, partials[c].value);
+            }
+
+            result[0] = total.value;
+            if(Op == ReduceOperator::ArgMax)
+                getIndex(result) = total.index;
+        }
+
+        virtual ~Reduce() {}
+
+    private:
+        ReducePair<T> reduceLanes(const T* data, size_t begin, size_t end)
+        {
+            T lanes[LANES];
+            fill(lanes, lanes + LANES, (T)ScanTraits<T>::identity(toScanOperator(Op)));
+
+            size_t i = begin;
+            for(; i + LANES <= end; i += LANES)
+                for(int l = 0; l < LANES; l++)
+                    lanes[l] = apply(lanes[l], data[i + l]);
+
+            for(; i < end; i++)
+                lanes[0] = apply(lanes[0], data[i]);
+
+            ReducePair<T> pair = { lanes[0], 0 };
+            for(int l = 1; l < LANES; l++)
+                pair.value = apply(pair.value, lanes[l]);
+            return pair;
+        }
+
+        ReducePair<T> reduceArgMax(const T* data, size_t begin, size_t end)
+        {
+            ReducePair<T> pair = { data[begin], (cl_uint)begin };
+            for(size_t i = begin + 1; i < end; i++)
+            {
+                if(data[i] > pair.value)
+                {
+                    pair.value = data[i];
+                    pair.index = (cl_uint)i;
+                }
+            }
+            return pair;
+        }
+
+        static T apply(T a, T b)
+        {
+            switch(Op)
+            {
+            case ReduceOperator::Min: return min(a, b);
+            case ReduceOperator::Max:
+            case ReduceOperator::ArgMax: return max(a, b);
+            default: return add(a, b);
+            }
+        }
+
+        // integer sums wrap around like on the device
+        static cl_int add(cl_int a, cl_int b)
+        {
+            return (cl_int)((cl_uint)a + (cl_uint)b);
+        }
+
+        template <typename U>
+        static U add(U a, U b)
+        {
+            return a + b;
+        }
+    };
+}
@@ -26,7 +26,7 @@ namespace gpu
                 void init() override
                 {
                     clppProgram::setBasePath("../common/libs/clpp/clpp/");
-                    clppcontext.setup(0, 0);
+                    clppcontext.setup(this->context->getCLContext(), this->context->getCLDevice(), this->queue->getCLCommandQueue());
 
                     s = new clppScan_GPU(&clppcontext, sizeof(T), 0);
                     assert(s->_context->clQueue != 0);
@@ -34,10 +34,10 @@ namespace gpu
 
                 void upload(size_t workGroupSize, T* data, size_t size) override
                 {
-                    assert(s->_context->clQueue != 0);
-                    buffer = new T[size];
-                    memcpy(buffer, data, sizeof(T) * size);
-                    s->pushDatas(buffer, size);
+                    buffer = this->context->createBuffer(CL_MEM_READ_WRITE, size * sizeof(T));
+                    this->queue->enqueueWrite(buffer, data);
+
+                    s->pushDatas(buffer->getCLBuffer(), size);
                 }
 
                 void run(size_t workGroupSize, size_t size) override
@@ -47,20 +47,19 @@ namespace gpu
 
                 void download(T* result, size_t size) override
                 {
-                    s->popDatas();
-                    memcpy(buffer, result, size * sizeof(T));
+                    this->queue->enqueueRead(buffer, result);
+                    delete buffer;
                 }
 
                 void cleanup() override
                 {
                     delete s;
-                    delete buffer;
                 }
 
                 virtual ~Scan() {}
 
             private:
-                T* buffer;
+                Buffer* buffer;
                 clppScan* s;
                 clppContext clppcontext;
         };
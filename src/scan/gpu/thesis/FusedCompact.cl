@@ -0,0 +1,64 @@
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+
+#define ELEMENTS_PER_ITEM 4
+
+// Partitions the elements in a single pass. Every work group handles ELEMENTS_PER_ITEM * local size elements,
+// a local scan of the counts of its work items gives their positions inside the group and one atomic add on the counter
+// reserves the space of the group in both parts of the result. The counter packs (processed elements << 32 | kept elements).
+// Kept elements are written from the front, the others from the back, groups in the order they reach the atomic.
+__kernel void Compact(__global uint* elements, __global uint* result, __global ulong* counter, __local uint* shared, uint threshold, uint size) {
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+	uint base = get_group_id(0) * localSize * ELEMENTS_PER_ITEM + localId;
+
+	// count the elements of the work item, consecutive work items read consecutive elements
+	uint kept = 0;
+	uint rejected = 0;
+	for (uint k = 0; k < ELEMENTS_PER_ITEM; k++) {
+		uint i = base + k * localSize;
+		if (i < size) {
+			if (elements[i] < threshold)
+				kept++;
+			else
+				rejected++;
+		}
+	}
+
+	// inclusive scan of both counts packed into one value, a group holds less than 1 << 16 elements
+	uint counts = kept | (rejected << 16);
+	shared[localId] = counts;
+	for (uint offset = 1; offset < localSize; offset <<= 1) {
+		barrier(CLK_LOCAL_MEM_FENCE);
+		uint add = localId >= offset ? shared[localId - offset] : 0;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		shared[localId] += add;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	__local ulong before;
+	if (localId == localSize - 1) {
+		uint total = shared[localId];
+		uint groupKept = total & 0xFFFF;
+		uint groupProcessed = groupKept + (total >> 16);
+		before = atom_add(counter, ((ulong)groupProcessed << 32) | groupKept);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	uint keptBefore = (uint)before;
+	uint rejectedBefore = (uint)(before >> 32) - keptBefore;
+
+	uint itemBefore = shared[localId] - counts;
+	uint keptPos = keptBefore + (itemBefore & 0xFFFF);
+	uint rejectedPos = rejectedBefore + (itemBefore >> 16);
+
+	for (uint k = 0; k < ELEMENTS_PER_ITEM; k++) {
+		uint i = base + k * localSize;
+		if (i < size) {
+			uint value = elements[i];
+			if (value < threshold)
+				result[1 + keptPos++] = value;
+			else
+				result[size - rejectedPos++] = value;
+		}
+	}
+} // Compact
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../../CompactAlgorithm.h"
+#include "../../../common/CLAlgorithm.h"
+
+#include "../../../common/utils.h"
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Compaction in a single kernel, every work group scans its elements in local memory and reserves its part of the result with one global atomic.
+        * The order of the groups in the result depends on the order they finish in, so the result is not stable.
+        * Requires cl_khr_int64_base_atomics.
+        */
+        template<typename T>
+        class FusedCompact : public CLAlgorithm<T>, public CompactAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+            static const size_t ELEMENTS_PER_ITEM = 4;
+
+        public:
+            const string getName() override
+            {
+                return "Fused Compact (THESIS local scan, one atomic per group)";
+            }
+
+            const vector<size_t> getSupportedWorkGroupSizes() const override
+            {
+                // a group has to hold less than 1 << 16 elements for the packed local counts
+                auto sizes = CLAlgorithm<T>::getSupportedWorkGroupSizes();
+                sizes.erase(remove_if(begin(sizes), end(sizes), [](size_t size) { return size * ELEMENTS_PER_ITEM >= (1 << 16); }), sizes.end());
+                return sizes;
+            }
+
+            bool isStable() override
+            {
+                return false;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/FusedCompact.cl");
+                kernel = program->createKernel("Compact");
+                delete program;
+
+                counterBuffer = context->createBuffer(CL_MEM_READ_WRITE, sizeof(cl_ulong));
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                threshold = getThreshold(data);
+
+                elementBuffer = context->createBuffer(CL_MEM_READ_ONLY, size * sizeof(T));
+                queue->enqueueWrite(elementBuffer, getElements(data), 0, size * sizeof(T));
+
+                resultBuffer = context->createBuffer(CL_MEM_WRITE_ONLY, (1 + size) * sizeof(T));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                cl_ulong zero = 0;
+                queue->enqueueWrite(counterBuffer, &zero);
+
+                kernel->setArg(0, elementBuffer);
+                kernel->setArg(1, resultBuffer);
+                kernel->setArg(2, counterBuffer);
+                kernel->setArg(3, workGroupSize * sizeof(cl_uint), nullptr);
+                kernel->setArg(4, threshold);
+                kernel->setArg(5, (cl_uint)size);
+
+                size_t globalWorkSizes[] = { roundToMultiple(size, workGroupSize * ELEMENTS_PER_ITEM) / ELEMENTS_PER_ITEM };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                queue->enqueueKernel(kernel, 1, globalWorkSizes, localWorkSizes);
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(resultBuffer, result, 0, (1 + size) * sizeof(T));
+
+                // the number of kept elements is only known to the counter
+                cl_ulong counter;
+                queue->enqueueRead(counterBuffer, &counter);
+                result[0] = (T)(counter & 0xFFFFFFFF);
+
+                delete elementBuffer;
+                delete resultBuffer;
+            }
+
+            void cleanup() override
+            {
+                delete kernel;
+                delete counterBuffer;
+            }
+
+            virtual ~FusedCompact() {}
+
+        private:
+            Kernel* kernel;
+
+            T threshold;
+
+            Buffer* elementBuffer;
+            Buffer* resultBuffer;
+            Buffer* counterBuffer;
+        };
+    }
+}
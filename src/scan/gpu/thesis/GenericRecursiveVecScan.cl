@@ -0,0 +1,140 @@
+// Generic version of RecursiveVecScan.cl. The element type T, the associative operator OP(a, b) and its IDENTITY are given as build options.
+// With SEGMENTED defined the scan restarts at every element with a head flag. It then scans pairs of (flag, value) combined by
+// (fa, a) OP (fb, b) = (fa | fb, fb ? b : a OP b), which is associative again, so the same up and down sweeps apply.
+
+#define VECTOR_WIDTH 8
+
+#ifdef SEGMENTED
+#define HEAD(heads, i) (heads[i] != 0)
+#define HEADS_ARG(name) __global uint* name,
+#define LOCAL_HEADS_ARG(name) __local uint* name,
+#else
+#define HEAD(heads, i) 0
+#define HEADS_ARG(name)
+#define LOCAL_HEADS_ARG(name)
+#endif
+
+// every work item scans two runs of VECTOR_WIDTH elements sequentially, the operator may not be defined on vectors
+// resetHeads is only set on the outermost level, where heads get IDENTITY. The recursion levels keep the exclusive pair scan
+__kernel void ScanBlocks(__global T* buffer, HEADS_ARG(heads) __global T* sums, HEADS_ARG(sumHeads) __local T* shared, LOCAL_HEADS_ARG(sharedHeads) uint resetHeads) {
+	uint globalId = get_global_id(0);
+	uint localId = get_local_id(0);
+	uint n = get_local_size(0) * 2;
+
+	uint offset = 1;
+
+	// reduce the runs into shared memory
+	for (uint r = 0; r < 2; r++) {
+		uint base = (2 * globalId + r) * VECTOR_WIDTH;
+		T sum = IDENTITY;
+		uint head = 0;
+		for (uint k = 0; k < VECTOR_WIDTH; k++) {
+			T val = buffer[base + k];
+			if (HEAD(heads, base + k)) {
+				sum = val;
+				head = 1;
+			} else
+				sum = OP(sum, val);
+		}
+		shared[2 * localId + r] = sum;
+#ifdef SEGMENTED
+		sharedHeads[2 * localId + r] = head;
+#endif
+	}
+
+	// build sum in place up the tree
+	for (uint d = n >> 1; d > 0; d >>= 1) {
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId < d) {
+			uint ai = offset*(2*localId+1)-1;
+			uint bi = offset*(2*localId+2)-1;
+#ifdef SEGMENTED
+			if (!sharedHeads[bi])
+				shared[bi] = OP(shared[ai], shared[bi]);
+			sharedHeads[bi] |= sharedHeads[ai];
+#else
+			shared[bi] = OP(shared[ai], shared[bi]);
+#endif
+		}
+		offset <<= 1;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// save sum and clear the last element
+	if (localId == 0) {
+		sums[get_group_id(0)] = shared[n - 1];
+		shared[n - 1] = IDENTITY;
+#ifdef SEGMENTED
+		sumHeads[get_group_id(0)] = sharedHeads[n - 1];
+		sharedHeads[n - 1] = 0;
+#endif
+	}
+
+	// traverse down tree & build scan
+	for (uint d = 1; d < n; d *= 2) {
+		offset >>= 1;
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId < d) {
+			uint ai = offset*(2*localId+1)-1;
+			uint bi = offset*(2*localId+2)-1;
+			T t = shared[ai];
+			shared[ai] = shared[bi];
+#ifdef SEGMENTED
+			uint th = sharedHeads[ai];
+			sharedHeads[ai] = sharedHeads[bi];
+			shared[bi] = th ? t : OP(shared[bi], t);
+			sharedHeads[bi] |= th;
+#else
+			shared[bi] = OP(shared[bi], t);
+#endif
+		}
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// scan the runs starting from their prefixes
+	for (uint r = 0; r < 2; r++) {
+		uint base = (2 * globalId + r) * VECTOR_WIDTH;
+		T sum = shared[2 * localId + r];
+		for (uint k = 0; k < VECTOR_WIDTH; k++) {
+			T val = buffer[base + k];
+			if (HEAD(heads, base + k)) {
+				buffer[base + k] = resetHeads ? IDENTITY : sum;
+				sum = val;
+			} else {
+				buffer[base + k] = sum;
+				sum = OP(sum, val);
+			}
+		}
+	}
+} // ScanBlocks
+
+__kernel void AddSums(__global T* buffer, HEADS_ARG(heads) __global T* sums, uint resetHeads) {
+	uint globalId = get_global_id(0);
+	uint begin = 2 * globalId * VECTOR_WIDTH;
+	uint end = begin + 2 * VECTOR_WIDTH;
+
+	T val = sums[get_group_id(0)];
+
+#ifdef SEGMENTED
+	// the sum of the previous blocks only reaches the elements up to the first head of the block
+	__local uint firstHead;
+	if (get_local_id(0) == 0)
+		firstHead = UINT_MAX;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint i = begin; i < end; i++) {
+		if (heads[i]) {
+			atomic_min(&firstHead, i);
+			break;
+		}
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// on the outermost level the head already holds IDENTITY, on the recursion levels it still lacks the sum
+	if (firstHead != UINT_MAX)
+		end = min(end, resetHeads ? firstHead : firstHead + 1);
+#endif
+
+	for (uint i = begin; i < end; i++)
+		buffer[i] = OP(val, buffer[i]);
+} // AddSums
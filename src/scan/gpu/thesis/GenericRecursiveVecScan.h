@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vector>
+
+#include "../../ScanAlgorithm.h"
+#include "../../ScanOperator.h"
+#include "../../../common/CLAlgorithm.h"
+
+#include "../../../common/utils.h"
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * RecursiveVecScan for any element type and associative operator, optionally segmented by the head flags of ScanAlgorithm::isSegmentHead.
+        * A segmented scan scans pairs of (head flag, value), so the recursion also passes the flags of the block sums along.
+        */
+        template<typename T, ScanOperator Op = ScanOperator::Add, bool Segmented = false>
+        class GenericRecursiveVecScan : public CLAlgorithm<T>, public ScanAlgorithm
+        {
+            static const int VECTOR_WIDTH = 8;
+
+        public:
+            const string getName() override
+            {
+                return "Generic Recursive Vec Scan (THESIS dixxi GPU Gems) (exclusiv) (" + scanOperatorToString(Op) + ")" + string(Segmented ? " (segmented)" : "");
+            }
+
+            const vector<size_t> getSupportedWorkGroupSizes() const override
+            {
+                // this algorithm does not allow a work group size of 1, because this would not reduce the problem size in a recursion.
+                auto sizes = CLAlgorithm<T>::getSupportedWorkGroupSizes();
+                sizes.erase(remove_if(begin(sizes), end(sizes), [](size_t size) { return size < 2; }), sizes.end());
+                return sizes;
+            }
+
+            bool isInclusiv() override
+            {
+                return false;
+            }
+
+            ScanOperator getOperator() override
+            {
+                return Op;
+            }
+
+            bool isSegmented() override
+            {
+                return Segmented;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/GenericRecursiveVecScan.cl", getOptions());
+                kernel = program->createKernel("ScanBlocks");
+                addKernel = program->createKernel("AddSums");
+                delete program;
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                bufferSize = roundToMultiple(size, workGroupSize * 2 * VECTOR_WIDTH);
+
+                buffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                queue->enqueueWrite(buffer, data, 0, size * sizeof(T));
+
+                heads = nullptr;
+                if(Segmented)
+                {
+                    fillSegmentHeads(headFlags, size);
+
+                    heads = context->createBuffer(CL_MEM_READ_ONLY, bufferSize * sizeof(cl_uint));
+                    queue->enqueueWrite(heads, headFlags.data(), 0, size * sizeof(cl_uint));
+                }
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                run_r(workGroupSize, buffer, heads, bufferSize, true);
+            }
+
+            void run_r(size_t workGroupSize, Buffer* values, Buffer* valueHeads, size_t size, bool resetHeads)
+            {
+                size_t sumBufferSize = roundToMultiple(size / (workGroupSize * 2 * VECTOR_WIDTH), workGroupSize * 2 * VECTOR_WIDTH);
+
+                Buffer* sums = context->createBuffer(CL_MEM_READ_WRITE, sumBufferSize * sizeof(T));
+                Buffer* sumHeads = Segmented ? context->createBuffer(CL_MEM_READ_WRITE, sumBufferSize * sizeof(cl_uint)) : nullptr;
+
+                // the head arguments only exist in the segmented kernels
+                cl_uint arg = 0;
+                kernel->setArg(arg++, values);
+                if(Segmented)
+                    kernel->setArg(arg++, valueHeads);
+                kernel->setArg(arg++, sums);
+                if(Segmented)
+                    kernel->setArg(arg++, sumHeads);
+                kernel->setArg(arg++, sizeof(T) * 2 * workGroupSize, nullptr);
+                if(Segmented)
+                    kernel->setArg(arg++, sizeof(cl_uint) * 2 * workGroupSize, nullptr);
+                kernel->setArg(arg++, (cl_uint)resetHeads);
+
+                size_t globalWorkSizes[] = { size / (2 * VECTOR_WIDTH) }; // each thread processed 2 * VECTOR_WIDTH elements
+                size_t localWorkSizes[] = { workGroupSize };
+
+                queue->enqueueKernel(kernel, 1, globalWorkSizes, localWorkSizes);
+
+                if(size > workGroupSize * 2 * VECTOR_WIDTH)
+                {
+                    // the buffer containes more than one scanned block, scan the created sum buffer
+                    run_r(workGroupSize, sums, sumHeads, sumBufferSize, false);
+
+                    // apply the sums to the buffer
+                    arg = 0;
+                    addKernel->setArg(arg++, values);
+                    if(Segmented)
+                        addKernel->setArg(arg++, valueHeads);
+                    addKernel->setArg(arg++, sums);
+                    addKernel->setArg(arg++, (cl_uint)resetHeads);
+                    queue->enqueueKernel(addKernel, 1, globalWorkSizes, localWorkSizes);
+                }
+
+                delete sums;
+                delete sumHeads;
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(buffer, result, 0, size * sizeof(T));
+                delete buffer;
+                delete heads;
+            }
+
+            void cleanup() override
+            {
+                delete kernel;
+                delete addKernel;
+            }
+
+            virtual ~GenericRecursiveVecScan() {}
+
+        protected:
+            /**
+            * Build options of the kernels. Overwrite to scan with a custom OP(a, b) and IDENTITY, which have to match getOperator for the verification.
+            */
+            virtual string getOptions()
+            {
+                return getScanOperatorOptions<T>(Op) + (Segmented ? " -D SEGMENTED" : "");
+            }
+
+        private:
+            size_t bufferSize;
+            Kernel* kernel;
+            Kernel* addKernel;
+            Buffer* buffer;
+            Buffer* heads;
+            vector<cl_uint> headFlags;
+        };
+    }
+}
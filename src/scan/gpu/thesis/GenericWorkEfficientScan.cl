@@ -0,0 +1,54 @@
+// Generic version of WorkEfficientScan.cl. The element type T, the associative operator OP(a, b) and its IDENTITY are given as build options.
+// With SEGMENTED defined the sweeps combine (flag, value) pairs like GenericRecursiveVecScan.cl, treeFlags is a copy of the head flags modified by the sweeps.
+
+#ifdef SEGMENTED
+#define FLAGS_ARG __global uint* treeFlags,
+#else
+#define FLAGS_ARG
+#endif
+
+__kernel void UpSweep(__global T* buffer, FLAGS_ARG uint offset) {
+	uint stride = offset << 1;
+	uint id = (get_global_id(0) + 1) * stride - 1;
+
+#ifdef SEGMENTED
+	if (!treeFlags[id])
+		buffer[id] = OP(buffer[id - offset], buffer[id]);
+	treeFlags[id] |= treeFlags[id - offset];
+#else
+	buffer[id] = OP(buffer[id - offset], buffer[id]);
+#endif
+} // UpSweep
+
+__kernel void ClearLast(__global T* buffer, FLAGS_ARG uint last) {
+	buffer[last] = IDENTITY;
+#ifdef SEGMENTED
+	treeFlags[last] = 0;
+#endif
+} // ClearLast
+
+__kernel void DownSweep(__global T* buffer, FLAGS_ARG uint offset) {
+	uint stride = offset << 1;
+	uint id = (get_global_id(0) + 1) * stride - 1;
+
+	T val = buffer[id];
+#ifdef SEGMENTED
+	uint flag = treeFlags[id];
+	uint leftFlag = treeFlags[id - offset];
+	buffer[id] = leftFlag ? buffer[id - offset] : OP(val, buffer[id - offset]);
+	treeFlags[id] = flag | leftFlag;
+	treeFlags[id - offset] = flag;
+#else
+	buffer[id] = OP(val, buffer[id - offset]);
+#endif
+	buffer[id - offset] = val;
+} // DownSweep
+
+#ifdef SEGMENTED
+// the sweeps leave the scan of the previous segment at the heads
+__kernel void ResetHeads(__global T* buffer, __global uint* heads) {
+	uint id = get_global_id(0);
+	if (heads[id])
+		buffer[id] = IDENTITY;
+} // ResetHeads
+#endif
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+
+#include "../../ScanAlgorithm.h"
+#include "../../ScanOperator.h"
+#include "../../../common/CLAlgorithm.h"
+
+#include "../../../common/utils.h"
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * WorkEfficientScan for any element type and associative operator, optionally segmented by the head flags of ScanAlgorithm::isSegmentHead.
+        */
+        template<typename T, ScanOperator Op = ScanOperator::Add, bool Segmented = false>
+        class GenericWorkEfficientScan : public CLAlgorithm<T>, public ScanAlgorithm
+        {
+        public:
+            const string getName() override
+            {
+                return "Generic Work Efficient Scan WI (THESIS dixxi GPU Gems) (exclusiv) (" + scanOperatorToString(Op) + ")" + string(Segmented ? " (segmented)" : "");
+            }
+
+            bool isInclusiv() override
+            {
+                return false;
+            }
+
+            ScanOperator getOperator() override
+            {
+                return Op;
+            }
+
+            bool isSegmented() override
+            {
+                return Segmented;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/GenericWorkEfficientScan.cl", getOptions());
+                upSweepKernel = program->createKernel("UpSweep");
+                clearLastKernel = program->createKernel("ClearLast");
+                downSweepKernel = program->createKernel("DownSweep");
+                resetHeadsKernel = Segmented ? program->createKernel("ResetHeads") : nullptr;
+                delete program;
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                bufferSize = roundToPowerOfTwo(size);
+
+                buffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                queue->enqueueWrite(buffer, data, 0, size * sizeof(T));
+
+                heads = nullptr;
+                treeFlags = nullptr;
+                if(Segmented)
+                {
+                    fillSegmentHeads(headFlags, size);
+
+                    heads = context->createBuffer(CL_MEM_READ_ONLY, bufferSize * sizeof(cl_uint));
+                    queue->enqueueWrite(heads, headFlags.data(), 0, size * sizeof(cl_uint));
+                    treeFlags = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(cl_uint));
+                }
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                // the sweeps modify the flags, so they start from a copy of the heads
+                if(Segmented)
+                    queue->enqueueCopy(heads, treeFlags);
+
+                // upsweep (reduce)
+                for(size_t offset = 1, nodes = bufferSize >> 1; offset < bufferSize; offset <<= 1, nodes >>= 1)
+                {
+                    setArgs(upSweepKernel, (cl_uint)offset);
+
+                    size_t globalWorkSizes[] = { nodes };
+                    size_t localWorkSizes[] = { min(workGroupSize, nodes) };
+
+                    queue->enqueueKernel(upSweepKernel, 1, globalWorkSizes, localWorkSizes);
+                }
+
+                // set last element to the identity
+                setArgs(clearLastKernel, (cl_uint)(bufferSize - 1));
+
+                size_t one[] = { 1 };
+                queue->enqueueKernel(clearLastKernel, 1, one, one);
+
+                // downsweep
+                for(size_t offset = bufferSize >> 1, nodes = 1; offset >= 1; offset >>= 1, nodes <<= 1)
+                {
+                    setArgs(downSweepKernel, (cl_uint)offset);
+
+                    size_t globalWorkSizes[] = { nodes };
+                    size_t localWorkSizes[] = { min(workGroupSize, nodes) };
+
+                    queue->enqueueKernel(downSweepKernel, 1, globalWorkSizes, localWorkSizes);
+                }
+
+                if(Segmented)
+                {
+                    resetHeadsKernel->setArg(0, buffer);
+                    resetHeadsKernel->setArg(1, heads);
+
+                    size_t globalWorkSizes[] = { bufferSize };
+                    size_t localWorkSizes[] = { min(workGroupSize, bufferSize) };
+
+                    queue->enqueueKernel(resetHeadsKernel, 1, globalWorkSizes, localWorkSizes);
+                }
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(buffer, result, 0, size * sizeof(T));
+                delete buffer;
+                delete heads;
+                delete treeFlags;
+            }
+
+            void cleanup() override
+            {
+                delete upSweepKernel;
+                delete clearLastKernel;
+                delete downSweepKernel;
+                delete resetHeadsKernel;
+            }
+
+            virtual ~GenericWorkEfficientScan() {}
+
+        protected:
+            /**
+            * Build options of the kernels. Overwrite to scan with a custom OP(a, b) and IDENTITY, which have to match getOperator for the verification.
+            */
+            virtual string getOptions()
+            {
+                return getScanOperatorOptions<T>(Op) + (Segmented ? " -D SEGMENTED" : "");
+            }
+
+        private:
+            /**
+            * Sets the buffer, the tree flags of a segmented scan and the last argument of the sweep kernels.
+            */
+            void setArgs(Kernel* kernel, cl_uint value)
+            {
+                cl_uint arg = 0;
+                kernel->setArg(arg++, buffer);
+                if(Segmented)
+                    kernel->setArg(arg++, treeFlags);
+                kernel->setArg(arg++, value);
+            }
+
+            size_t bufferSize;
+            Kernel* upSweepKernel;
+            Kernel* clearLastKernel;
+            Kernel* downSweepKernel;
+            Kernel* resetHeadsKernel;
+            Buffer* buffer;
+            Buffer* heads;
+            Buffer* treeFlags;
+            vector<cl_uint> headFlags;
+        };
+    }
+}
@@ -0,0 +1,61 @@
+// Histograms of values which are the indices of their bins. Every kernel loops over the values with the stride of the whole grid,
+// so a fixed number of work groups handles any number of values, and adds the counts of its group to the global bins.
+// The global bins have to be cleared before.
+
+// Every work item counts into its own histogram in local memory without atomics. The histograms are interleaved,
+// bin b of work item i is at b * localSize + i, so neighbouring work items always access different banks.
+__kernel void HistogramPrivate(__global uint* values, __global uint* bins, __local uint* hist, uint binCount, uint size) {
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+
+	for (uint b = 0; b < binCount; b++)
+		hist[b * localSize + localId] = 0;
+
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		hist[values[i] * localSize + localId]++;
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// every work item adds up some bins over all histograms, starting at a different histogram to spread the banks
+	for (uint b = localId; b < binCount; b += localSize) {
+		uint sum = 0;
+		for (uint j = 0; j < localSize; j++)
+			sum += hist[b * localSize + (j + localId) % localSize];
+		if (sum > 0)
+			atomic_add(&bins[b], sum);
+	}
+} // HistogramPrivate
+
+// Every work group counts into replicas of its histogram in local memory with local atomics. Consecutive work items use
+// different replicas, so equal values of a skewed input do not all contend for the same counter. The replicas are
+// binCount + 1 apart, so the same bin of different replicas lies in different banks.
+__kernel void HistogramLocal(__global uint* values, __global uint* bins, __local uint* hist, uint binCount, uint replicas, uint size) {
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+	uint stride = binCount + 1;
+
+	for (uint i = localId; i < replicas * stride; i += localSize)
+		hist[i] = 0;
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	__local uint* replica = hist + (localId % replicas) * stride;
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		atomic_inc(&replica[values[i]]);
+
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	for (uint b = localId; b < binCount; b += localSize) {
+		uint sum = 0;
+		for (uint r = 0; r < replicas; r++)
+			sum += hist[r * stride + b];
+		if (sum > 0)
+			atomic_add(&bins[b], sum);
+	}
+} // HistogramLocal
+
+// Every value is counted with a global atomic, for bin counts whose histogram does not fit into local memory.
+__kernel void HistogramGlobal(__global uint* values, __global uint* bins, uint size) {
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		atomic_inc(&bins[values[i]]);
+} // HistogramGlobal
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+
+#include "../../HistogramAlgorithm.h"
+#include "../../../common/CLAlgorithm.h"
+
+#include "../../../common/utils.h"
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Where the kernels in Histogram.cl count the values.
+        */
+        enum class HistogramStrategy
+        {
+            Private, // a histogram per work item in local memory, for few bins
+            Local,   // replicated histograms per work group in local memory with local atomics
+            Global   // global atomics, for histograms not fitting into local memory
+        };
+
+        /**
+        * Base of the histograms in Histogram.cl, the variants choose the strategy.
+        * A fixed number of work groups per compute unit loops over the values, so the counts of a group are only added to the global bins once.
+        */
+        template<typename T>
+        class Histogram : public CLAlgorithm<T>, public HistogramAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+            static const size_t GROUPS_PER_COMPUTE_UNIT = 8;
+            static const size_t MAX_REPLICAS = 16;
+
+        public:
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/Histogram.cl");
+                privateKernel = program->createKernel("HistogramPrivate");
+                localKernel = program->createKernel("HistogramLocal");
+                globalKernel = program->createKernel("HistogramGlobal");
+                delete program;
+
+                localMemorySize = (size_t)context->getInfo<cl_ulong>(CL_DEVICE_LOCAL_MEM_SIZE);
+                computeUnits = context->getInfo<cl_uint>(CL_DEVICE_MAX_COMPUTE_UNITS);
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                binCount = getBinCount(data);
+
+                valueBuffer = context->createBuffer(CL_MEM_READ_ONLY, size * sizeof(T));
+                queue->enqueueWrite(valueBuffer, getValues(data), 0, size * sizeof(T));
+
+                binBuffer = context->createBuffer(CL_MEM_READ_WRITE, binCount * sizeof(cl_uint));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                queue->enqueueFill(binBuffer, (cl_uint)0, 0, binCount * sizeof(cl_uint));
+
+                Kernel* kernel = nullptr;
+                size_t localSize = workGroupSize;
+
+                switch(getStrategy())
+                {
+                case HistogramStrategy::Private:
+                    // shrink the group until the histograms of all work items fit into local memory
+                    while(localSize > 1 && localSize * binCount * sizeof(cl_uint) > localMemorySize)
+                        localSize >>= 1;
+
+                    kernel = privateKernel;
+                    kernel->setArg(0, valueBuffer);
+                    kernel->setArg(1, binBuffer);
+                    kernel->setArg(2, localSize * binCount * sizeof(cl_uint), nullptr);
+                    kernel->setArg(3, (cl_uint)binCount);
+                    kernel->setArg(4, (cl_uint)size);
+                    break;
+                case HistogramStrategy::Local:
+                {
+                    // as many replicas as fit into local memory, each replica is padded by one bin
+                    size_t replicas = min(min((size_t)MAX_REPLICAS, workGroupSize), localMemorySize / ((binCount + 1) * sizeof(cl_uint)));
+                    replicas = max(replicas, (size_t)1);
+
+                    kernel = localKernel;
+                    kernel->setArg(0, valueBuffer);
+                    kernel->setArg(1, binBuffer);
+                    kernel->setArg(2, replicas * (binCount + 1) * sizeof(cl_uint), nullptr);
+                    kernel->setArg(3, (cl_uint)binCount);
+                    kernel->setArg(4, (cl_uint)replicas);
+                    kernel->setArg(5, (cl_uint)size);
+                    break;
+                }
+                case HistogramStrategy::Global:
+                    kernel = globalKernel;
+                    kernel->setArg(0, valueBuffer);
+                    kernel->setArg(1, binBuffer);
+                    kernel->setArg(2, (cl_uint)size);
+                    break;
+                }
+
+                size_t groups = min((size + localSize - 1) / localSize, computeUnits * GROUPS_PER_COMPUTE_UNIT);
+
+                size_t globalWorkSizes[] = { groups * localSize };
+                size_t localWorkSizes[] = { localSize };
+
+                queue->enqueueKernel(kernel, 1, globalWorkSizes, localWorkSizes);
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(binBuffer, result, 0, binCount * sizeof(T));
+
+                delete valueBuffer;
+                delete binBuffer;
+            }
+
+            void cleanup() override
+            {
+                delete privateKernel;
+                delete localKernel;
+                delete globalKernel;
+            }
+
+            virtual ~Histogram() {}
+
+        protected:
+            /**
+            * Strategy for the bin count of the current input.
+            */
+            virtual HistogramStrategy getStrategy() = 0;
+
+            size_t binCount;
+            size_t localMemorySize;
+
+        private:
+            Kernel* privateKernel;
+            Kernel* localKernel;
+            Kernel* globalKernel;
+
+            size_t computeUnits;
+
+            Buffer* valueBuffer;
+            Buffer* binBuffer;
+        };
+
+        /**
+        * A private histogram per work item, the work groups shrink with the number of bins. Only suitable for few bins.
+        */
+        template<typename T>
+        class HistogramPrivate : public Histogram<T>
+        {
+        public:
+            const string getName() override
+            {
+                return "Histogram Private (THESIS per work item)";
+            }
+
+        protected:
+            HistogramStrategy getStrategy() override
+            {
+                return HistogramStrategy::Private;
+            }
+        };
+
+        /**
+        * Replicated histograms per work group with local atomics. The histogram has to fit into local memory.
+        */
+        template<typename T>
+        class HistogramLocal : public Histogram<T>
+        {
+        public:
+            const string getName() override
+            {
+                return "Histogram Local (THESIS replicated local atomics)";
+            }
+
+        protected:
+            HistogramStrategy getStrategy() override
+            {
+                return HistogramStrategy::Local;
+            }
+        };
+
+        /**
+        * Global atomics for every value, works for any number of bins.
+        */
+        template<typename T>
+        class HistogramGlobal : public Histogram<T>
+        {
+        public:
+            const string getName() override
+            {
+                return "Histogram Global (THESIS global atomics)";
+            }
+
+        protected:
+            HistogramStrategy getStrategy() override
+            {
+                return HistogramStrategy::Global;
+            }
+        };
+
+        /**
+        * Selects the strategy by the number of bins: private histograms for up to PRIVATE_MAX_BINS bins,
+        * local histograms as long as one fits into local memory and global atomics beyond.
+        */
+        template<typename T>
+        class HistogramAuto : public Histogram<T>
+        {
+            static const size_t PRIVATE_MAX_BINS = 64;
+
+        public:
+            const string getName() override
+            {
+                return "Histogram (THESIS strategy by bin count)";
+            }
+
+        protected:
+            HistogramStrategy getStrategy() override
+            {
+                if(this->binCount <= PRIVATE_MAX_BINS)
+                    return HistogramStrategy::Private;
+                if((this->binCount + 1) * sizeof(cl_uint) <= this->localMemorySize)
+                    return HistogramStrategy::Local;
+                return HistogramStrategy::Global;
+            }
+        };
+    }
+}
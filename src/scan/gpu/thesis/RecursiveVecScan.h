@@ -45,6 +45,14 @@ namespace gpu
                 return false;
             }
 
+            /**
+            * The size run_r has to be called with, for scanning size elements of an other algorithm's buffer.
+            */
+            static size_t getPaddedSize(size_t workGroupSize, size_t size)
+            {
+                return roundToMultiple(size, workGroupSize * 2 * VECTOR_WIDTH);
+            }
+
             void init() override
             {
                 stringstream ss;
@@ -56,7 +64,7 @@ namespace gpu
 
             void upload(size_t workGroupSize, T* data, size_t size) override
             {
-                bufferSize = roundToMultiple(size, workGroupSize * 2 * VECTOR_WIDTH);
+                bufferSize = getPaddedSize(workGroupSize, size);
 
                 buffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
                 queue->enqueueWrite(buffer, data, 0, size * sizeof(T));
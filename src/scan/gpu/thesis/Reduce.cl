@@ -0,0 +1,181 @@
+// Reductions of the element type T with OP(a, b) and IDENTITY given as build options, see ScanOperator.h.
+// With ARGMAX defined the kernels reduce (value, index) pairs R to the first index of the maximum.
+// The first level reads the elements, with PARTIALS defined the kernels read the results of a previous level instead.
+// Every kernel writes one result per work group.
+
+#ifdef FP64
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#ifdef INT64_ATOMICS
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+#endif
+
+#define CONCAT(a, b) a ## b
+#define CONCAT_EXP(a, b) CONCAT(a, b)
+
+#define T4 CONCAT_EXP(T, 4)
+
+#ifdef ARGMAX
+typedef struct {
+	T value;
+	uint index;
+} R;
+
+inline R make(T value, uint index) {
+	R r;
+	r.value = value;
+	r.index = index;
+	return r;
+}
+
+inline R combine(R a, R b) {
+	return (b.value > a.value || (b.value == a.value && b.index < a.index)) ? b : a;
+}
+
+#define EMPTY make(IDENTITY, UINT_MAX)
+#else
+typedef T R;
+
+inline R make(T value, uint index) {
+	return value;
+}
+
+inline R combine(R a, R b) {
+	return OP(a, b);
+}
+
+#define EMPTY IDENTITY
+#endif
+
+#ifdef PARTIALS
+typedef R IN;
+#define LOAD(input, i) input[i]
+#else
+typedef T IN;
+#define LOAD(input, i) make(input[i], i)
+#endif
+
+// tree with sequential addressing, returns the result of the work group in every work item
+inline R ReduceLocal(__local R* shared, R value) {
+	uint localId = get_local_id(0);
+
+	shared[localId] = value;
+	for (uint s = get_local_size(0) / 2; s > 0; s >>= 1) {
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId < s)
+			shared[localId] = combine(shared[localId], shared[localId + s]);
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	return shared[0];
+} // ReduceLocal
+
+// tree with interleaved addressing, every work item loads one element
+__kernel void ReduceInterleaved(__global const IN* input, __global R* partials, __local R* shared, uint size) {
+	uint localId = get_local_id(0);
+	uint globalId = get_global_id(0);
+
+	shared[localId] = globalId < size ? LOAD(input, globalId) : EMPTY;
+
+	for (uint s = 1; s < get_local_size(0); s <<= 1) {
+		barrier(CLK_LOCAL_MEM_FENCE);
+		if (localId % (2 * s) == 0)
+			shared[localId] = combine(shared[localId], shared[localId + s]);
+	}
+
+	if (localId == 0)
+		partials[get_group_id(0)] = shared[0];
+} // ReduceInterleaved
+
+// tree with sequential addressing, every work item loads one element
+__kernel void ReduceSequential(__global const IN* input, __global R* partials, __local R* shared, uint size) {
+	uint globalId = get_global_id(0);
+
+	R result = ReduceLocal(shared, globalId < size ? LOAD(input, globalId) : EMPTY);
+
+	if (get_local_id(0) == 0)
+		partials[get_group_id(0)] = result;
+} // ReduceSequential
+
+// every work item first reduces the elements of a grid stride loop sequentially
+__kernel void ReduceMultiple(__global const IN* input, __global R* partials, __local R* shared, uint size) {
+	R value = EMPTY;
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		value = combine(value, LOAD(input, i));
+
+	R result = ReduceLocal(shared, value);
+
+	if (get_local_id(0) == 0)
+		partials[get_group_id(0)] = result;
+} // ReduceMultiple
+
+#ifndef PARTIALS
+// like ReduceMultiple, but loads vectors of 4 elements
+__kernel void ReduceVector(__global const T* input, __global R* partials, __local R* shared, uint size) {
+	uint vectors = size / 4;
+
+#ifdef ARGMAX
+	R value = EMPTY;
+	for (uint v = get_global_id(0); v < vectors; v += get_global_size(0)) {
+		T4 x = vload4(v, input);
+		value = combine(value, make(x.s0, 4 * v + 0));
+		value = combine(value, make(x.s1, 4 * v + 1));
+		value = combine(value, make(x.s2, 4 * v + 2));
+		value = combine(value, make(x.s3, 4 * v + 3));
+	}
+#else
+	T4 vectorValue = (T4)(IDENTITY);
+	for (uint v = get_global_id(0); v < vectors; v += get_global_size(0))
+		vectorValue = OP(vectorValue, vload4(v, input));
+	R value = OP(OP(vectorValue.s0, vectorValue.s1), OP(vectorValue.s2, vectorValue.s3));
+#endif
+
+	// the elements behind the last vector
+	uint i = vectors * 4 + get_global_id(0);
+	if (i < size)
+		value = combine(value, make(input[i], i));
+
+	R result = ReduceLocal(shared, value);
+
+	if (get_local_id(0) == 0)
+		partials[get_group_id(0)] = result;
+} // ReduceVector
+#endif
+
+#if !defined(PARTIALS) && !defined(ARGMAX)
+#ifdef INT64_ATOMICS
+#define ATOMIC_BITS ulong
+#define ATOMIC_CMPXCHG atom_cmpxchg
+#else
+#define ATOMIC_BITS uint
+#define ATOMIC_CMPXCHG atomic_cmpxchg
+#endif
+
+// like ReduceMultiple, but every work group combines its result with the one in result[0] by an atomic compare and swap, which works for any operator
+__kernel void ReduceAtomic(__global const T* input, __global T* result, __local R* shared, uint size) {
+	R value = EMPTY;
+	for (uint i = get_global_id(0); i < size; i += get_global_size(0))
+		value = combine(value, input[i]);
+
+	value = ReduceLocal(shared, value);
+
+	if (get_local_id(0) == 0) {
+		volatile __global ATOMIC_BITS* target = (volatile __global ATOMIC_BITS*)result;
+
+		union {
+			T value;
+			ATOMIC_BITS bits;
+		} expected, desired;
+
+		expected.bits = *target;
+		for (;;) {
+			desired.value = OP(expected.value, value);
+			ATOMIC_BITS previous = ATOMIC_CMPXCHG(target, expected.bits, desired.bits);
+			if (previous == expected.bits)
+				break;
+			expected.bits = previous;
+		}
+	}
+} // ReduceAtomic
+#endif
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <type_traits>
+
+#include "../../ReduceAlgorithm.h"
+#include "../../../common/CLAlgorithm.h"
+
+#include "../../../common/utils.h"
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Base of the reductions in Reduce.cl. Every level reduces the elements of a work group into one partial result,
+        * the levels are repeated on the partial results until one is left.
+        * The variants choose the kernels and how many elements a work item reduces.
+        */
+        template<typename T, ReduceOperator Op>
+        class Reduce : public CLAlgorithm<T>, public ReduceAlgorithm
+        {
+            static_assert(is_same<T, cl_int>::value || is_same<T, cl_float>::value || is_same<T, cl_double>::value, "Reductions only support int, float and double");
+
+        protected:
+            /// partial result of a work group, has the layout of R in Reduce.cl
+            typedef typename conditional<Op == ReduceOperator::ArgMax, ReducePair<T>, T>::type R;
+
+        public:
+            ReduceOperator getOperator() override
+            {
+                return Op;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/Reduce.cl", getOptions());
+                kernel = program->createKernel(getKernelName());
+                delete program;
+
+                partialsKernel = nullptr;
+                if(!getPartialsKernelName().empty())
+                {
+                    program = context->createProgram("gpu/thesis/Reduce.cl", getOptions() + " -D PARTIALS");
+                    partialsKernel = program->createKernel(getPartialsKernelName());
+                    delete program;
+                }
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                buffer = context->createBuffer(CL_MEM_READ_ONLY, size * sizeof(T));
+                queue->enqueueWrite(buffer, data);
+
+                // the levels alternate between the partial buffers, every level is smaller than the one before
+                size_t groups = getGroupCount(workGroupSize, size);
+                partials[0] = context->createBuffer(CL_MEM_READ_WRITE, groups * sizeof(R));
+                partials[1] = context->createBuffer(CL_MEM_READ_WRITE, getGroupCount(workGroupSize, groups) * sizeof(R));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                Kernel* levelKernel = kernel;
+                Buffer* input = buffer;
+                int level = 0;
+
+                do
+                {
+                    size_t groups = getGroupCount(workGroupSize, size);
+
+                    levelKernel->setArg(0, input);
+                    levelKernel->setArg(1, partials[level % 2]);
+                    levelKernel->setArg(2, workGroupSize * sizeof(R), nullptr);
+                    levelKernel->setArg(3, (cl_uint)size);
+
+                    size_t globalWorkSizes[] = { groups * workGroupSize };
+                    size_t localWorkSizes[] = { workGroupSize };
+
+                    queue->enqueueKernel(levelKernel, 1, globalWorkSizes, localWorkSizes);
+
+                    // the following levels reduce the partial results of this one
+                    levelKernel = partialsKernel;
+                    input = partials[level % 2];
+                    size = groups;
+                    level++;
+                } while(size > 1);
+
+                resultBuffer = input;
+            }
+
+            void download(T* result, size_t size) override
+            {
+                R value;
+                queue->enqueueRead(resultBuffer, &value, 0, sizeof(R));
+                store(result, value);
+
+                delete buffer;
+                delete partials[0];
+                delete partials[1];
+            }
+
+            void cleanup() override
+            {
+                delete kernel;
+                delete partialsKernel;
+            }
+
+            virtual ~Reduce() {}
+
+        protected:
+            /**
+            * Name of the kernel of the first level, which reads the elements.
+            */
+            virtual const string getKernelName() = 0;
+
+            /**
+            * Name of the kernel of the following levels, which read the partial results. Empty if there are no following levels.
+            */
+            virtual const string getPartialsKernelName()
+            {
+                return getKernelName();
+            }
+
+            /**
+            * Number of work groups of a level reducing size elements.
+            */
+            virtual size_t getGroupCount(size_t workGroupSize, size_t size)
+            {
+                return (size + workGroupSize * getElementsPerItem() - 1) / (workGroupSize * getElementsPerItem());
+            }
+
+            virtual size_t getElementsPerItem()
+            {
+                return 1;
+            }
+
+            virtual string getOptions()
+            {
+                string options = getScanOperatorOptions<T>(toScanOperator(Op));
+                if(Op == ReduceOperator::ArgMax)
+                    options += " -D ARGMAX";
+                if(is_same<T, cl_double>::value)
+                    options += " -D FP64";
+                if(sizeof(T) == 8)
+                    options += " -D INT64_ATOMICS";
+                return options;
+            }
+
+            static void store(T* result, const T& value)
+            {
+                result[0] = value;
+            }
+
+            static void store(T* result, const ReducePair<T>& pair)
+            {
+                result[0] = pair.value;
+                getIndex(result) = pair.index;
+            }
+
+            Kernel* kernel;
+            Kernel* partialsKernel;
+
+            Buffer* buffer;
+            Buffer* partials[2];
+            Buffer* resultBuffer;
+        };
+
+        /**
+        * Tree in local memory with interleaved addressing, the first kernel of: Mark Harris, Optimizing Parallel Reduction in CUDA
+        */
+        template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+        class ReduceInterleaved : public Reduce<T, Op>
+        {
+        public:
+            const string getName() override
+            {
+                return "Reduce Interleaved (THESIS) (" + reduceOperatorToString(Op) + ")";
+            }
+
+        protected:
+            const string getKernelName() override
+            {
+                return "ReduceInterleaved";
+            }
+        };
+
+        /**
+        * Tree in local memory with sequential addressing, the active work items stay contiguous and access consecutive local memory.
+        */
+        template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+        class ReduceSequential : public Reduce<T, Op>
+        {
+        public:
+            const string getName() override
+            {
+                return "Reduce Sequential (THESIS) (" + reduceOperatorToString(Op) + ")";
+            }
+
+        protected:
+            const string getKernelName() override
+            {
+                return "ReduceSequential";
+            }
+        };
+
+        /**
+        * Every work item reduces ELEMENTS_PER_ITEM elements sequentially before the tree, so the levels shrink faster.
+        */
+        template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+        class ReduceMultiple : public Reduce<T, Op>
+        {
+            static const size_t ELEMENTS_PER_ITEM = 16;
+
+        public:
+            const string getName() override
+            {
+                return "Reduce Multiple (THESIS) (" + reduceOperatorToString(Op) + ")";
+            }
+
+        protected:
+            const string getKernelName() override
+            {
+                return "ReduceMultiple";
+            }
+
+            size_t getElementsPerItem() override
+            {
+                return ELEMENTS_PER_ITEM;
+            }
+        };
+
+        /**
+        * Like ReduceMultiple, but the first level loads vectors of 4 elements.
+        */
+        template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+        class ReduceVector : public Reduce<T, Op>
+        {
+            static const size_t ELEMENTS_PER_ITEM = 16;
+
+        public:
+            const string getName() override
+            {
+                return "Reduce Vector (THESIS) (" + reduceOperatorToString(Op) + ")";
+            }
+
+        protected:
+            const string getKernelName() override
+            {
+                return "ReduceVector";
+            }
+
+            // the partial results are no vectors
+            const string getPartialsKernelName() override
+            {
+                return "ReduceMultiple";
+            }
+
+            size_t getElementsPerItem() override
+            {
+                return ELEMENTS_PER_ITEM;
+            }
+        };
+
+        /**
+        * Exactly two levels: at most as many work groups as a work group has items reduce the elements in a grid stride loop, a single work group reduces their results.
+        */
+        template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+        class ReduceTwoLevel : public Reduce<T, Op>
+        {
+        public:
+            const string getName() override
+            {
+                return "Reduce Two Level (THESIS) (" + reduceOperatorToString(Op) + ")";
+            }
+
+        protected:
+            const string getKernelName() override
+            {
+                return "ReduceMultiple";
+            }
+
+            size_t getGroupCount(size_t workGroupSize, size_t size) override
+            {
+                return min(workGroupSize, (size + workGroupSize - 1) / workGroupSize);
+            }
+        };
+
+        /**
+        * A single level like ReduceMultiple, every work group combines its result into the final one with an atomic compare and swap.
+        */
+        template<typename T, ReduceOperator Op = ReduceOperator::Sum>
+        class ReduceAtomic : public Reduce<T, Op>
+        {
+            static_assert(Op != ReduceOperator::ArgMax, "The atomic finish does not support ArgMax");
+
+            static const size_t ELEMENTS_PER_ITEM = 16;
+
+        public:
+            const string getName() override
+            {
+                return "Reduce Atomic (THESIS) (" + reduceOperatorToString(Op) + ")";
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                T identity = (T)ScanTraits<T>::identity(toScanOperator(Op));
+                queue->enqueueWrite(this->partials[0], &identity, 0, sizeof(T));
+
+                this->kernel->setArg(0, this->buffer);
+                this->kernel->setArg(1, this->partials[0]);
+                this->kernel->setArg(2, workGroupSize * sizeof(T), nullptr);
+                this->kernel->setArg(3, (cl_uint)size);
+
+                size_t globalWorkSizes[] = { this->getGroupCount(workGroupSize, size) * workGroupSize };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                queue->enqueueKernel(this->kernel, 1, globalWorkSizes, localWorkSizes);
+
+                this->resultBuffer = this->partials[0];
+            }
+
+        protected:
+            const string getKernelName() override
+            {
+                return "ReduceAtomic";
+            }
+
+            const string getPartialsKernelName() override
+            {
+                return "";
+            }
+
+            size_t getElementsPerItem() override
+            {
+                return ELEMENTS_PER_ITEM;
+            }
+        };
+    }
+}
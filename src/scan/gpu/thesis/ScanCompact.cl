@@ -0,0 +1,22 @@
+// an element is kept when it is smaller than the threshold, the padding behind size is never kept
+__kernel void Flag(__global uint* elements, __global int* flags, uint threshold, uint size) {
+	uint id = get_global_id(0);
+
+	flags[id] = id < size && elements[id] < threshold;
+} // Flag
+
+// flags holds the exclusive scan of the kept flags, so the number of kept elements before every element.
+// The other elements before an element are the remaining ones, they are written behind all kept elements
+__kernel void Scatter(__global uint* elements, __global int* flags, __global uint* result, uint threshold, uint size) {
+	uint id = get_global_id(0);
+	if (id >= size)
+		return;
+
+	uint count = flags[size - 1] + (elements[size - 1] < threshold);
+	if (id == 0)
+		result[0] = count;
+
+	uint value = elements[id];
+	uint kept = flags[id];
+	result[1 + (value < threshold ? kept : count + id - kept)] = value;
+} // Scatter
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../../CompactAlgorithm.h"
+#include "../../../common/CLAlgorithm.h"
+#include "RecursiveVecScan.h"
+
+#include "../../../common/utils.h"
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Stable compaction in three steps: the kept elements are flagged, the flags are scanned by the RecursiveVecScan and every element is scattered to its position.
+        */
+        template<typename T>
+        class ScanCompact : public CLAlgorithm<T>, public CompactAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+        public:
+            const string getName() override
+            {
+                return "Scan Compact (THESIS Recursive Vec Scan)";
+            }
+
+            const vector<size_t> getSupportedWorkGroupSizes() const override
+            {
+                // the scan does not allow a work group size of 1
+                auto sizes = CLAlgorithm<T>::getSupportedWorkGroupSizes();
+                sizes.erase(remove_if(begin(sizes), end(sizes), [](size_t size) { return size < 2; }), sizes.end());
+                return sizes;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/ScanCompact.cl");
+                flagKernel = program->createKernel("Flag");
+                scatterKernel = program->createKernel("Scatter");
+                delete program;
+
+                scan.setContext(context);
+                scan.setCommandQueue(queue);
+                scan.init();
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                threshold = getThreshold(data);
+                flagsSize = RecursiveVecScan<cl_int>::getPaddedSize(workGroupSize, size);
+
+                elementBuffer = context->createBuffer(CL_MEM_READ_ONLY, size * sizeof(T));
+                queue->enqueueWrite(elementBuffer, getElements(data), 0, size * sizeof(T));
+
+                flagBuffer = context->createBuffer(CL_MEM_READ_WRITE, flagsSize * sizeof(cl_int));
+                resultBuffer = context->createBuffer(CL_MEM_WRITE_ONLY, (1 + size) * sizeof(T));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                flagKernel->setArg(0, elementBuffer);
+                flagKernel->setArg(1, flagBuffer);
+                flagKernel->setArg(2, threshold);
+                flagKernel->setArg(3, (cl_uint)size);
+
+                size_t globalWorkSizes[] = { flagsSize };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                queue->enqueueKernel(flagKernel, 1, globalWorkSizes, localWorkSizes);
+
+                scan.run_r(workGroupSize, flagBuffer, flagsSize);
+
+                scatterKernel->setArg(0, elementBuffer);
+                scatterKernel->setArg(1, flagBuffer);
+                scatterKernel->setArg(2, resultBuffer);
+                scatterKernel->setArg(3, threshold);
+                scatterKernel->setArg(4, (cl_uint)size);
+
+                globalWorkSizes[0] = roundToMultiple(size, workGroupSize);
+
+                queue->enqueueKernel(scatterKernel, 1, globalWorkSizes, localWorkSizes);
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(resultBuffer, result, 0, (1 + size) * sizeof(T));
+
+                delete elementBuffer;
+                delete flagBuffer;
+                delete resultBuffer;
+            }
+
+            void cleanup() override
+            {
+                delete flagKernel;
+                delete scatterKernel;
+                scan.cleanup();
+            }
+
+            virtual ~ScanCompact() {}
+
+        private:
+            Kernel* flagKernel;
+            Kernel* scatterKernel;
+
+            T threshold;
+            size_t flagsSize;
+
+            Buffer* elementBuffer;
+            Buffer* flagBuffer;
+            Buffer* resultBuffer;
+
+            RecursiveVecScan<cl_int> scan;
+        };
+    }
+}
@@ -6,8 +6,14 @@
 
 #include "../common/Runner.h"
 #include "ScanPlugin.h"
+#include "CompactPlugin.h"
+#include "ReducePlugin.h"
+#include "HistogramPlugin.h"
 
 #include "cpu/Scan.h"
+#include "cpu/Compact.h"
+#include "cpu/Reduce.h"
+#include "cpu/Histogram.h"
 #include "gpu/clpp/Scan.h"
 #include "gpu/gpugems/LocalNaiveScan.h"
 #include "gpu/gpugems/LocalWorkEfficientScan.h"
@@ -24,14 +30,195 @@
 #include "gpu/thesis/WorkEfficientScan.h"
 #include "gpu/thesis/RecursiveScan.h"
 #include "gpu/thesis/RecursiveVecScan.h"
+#include "gpu/thesis/GenericWorkEfficientScan.h"
+#include "gpu/thesis/GenericRecursiveVecScan.h"
+#include "gpu/thesis/ScanCompact.h"
+#include "gpu/thesis/FusedCompact.h"
+#include "gpu/thesis/Reduce.h"
+#include "gpu/thesis/Histogram.h"
 
 using namespace std;
 
 #define MAX_POWER_OF_TWO 26
 #define RESOLUTION 5
 
-int main()
+/**
+* Binds the operator and the segmentation of the generic scans, so they can be passed to Runner::run.
+*/
+template <ScanOperator Op, bool Segmented>
+struct GenericScans
 {
+    template <typename T>
+    using WorkEfficientScan = gpu::thesis::GenericWorkEfficientScan<T, Op, Segmented>;
+
+    template <typename T>
+    using RecursiveVecScan = gpu::thesis::GenericRecursiveVecScan<T, Op, Segmented>;
+};
+
+template <typename T, ScanOperator Op>
+void runGenericScans(Runner<T, ScanPlugin>& runner)
+{
+    runner.template run<GenericScans<Op, false>::template WorkEfficientScan>(CLRunType::GPU);
+    runner.template run<GenericScans<Op, false>::template RecursiveVecScan>(CLRunType::GPU);
+    runner.template run<GenericScans<Op, true>::template WorkEfficientScan>(CLRunType::GPU);
+    runner.template run<GenericScans<Op, true>::template RecursiveVecScan>(CLRunType::GPU);
+}
+
+/**
+* Scans elements of type T with every operator, unsegmented and segmented, into stats_generic_<type>.csv.
+*/
+template <typename T>
+void runGenericScans()
+{
+    set<size_t> sizes;
+    for(int i = 10; i <= MAX_POWER_OF_TWO; i++)
+        sizes.insert((size_t)1 << i);
+
+    Runner<T, ScanPlugin> runner(3, sizes.begin(), sizes.end());
+
+    runner.start("stats_generic_" + getTypeName<T>() + ".csv");
+
+    runGenericScans<T, ScanOperator::Add>(runner);
+    runGenericScans<T, ScanOperator::Max>(runner);
+    runGenericScans<T, ScanOperator::Min>(runner);
+
+    runner.finish();
+}
+
+/**
+* Binds the operator of the reductions, so they can be passed to Runner::run.
+*/
+template <ReduceOperator Op>
+struct Reductions
+{
+    template <typename T>
+    using CPU = cpu::Reduce<T, Op>;
+
+    template <typename T>
+    using Interleaved = gpu::thesis::ReduceInterleaved<T, Op>;
+
+    template <typename T>
+    using Sequential = gpu::thesis::ReduceSequential<T, Op>;
+
+    template <typename T>
+    using Multiple = gpu::thesis::ReduceMultiple<T, Op>;
+
+    template <typename T>
+    using Vector = gpu::thesis::ReduceVector<T, Op>;
+
+    template <typename T>
+    using TwoLevel = gpu::thesis::ReduceTwoLevel<T, Op>;
+
+    template <typename T>
+    using Atomic = gpu::thesis::ReduceAtomic<T, Op>;
+};
+
+template <typename T, ReduceOperator Op>
+void runReductions(Runner<T, ReducePlugin>& runner)
+{
+    runner.template run<Reductions<Op>::template CPU>();
+    runner.template run<Reductions<Op>::template Interleaved>(CLRunType::GPU);
+    runner.template run<Reductions<Op>::template Sequential>(CLRunType::GPU);
+    runner.template run<Reductions<Op>::template Multiple>(CLRunType::GPU);
+    runner.template run<Reductions<Op>::template Vector>(CLRunType::GPU);
+    runner.template run<Reductions<Op>::template TwoLevel>(CLRunType::GPU);
+}
+
+/**
+* Reduces elements of type T with every operator into stats_reduce_<type>.csv. The atomic finish does not support ArgMax.
+*/
+template <typename T>
+void runReductions()
+{
+    set<size_t> sizes;
+    for(int i = 10; i <= MAX_POWER_OF_TWO; i++)
+        sizes.insert((size_t)1 << i);
+
+    Runner<T, ReducePlugin> runner(3, sizes.begin(), sizes.end());
+
+    runner.start("stats_reduce_" + getTypeName<T>() + ".csv");
+
+    runReductions<T, ReduceOperator::Sum>(runner);
+    runner.template run<Reductions<ReduceOperator::Sum>::template Atomic>(CLRunType::GPU);
+    runReductions<T, ReduceOperator::Min>(runner);
+    runner.template run<Reductions<ReduceOperator::Min>::template Atomic>(CLRunType::GPU);
+    runReductions<T, ReduceOperator::Max>(runner);
+    runner.template run<Reductions<ReduceOperator::Max>::template Atomic>(CLRunType::GPU);
+    runReductions<T, ReduceOperator::ArgMax>(runner);
+
+    runner.finish();
+}
+
+/**
+* Compacts elements with selectivities from 1% to 99%, every selectivity is written to its own stats file.
+*/
+void runCompact()
+{
+    set<size_t> sizes;
+    for(int i = 10; i <= MAX_POWER_OF_TWO; i++)
+        sizes.insert((size_t)1 << i);
+
+    Runner<cl_uint, CompactPlugin> runner(3, sizes.begin(), sizes.end());
+
+    vector<int> percentages = { 1, 10, 25, 50, 75, 90, 99 };
+
+    for(int percentage : percentages)
+    {
+        runner.getPlugin()->setSelectivity(percentage / 100.0);
+
+        runner.start("stats_compact_" + to_string(percentage) + ".csv");
+
+        runner.run<cpu::Compact>();
+        runner.run<gpu::thesis::ScanCompact>(CLRunType::GPU);
+        runner.run<gpu::thesis::FusedCompact>(CLRunType::GPU);
+
+        runner.finish();
+    }
+}
+
+/**
+* Histograms of uniform and skewed values into 16 to 64K bins, every combination is written to its own stats file.
+* The per work item histograms only run for up to 256 bins, the local ones for up to 4K bins.
+*/
+void runHistograms()
+{
+    set<size_t> sizes;
+    for(int i = 10; i <= MAX_POWER_OF_TWO; i++)
+        sizes.insert((size_t)1 << i);
+
+    Runner<cl_uint, HistogramPlugin> runner(3, sizes.begin(), sizes.end());
+
+    vector<HistogramDistribution> distributions = { HistogramDistribution::Uniform, HistogramDistribution::Skewed };
+    vector<size_t> binCounts = { 16, 256, 4096, 65536 };
+
+    for(HistogramDistribution distribution : distributions)
+    {
+        runner.getPlugin()->setDistribution(distribution);
+
+        for(size_t binCount : binCounts)
+        {
+            runner.getPlugin()->setBinCount(binCount);
+
+            runner.start("stats_histogram_" + histogramDistributionToString(distribution) + "_" + to_string(binCount) + ".csv");
+
+            runner.run<cpu::Histogram>();
+            runner.run<gpu::thesis::HistogramAuto>(CLRunType::GPU);
+            if(binCount <= 256)
+                runner.run<gpu::thesis::HistogramPrivate>(CLRunType::GPU);
+            if(binCount <= 4096)
+                runner.run<gpu::thesis::HistogramLocal>(CLRunType::GPU);
+            runner.run<gpu::thesis::HistogramGlobal>(CLRunType::GPU);
+
+            runner.finish();
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Dataset* dataset = nullptr;
+    int exitCode = 0;
+
     try
     {
         set<size_t> sizes;
@@ -42,11 +229,22 @@ int main()
             sizes.insert(s);
         }
 
+        // an optional dataset file given on the command line replaces the generated input
+        if(argc > 1)
+        {
+            dataset = new Dataset(argv[1]);
+            sizes.clear();
+            sizes.insert((size_t)dataset->getCount());
+        }
+
         //array<int, 26> sizes = { 1<<1, 1<<2, 1<<3, 1<<4, 1<<5, 1<<6, 1<<7,1<<8, 1<<9, 1<<10, 1<<11, 1<<12, 1<<13, 1<<14, 1<<15, 1<<16, 1<<17, 1<<18, 1<<19, 1<<20, 1<<21, 1<<22, 1<<23, 1<<24, 1<<25, 1<<26 };
         //array<size_t, 1> sizes = { 1<<16 };
 
         Runner<cl_int, ScanPlugin> runner(3, sizes.begin(), sizes.end());
 
+        if(dataset)
+            runner.getPlugin()->setDataset(dataset);
+
         //runner.writeGPUDeviceInfo("gpuinfo.csv");
 
         runner.start("stats.csv");
@@ -75,9 +273,37 @@ int main()
     catch(const exception& e)
     {
         cerr << e.what() << endl;
+        exitCode = 1;
+    }
+
+    delete dataset;
+
+    // every runner initializes OpenCL on its own, so the generic scans, the compaction, the histograms and the reductions run after the one above is destroyed
+    if(argc <= 1)
+    {
+        try
+        {
+            runGenericScans<cl_int>();
+            runGenericScans<cl_ulong>();
+            runGenericScans<cl_float>();
+            runGenericScans<cl_float4>();
+
+            runCompact();
+
+            runHistograms();
+
+            runReductions<cl_int>();
+            runReductions<cl_float>();
+            runReductions<cl_double>(); // needs cl_khr_fp64
+        }
+        catch(const exception& e)
+        {
+            cerr << e.what() << endl;
+            exitCode = 1;
+        }
     }
 
     getchar();
 
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+* Base of the algorithms benchmarked by the SegmentedSortPlugin.
+* The input holds the number of segments n, followed by the n + 1 offsets of the segments into the keys (the last one is the number of keys) and the keys themselves.
+* The result only holds the keys, every segment sorted ascending on its own.
+*/
+class SegmentedSortAlgorithm
+{
+    public:
+        virtual ~SegmentedSortAlgorithm() {}
+
+        template <typename T>
+        static size_t getSegmentCount(const T* data)
+        {
+            return (size_t)data[0];
+        }
+
+        template <typename T>
+        static const T* getOffsets(const T* data)
+        {
+            return data + 1;
+        }
+
+        template <typename T>
+        static T* getKeys(T* data)
+        {
+            return data + getSegmentCount(data) + 2;
+        }
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "SegmentedSortAlgorithm.h"
+
+using namespace std;
+
+/**
+* Distributions of the segment sizes generated by the SegmentedSortPlugin.
+*/
+enum class SegmentDistribution
+{
+    Fixed,   // every segment has the maximum size
+    Uniform, // uniform between the minimum and the maximum size
+    PowerLaw // mostly segments close to the minimum size, a few far larger than the maximum
+};
+
+inline const string segmentDistributionToString(SegmentDistribution distribution)
+{
+    switch(distribution)
+    {
+    case SegmentDistribution::Fixed:    return "fixed";
+    case SegmentDistribution::Uniform:  return "uniform";
+    case SegmentDistribution::PowerLaw: return "power law";
+    }
+    return "unknown";
+}
+
+/**
+* Sorting many independent arrays of keys in one call. The problem size is the total number of keys, see SegmentedSortAlgorithm for the input layout.
+*/
+template <typename T>
+class SegmentedSortPlugin
+{
+public:
+    typedef SegmentedSortAlgorithm AlgorithmType;
+
+    SegmentedSortPlugin()
+        : distribution(SegmentDistribution::Uniform), minSegmentSize(32), maxSegmentSize(2048), layoutSize(0)
+    {
+    }
+
+    /**
+    * Sets the distribution of the segment sizes.
+    */
+    void setDistribution(SegmentDistribution distribution)
+    {
+        this->distribution = distribution;
+        layoutSize = 0;
+    }
+
+    SegmentDistribution getDistribution()
+    {
+        return distribution;
+    }
+
+    /**
+    * Sets the range of the segment sizes. SegmentDistribution::PowerLaw only uses the minimum.
+    */
+    void setSegmentSizes(size_t minSize, size_t maxSize)
+    {
+        minSegmentSize = max(minSize, (size_t)1);
+        maxSegmentSize = max(maxSize, minSegmentSize);
+        layoutSize = 0;
+    }
+
+    const string getTaskDescription(size_t size)
+    {
+        layout(size);
+
+        stringstream ss;
+        ss << "Sorting " << offsets.size() - 1 << " segments (" << segmentDistributionToString(distribution) << ", " << minSegmentSize << " to " << maxSegmentSize << ") of " << size << " elements of type " << getTypeName<T>() << " (" << sizeToString(size * sizeof(T)) << ")";
+        return ss.str();
+    }
+
+    /**
+    * Million keys per call, the writers report MKey/s.
+    */
+    double getWorkload(size_t size)
+    {
+        return size / 1e6;
+    }
+
+    const string getThroughputUnit()
+    {
+        return "MKey/s";
+    }
+
+    size_t getInputLength(size_t size)
+    {
+        layout(size);
+
+        return 1 + offsets.size() + size;
+    }
+
+    T* genInput(size_t size)
+    {
+        T* data = new T[getInputLength(size)];
+
+        data[0] = (T)(offsets.size() - 1);
+        copy(offsets.begin(), offsets.end(), data + 1);
+
+        fillRandom(SegmentedSortAlgorithm::getKeys(data), size, SEED, [](uint64_t random) -> T
+        {
+            return (T)random;
+        });
+
+        return data;
+    }
+
+    T* genResult(size_t size)
+    {
+        return new T[size];
+    }
+
+    void freeInput(T* data)
+    {
+        delete[] data;
+    }
+
+    void freeResult(T* result)
+    {
+        delete[] result;
+    }
+
+    /**
+    * Every segment of the result has to be sorted and a permutation of the same segment of the input.
+    */
+    bool verifyResult(SegmentedSortAlgorithm* alg, T* data, T* result, size_t size)
+    {
+        int segments = (int)SegmentedSortAlgorithm::getSegmentCount(data);
+        const T* segmentOffsets = SegmentedSortAlgorithm::getOffsets(data);
+        const T* keys = SegmentedSortAlgorithm::getKeys(data);
+
+        bool success = true;
+
+        #pragma omp parallel for schedule(dynamic, 64) reduction(&&:success)
+        for(int s = 0; s < segments; s++)
+        {
+            size_t begin = segmentOffsets[s];
+            size_t end = segmentOffsets[s + 1];
+
+            size_t violations = 0;
+            for(size_t i = begin; i + 1 < end; i++)
+                violations += result[i] > result[i + 1];
+
+            unsigned long long sum = 0, xorSum = 0;
+            for(size_t i = begin; i < end; i++)
+            {
+                unsigned long long h = hash((unsigned long long)keys[i]);
+                sum += h;
+                xorSum ^= h;
+
+                h = hash((unsigned long long)result[i]);
+                sum -= h;
+                xorSum ^= h;
+            }
+
+            success = success && violations == 0 && sum == 0 && xorSum == 0;
+        }
+
+        return success;
+    }
+
+private:
+    static const uint64_t SEED = 0;
+
+    /**
+    * Splits size keys into segments. The sizes are derived from the seed and the segment index, the last segment takes the remaining keys.
+    */
+    void layout(size_t size)
+    {
+        if(layoutSize == size && !offsets.empty())
+            return;
+
+        offsets.clear();
+        offsets.push_back(0);
+
+        size_t offset = 0;
+        for(uint64_t s = 0; offset < size; s++)
+        {
+            double unit = randomToUnit(randomAt(SEED + 1, s));
+
+            size_t segmentSize = maxSegmentSize;
+            switch(distribution)
+            {
+            case SegmentDistribution::Fixed:
+                break;
+            case SegmentDistribution::Uniform:
+                segmentSize = minSegmentSize + (size_t)(unit * (maxSegmentSize - minSegmentSize + 1));
+                break;
+            case SegmentDistribution::PowerLaw:
+                // inverse transform sampling of a pareto distribution with an exponent of 1.5 starting at the minimum size
+                segmentSize = (size_t)(minSegmentSize / pow(1.0 - unit, 1.0 / 1.5));
+                break;
+            }
+
+            offset += min(segmentSize, size - offset);
+            offsets.push_back((T)offset);
+        }
+
+        layoutSize = size;
+    }
+
+    /**
+    * 64 bit finalizer of MurmurHash3.
+    */
+    inline unsigned long long hash(unsigned long long x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    SegmentDistribution distribution;
+    size_t minSegmentSize;
+    size_t maxSegmentSize;
+
+    vector<T> offsets;
+    size_t layoutSize;
+};
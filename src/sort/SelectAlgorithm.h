@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+* Base of the algorithms benchmarked by the SelectPlugin.
+* The input holds k followed by the keys. The result holds the k-th smallest key followed by the k smallest keys in any order.
+*/
+class SelectAlgorithm
+{
+    public:
+        virtual ~SelectAlgorithm() {}
+
+        template <typename T>
+        static size_t getK(const T* data)
+        {
+            return (size_t)data[0];
+        }
+
+        template <typename T>
+        static T* getKeys(T* data)
+        {
+            return data + 1;
+        }
+
+        template <typename T>
+        static T* getSmallest(T* result)
+        {
+            return result + 1;
+        }
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <sstream>
+#include <algorithm>
+
+#include "SelectAlgorithm.h"
+
+using namespace std;
+
+/**
+* Selecting the k smallest keys and the k-th smallest one. The problem size is the number of keys, see SelectAlgorithm for the input and result layout.
+*/
+template <typename T>
+class SelectPlugin
+{
+public:
+    typedef SelectAlgorithm AlgorithmType;
+
+    /// selects the median instead of a fixed k
+    static const size_t MEDIAN = 0;
+
+    SelectPlugin()
+        : k(MEDIAN)
+    {
+    }
+
+    /**
+    * Sets the number of keys to select, MEDIAN selects the lower half. k is limited to the problem size.
+    */
+    void setK(size_t k)
+    {
+        this->k = k;
+    }
+
+    size_t getK(size_t size)
+    {
+        return k == MEDIAN ? (size + 1) / 2 : min(k, size);
+    }
+
+    const string getTaskDescription(size_t size)
+    {
+        stringstream ss;
+        ss << "Selecting the " << getK(size) << " smallest of " << size << " elements of type " << getTypeName<T>() << " (" << sizeToString(size * sizeof(T)) << ")";
+        return ss.str();
+    }
+
+    /**
+    * Million keys per call, the writers report MKey/s.
+    */
+    double getWorkload(size_t size)
+    {
+        return size / 1e6;
+    }
+
+    const string getThroughputUnit()
+    {
+        return "MKey/s";
+    }
+
+    size_t getInputLength(size_t size)
+    {
+        return 1 + size;
+    }
+
+    T* genInput(size_t size)
+    {
+        T* data = new T[getInputLength(size)];
+
+        data[0] = (T)getK(size);
+
+        fillRandom(SelectAlgorithm::getKeys(data), size, SEED, [](uint64_t random) -> T
+        {
+            return (T)random;
+        });
+
+        return data;
+    }
+
+    T* genResult(size_t size)
+    {
+        return new T[1 + getK(size)];
+    }
+
+    void freeInput(T* data)
+    {
+        delete[] data;
+    }
+
+    void freeResult(T* result)
+    {
+        delete[] result;
+    }
+
+    /**
+    * The pivot p is the k-th smallest key if fewer than k keys are smaller and at least k are not larger.
+    * The selected keys then have to be the keys smaller than p, compared by hash sums, filled up with p.
+    */
+    bool verifyResult(SelectAlgorithm* alg, T* data, T* result, size_t size)
+    {
+        size_t k = SelectAlgorithm::getK(data);
+        const T* keys = SelectAlgorithm::getKeys(data);
+        const T* smallest = SelectAlgorithm::getSmallest(result);
+        T pivot = result[0];
+
+        int chunks = (int)((size + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+        size_t less = 0, lessEqual = 0;
+        uint64_t sum = 0, xorSum = 0;
+
+        #pragma omp parallel for reduction(+:less, lessEqual, sum) reduction(^:xorSum)
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t begin = c * VERIFY_CHUNK_SIZE;
+            size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+            for(size_t i = begin; i < end; i++)
+            {
+                lessEqual += keys[i] <= pivot;
+                if(keys[i] < pivot)
+                {
+                    less++;
+
+                    uint64_t h = randomAt(0, keys[i]);
+                    sum += h;
+                    xorSum ^= h;
+                }
+            }
+        }
+
+        if(!(less < k && k <= lessEqual))
+            return false;
+
+        size_t selectedLess = 0;
+        size_t errors = 0;
+
+        #pragma omp parallel for reduction(+:selectedLess, errors, sum) reduction(^:xorSum)
+        for(int i = 0; i < (int)k; i++)
+        {
+            errors += smallest[i] > pivot;
+            if(smallest[i] < pivot)
+            {
+                selectedLess++;
+
+                uint64_t h = randomAt(0, smallest[i]);
+                sum -= h;
+                xorSum ^= h;
+            }
+        }
+
+        return errors == 0 && selectedLess == less && sum == 0 && xorSum == 0;
+    }
+
+private:
+    static const size_t VERIFY_CHUNK_SIZE = 1 << 16;
+    static const uint64_t SEED = 0;
+
+    size_t k;
+};
@@ -1,40 +1,183 @@
 #pragma once
 
 #include <sstream>
-#include <random>
+#include <utility>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
 
 #include "SortAlgorithm.h"
 
-//#define FULL_VERIFY
-
 using namespace std;
 
+/**
+* Distributions of the keys generated by the SortPlugin.
+*/
+enum class KeyDistribution
+{
+    Uniform,       // uniform over the full range of the key type
+    Sorted,        // ascending
+    ReverseSorted, // descending
+    NearlySorted,  // ascending with about 1% of the keys swapped with a close neighbor
+    FewUnique,     // uniformly drawn from a small set of distinct keys
+    Zipf,          // few keys occur very often, many keys rarely
+    Gaussian,      // normal distribution around the center of the key range
+    AllEqual,      // every key is the same
+    BitLimited     // uniform, but only the lowest bits are set
+};
+
+inline const string keyDistributionToString(KeyDistribution distribution)
+{
+    switch(distribution)
+    {
+    case KeyDistribution::Uniform:       return "uniform";
+    case KeyDistribution::Sorted:        return "sorted";
+    case KeyDistribution::ReverseSorted: return "reverse sorted";
+    case KeyDistribution::NearlySorted:  return "nearly sorted";
+    case KeyDistribution::FewUnique:     return "few unique";
+    case KeyDistribution::Zipf:          return "zipf";
+    case KeyDistribution::Gaussian:      return "gaussian";
+    case KeyDistribution::AllEqual:      return "all equal";
+    case KeyDistribution::BitLimited:    return "bit limited";
+    }
+    return "unknown";
+}
+
 template <typename T>
 class SortPlugin
 {
 public:
     typedef SortAlgorithm AlgorithmType;
 
+    SortPlugin()
+        : distribution(KeyDistribution::Uniform), bitLimit(16), dataset(nullptr), input(nullptr)
+    {
+    }
+
+    /**
+    * Uses the elements of the given dataset as input instead of generating them.
+    * The data is accessed directly inside the memory mapping. The dataset is not owned by the plugin.
+    */
+    void setDataset(Dataset* dataset)
+    {
+        this->dataset = dataset;
+    }
+
+    /**
+    * Sets the distribution of the keys created by genInput.
+    */
+    void setDistribution(KeyDistribution distribution)
+    {
+        this->distribution = distribution;
+    }
+
+    KeyDistribution getDistribution()
+    {
+        return distribution;
+    }
+
+    /**
+    * Sets the number of significant bits of the keys for KeyDistribution::BitLimited.
+    */
+    void setBitLimit(unsigned int bits)
+    {
+        bitLimit = bits;
+    }
+
     const string getTaskDescription(size_t size)
     {
         stringstream ss;
-        ss << "Sorting " << size << " elements of type " << getTypeName<T>() << " (" << sizeToString(size * sizeof(T)) << ")";
+        ss << "Sorting " << size << " elements of type " << getTypeName<T>() << " (" << sizeToString(size * sizeof(T)) << ", " << (dataset ? "dataset" : keyDistributionToString(distribution)) << ")";
         return ss.str();
     }
 
+    size_t getInputLength(size_t size)
+    {
+        return size;
+    }
+
     T* genInput(size_t size)
     {
-        T* data = new T[size]; // two size x size matrixes
+        if(dataset)
+            return input = dataset->getData<T>(size);
+
+        T* data = new T[size];
+        input = data;
+
+        const double maxKey = (double)numeric_limits<T>::max();
+
+        if(distribution == KeyDistribution::Zipf)
+            initZipf();
 
-        default_random_engine generator;
-        uniform_int_distribution<T> dist; // range is [0;numeric_limits<T>::max()]
+        // all random numbers are derived from the seed and the element index, so the result does not depend on the scheduling
+        int chunks = (int)((size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
 
-        generate(data, data + size, [&]()
+        #pragma omp parallel for
+        for(int c = 0; c < chunks; c++)
         {
-            return rand() % 100;
-            //return (rand() % 256) << 24;
-            //return dist(generator);
-        });
+            size_t begin = c * PARALLEL_CHUNK_SIZE;
+            size_t end = min(begin + PARALLEL_CHUNK_SIZE, size);
+
+            switch(distribution)
+            {
+            case KeyDistribution::Uniform:
+                for(size_t i = begin; i < end; i++)
+                    data[i] = (T)randomAt(SEED, i);
+                break;
+            case KeyDistribution::Sorted:
+            case KeyDistribution::NearlySorted:
+                for(size_t i = begin; i < end; i++)
+                    data[i] = (T)(i * (maxKey / size));
+                break;
+            case KeyDistribution::ReverseSorted:
+                for(size_t i = begin; i < end; i++)
+                    data[i] = (T)((size - 1 - i) * (maxKey / size));
+                break;
+            case KeyDistribution::FewUnique:
+                for(size_t i = begin; i < end; i++)
+                    data[i] = (T)hash(randomAt(SEED, i) % FEW_UNIQUE_KEYS + 1);
+                break;
+            case KeyDistribution::Zipf:
+                for(size_t i = begin; i < end; i++)
+                {
+                    size_t rank = upper_bound(zipfCdf.begin(), zipfCdf.end(), randomToUnit(randomAt(SEED, i)) * zipfCdf.back()) - zipfCdf.begin();
+                    data[i] = (T)hash(min(rank, ZIPF_KEYS - 1) + 1);
+                }
+                break;
+            case KeyDistribution::Gaussian:
+                for(size_t i = begin; i < end; i++)
+                {
+                    // Box-Muller transform
+                    double u1 = 1.0 - randomToUnit(randomAt(SEED, 2 * i + 0));
+                    double u2 = randomToUnit(randomAt(SEED, 2 * i + 1));
+                    double z = sqrt(-2.0 * log(u1)) * cos(2.0 * 3.14159265358979323846 * u2);
+                    data[i] = (T)max(0.0, min(maxKey, maxKey / 2.0 + z * maxKey / 8.0));
+                }
+                break;
+            case KeyDistribution::AllEqual:
+                fill(data + begin, data + end, (T)hash(SEED));
+                break;
+            case KeyDistribution::BitLimited:
+            {
+                T mask = bitLimit >= sizeof(T) * 8 ? numeric_limits<T>::max() : (T)((1ULL << bitLimit) - 1);
+                for(size_t i = begin; i < end; i++)
+                    data[i] = (T)randomAt(SEED, i) & mask;
+                break;
+            }
+            }
+
+            if(distribution == KeyDistribution::NearlySorted && end - begin > 1)
+            {
+                // swap 1% of the keys with a close neighbor inside the chunk
+                for(size_t j = begin; j < begin + (end - begin) / 100 + 1; j++)
+                {
+                    size_t pos = begin + randomAt(SEED, 2 * j + 0) % (end - begin);
+                    size_t other = min(pos + 1 + randomAt(SEED, 2 * j + 1) % NEARLY_SORTED_DISTANCE, end - 1);
+                    swap(data[pos], data[other]);
+                }
+            }
+        }
 
         return data;
     }
@@ -46,7 +189,10 @@ public:
 
     void freeInput(T* data)
     {
-        delete[] (T*)data;
+        if(data == input)
+            input = nullptr;
+        if(!dataset)
+            delete[] (T*)data;
     }
 
     void freeResult(T* result)
@@ -54,30 +200,119 @@ public:
         delete[] (T*)result;
     }
 
+    /**
+    * The result has to be sorted and a permutation of the input.
+    * In-place algorithms sort a copy of the generated input, which the Runner keeps untouched, so their permutation check compares against that.
+    */
     bool verifyResult(SortAlgorithm* alg, T* data, T* result, size_t size)
     {
-#ifdef FULL_VERIFY
-        if(!alg->isInPlace())
+        if(alg->isInPlace())
         {
-            // full test
-            sort(data, data + size);
-            return memcmp(data, result, size * sizeof(T)) == 0;
+            result = data;
+            data = input;
         }
-        else
+
+        return data != nullptr && isSorted(result, size) && fingerprint(data, size) == fingerprint(result, size);
+    }
+
+private:
+    static const size_t VERIFY_CHUNK_SIZE = 1 << 16;
+    static const unsigned int FEW_UNIQUE_KEYS = 16;
+    static const size_t NEARLY_SORTED_DISTANCE = 32;
+    static const size_t ZIPF_KEYS = 1 << 16;
+    static const uint64_t SEED = 0;
+
+    /**
+    * Builds the cumulative distribution of the ranks 1 to ZIPF_KEYS with an exponent of 1.
+    */
+    void initZipf()
+    {
+        if(!zipfCdf.empty())
+            return;
+
+        zipfCdf.resize(ZIPF_KEYS);
+        double sum = 0.0;
+        for(size_t i = 0; i < ZIPF_KEYS; i++)
         {
-            for(size_t i = 0; i < size - 1; i++)
-                if(result[i] > result[i + 1])
-                    return false;
+            sum += 1.0 / (double)(i + 1);
+            zipfCdf[i] = sum;
+        }
+    }
+
+    /**
+    * Checks if the given array is sorted ascending.
+    * The array is split into chunks which are checked in parallel. Every chunk counts the violations without branching so the inner loop can be vectorized.
+    */
+    bool isSorted(T* arr, size_t size)
+    {
+        if(size < 2)
             return true;
+
+        int chunks = (int)((size - 1 + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+        bool sorted = true;
+
+        #pragma omp parallel for reduction(&&:sorted)
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t begin = c * VERIFY_CHUNK_SIZE;
+            size_t end = min(begin + VERIFY_CHUNK_SIZE, size - 1);
+
+            size_t violations = 0;
+            for(size_t i = begin; i < end; i++)
+                violations += arr[i] > arr[i + 1];
+
+            sorted = sorted && violations == 0;
         }
-#else
-        if(alg->isInPlace())
-            result = data;
 
-        for(size_t i = 0; i < size - 1; i++)
-            if(result[i] > result[i + 1])
-                return false;
-        return true;
-#endif
+        return sorted;
+    }
+
+    /**
+    * Calculates an order independent fingerprint of the multiset of values in the given array.
+    * Every value is hashed and the hashes are combined by addition and xor, so two arrays containing the same values in any order have the same fingerprint.
+    * This replaces sorting the input to verify that the result is a permutation of it.
+    */
+    pair<unsigned long long, unsigned long long> fingerprint(T* arr, size_t size)
+    {
+        int chunks = (int)((size + VERIFY_CHUNK_SIZE - 1) / VERIFY_CHUNK_SIZE);
+        unsigned long long sum = 0;
+        unsigned long long xorSum = 0;
+
+        #pragma omp parallel for reduction(+:sum) reduction(^:xorSum)
+        for(int c = 0; c < chunks; c++)
+        {
+            size_t begin = c * VERIFY_CHUNK_SIZE;
+            size_t end = min(begin + VERIFY_CHUNK_SIZE, size);
+
+            for(size_t i = begin; i < end; i++)
+            {
+                unsigned long long h = hash((unsigned long long)arr[i]);
+                sum += h;
+                xorSum ^= h;
+            }
+        }
+
+        return make_pair(sum, xorSum);
+    }
+
+    /**
+    * 64 bit finalizer of MurmurHash3.
+    */
+    inline unsigned long long hash(unsigned long long x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
     }
+
+    KeyDistribution distribution;
+    unsigned int bitLimit;
+
+    vector<double> zipfCdf;
+
+    Dataset* dataset;
+    T* input; // last generated input, the reference for in-place algorithms
 };
\ No newline at end of file
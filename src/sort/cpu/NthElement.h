@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+
+#include "../../common/CPUAlgorithm.h"
+#include "../SelectAlgorithm.h"
+
+using namespace std;
+
+namespace cpu
+{
+    /**
+    * Partitions the keys in place around the k-th smallest one.
+    */
+    template<typename T>
+    class NthElement : public CPUAlgorithm<T>, public SelectAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Select (C++ STL algorithm nth_element)";
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                size_t k = getK(data);
+                T* keys = getKeys(data);
+
+                std::nth_element(keys, keys + k - 1, keys + size);
+
+                result[0] = keys[k - 1];
+                copy(keys, keys + k, getSmallest(result));
+            }
+
+            virtual ~NthElement() {}
+    };
+}
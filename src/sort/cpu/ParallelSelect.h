@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../common/CPUAlgorithm.h"
+#include "../../common/utils.h"
+#include "../SelectAlgorithm.h"
+
+using namespace std;
+
+namespace cpu
+{
+    /**
+    * Radix select on the CPU: every chunk of keys counts the buckets of the highest RADIX bits in parallel, which gives the bucket of the k-th smallest key.
+    * The keys of smaller buckets are selected, only the keys of this bucket are copied out and partitioned by nth_element.
+    */
+    template<typename T>
+    class ParallelSelect : public CPUAlgorithm<T>, public SelectAlgorithm
+    {
+        static const unsigned int RADIX = 8;
+        static const unsigned int BUCKETS = 1 << RADIX;
+        static const unsigned int SHIFT = sizeof(T) * 8 - RADIX;
+
+        public:
+            const string getName() override
+            {
+                return "Select (OpenMP bucket histograms, STL nth_element on one bucket)";
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                size_t k = getK(data);
+                const T* keys = getKeys(data);
+                T* smallest = getSmallest(result);
+
+                int chunks = (int)((size + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE);
+                histograms.assign(chunks * BUCKETS, 0);
+
+                #pragma omp parallel for
+                for(int c = 0; c < chunks; c++)
+                {
+                    size_t begin = c * PARALLEL_CHUNK_SIZE;
+                    size_t end = min(begin + PARALLEL_CHUNK_SIZE, size);
+
+                    size_t* histogram = &histograms[c * BUCKETS];
+                    for(size_t i = begin; i < end; i++)
+                        histogram[keys[i] >> SHIFT]++;
+                }
+
+                // find the bucket of the k-th smallest key
+                size_t below = 0;
+                unsigned int bucket = 0;
+                for(;; bucket++)
+                {
+                    size_t count = 0;
+                    for(int c = 0; c < chunks; c++)
+                        count += histograms[c * BUCKETS + bucket];
+
+                    if(below + count >= k)
+                        break;
+                    below += count;
+                }
+
+                // the positions of the smaller keys and the candidates of every chunk
+                vector<size_t> smallerOffsets(chunks + 1, 0);
+                vector<size_t> candidateOffsets(chunks + 1, 0);
+                for(int c = 0; c < chunks; c++)
+                {
+                    const size_t* histogram = &histograms[c * BUCKETS];
+
+                    size_t smaller = 0;
+                    for(unsigned int b = 0; b < bucket; b++)
+                        smaller += histogram[b];
+
+                    smallerOffsets[c + 1] = smallerOffsets[c] + smaller;
+                    candidateOffsets[c + 1] = candidateOffsets[c] + histogram[bucket];
+                }
+
+                candidates.resize(candidateOffsets[chunks]);
+
+                #pragma omp parallel for
+                for(int c = 0; c < chunks; c++)
+                {
+                    size_t begin = c * PARALLEL_CHUNK_SIZE;
+                    size_t end = min(begin + PARALLEL_CHUNK_SIZE, size);
+
+                    size_t smaller = smallerOffsets[c];
+                    size_t candidate = candidateOffsets[c];
+                    for(size_t i = begin; i < end; i++)
+                    {
+                        unsigned int b = keys[i] >> SHIFT;
+                        if(b < bucket)
+                            smallest[smaller++] = keys[i];
+                        else if(b == bucket)
+                            candidates[candidate++] = keys[i];
+                    }
+                }
+
+                size_t rank = k - 1 - below;
+                std::nth_element(candidates.begin(), candidates.begin() + rank, candidates.end());
+
+                result[0] = candidates[rank];
+                copy(candidates.begin(), candidates.begin() + rank + 1, smallest + below);
+            }
+
+            virtual ~ParallelSelect() {}
+
+        private:
+            vector<size_t> histograms;
+            vector<T> candidates;
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+
+#include "../../common/CPUAlgorithm.h"
+#include "../../common/utils.h"
+#include "../SegmentedSortAlgorithm.h"
+
+using namespace std;
+
+namespace cpu
+{
+    /**
+    * Sorts every segment with std::sort, the segments are distributed dynamically over the threads as their sizes differ.
+    */
+    template<typename T>
+    class SegmentedSort : public CPUAlgorithm<T>, public SegmentedSortAlgorithm
+    {
+        public:
+            const string getName() override
+            {
+                return "Segmented sort (C++ STL algorithm sort)";
+            }
+
+            void run(T* data, T* result, size_t size) override
+            {
+                int segments = (int)getSegmentCount(data);
+                const T* offsets = getOffsets(data);
+
+                parallelCopy(result, getKeys(data), size);
+
+                #pragma omp parallel for schedule(dynamic, 64)
+                for(int s = 0; s < segments; s++)
+                    std::sort(result + offsets[s], result + offsets[s + 1]);
+            }
+
+            virtual ~SegmentedSort() {}
+    };
+}
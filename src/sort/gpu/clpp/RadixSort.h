@@ -28,14 +28,20 @@ namespace gpu
                 void init() override
                 {
                     clppProgram::setBasePath("../common/libs/clpp/clpp/");
-                    clppcontext.setup(0, 0);
+                    clppcontext.setup(this->context->getCLContext(), this->context->getCLDevice(), this->queue->getCLCommandQueue());
 
                     s = new clppSort_RadixSortGPU(&clppcontext, 0, sizeof(T) * 8, true);
                 }
 
                 void upload(size_t workGroupSize, T* data, size_t size) override
                 {
-                    s->pushDatas(data, size);
+                    // the keys stay in a buffer of the runner, so clpp can be chained with other kernels of its context
+                    buffer = this->context->createBuffer(CL_MEM_READ_WRITE, size * sizeof(T));
+                    this->queue->enqueueWrite(buffer, data);
+
+                    // allocate the radix buffers for this size up front instead of growing them while pushing
+                    s->reserve(size);
+                    s->pushCLDatas(buffer->getCLBuffer(), size);
                 }
 
                 void run(size_t workGroupSize, size_t size) override
@@ -45,7 +51,8 @@ namespace gpu
 
                 void download(T* result, size_t size) override
                 {
-                    s->popDatas();
+                    this->queue->enqueueRead(buffer, result);
+                    delete buffer;
                 }
 
                 void cleanup() override
@@ -56,7 +63,8 @@ namespace gpu
                 virtual ~RadixSort() {}
 
             private:
-                clppSort* s;
+                Buffer* buffer;
+                clppSort_RadixSortGPU* s;
                 clppContext clppcontext;
         };
     }
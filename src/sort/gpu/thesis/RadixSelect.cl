@@ -0,0 +1,8 @@
+// Gathers the first entry of every bucket row of the scanned thread-histograms of RadixSortLocal.cl,
+// which is the number of keys in all smaller buckets.
+__kernel void GatherBucketStarts(__global uint* scannedHistograms, __global uint* starts, uint stride)
+{
+    uint bucket = get_global_id(0);
+
+    starts[bucket] = scannedHistograms[bucket * stride];
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <limits>
+
+#include "../../../common/CLAlgorithm.h"
+#include "../../SelectAlgorithm.h"
+#include "RadixSortLocal.h"
+
+using namespace std;
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Finds the k-th smallest key digit by digit starting at the most significant one, using the histogram, scan and permute steps of RadixSortLocal.
+        * After every digit the keys of the smaller buckets are selected and only the keys of the bucket holding the k-th smallest key remain candidates,
+        * so every step works on about a sixteenth of the keys of the previous one instead of sorting all keys.
+        */
+        template<typename T>
+        class RadixSelect : public CLAlgorithm<T>, public SelectAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+            static const unsigned int RADIX = RadixSortLocal<T>::RADIX;
+            static const unsigned int BUCKETS = RadixSortLocal<T>::BUCKETS;
+
+        public:
+            const string getName() override
+            {
+                return "Radix select (THESIS radix sort local digit steps)";
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/RadixSelect.cl");
+                gatherKernel = program->createKernel("GatherBucketStarts");
+                delete program;
+
+                radixSort.setContext(context);
+                radixSort.setCommandQueue(queue);
+                radixSort.init();
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                k = getK(data);
+                bufferSize = RadixSortLocal<T>::getPaddedSize(workGroupSize, size);
+
+                srcBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                queue->enqueueWrite(srcBuffer, getKeys(data), 0, size * sizeof(T));
+
+                dstBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                histogramBuffer = context->createBuffer(CL_MEM_READ_WRITE, RadixSortLocal<T>::getHistogramSize(workGroupSize, bufferSize) * sizeof(cl_uint));
+                startBuffer = context->createBuffer(CL_MEM_READ_WRITE, BUCKETS * sizeof(cl_uint));
+                smallestBuffer = context->createBuffer(CL_MEM_READ_WRITE, k * sizeof(T));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                size_t count = size;    // candidates at the front of srcBuffer, they share all digits above the current one
+                size_t rank = k - 1;    // rank of the k-th smallest key among the candidates
+                size_t selected = 0;    // smaller keys already in smallestBuffer
+                pivot = 0;
+
+                for(int bits = sizeof(T) * 8 - RADIX; bits >= 0; bits -= RADIX)
+                {
+                    // padding keys have all bits set, they are permuted behind the candidates of the last bucket
+                    size_t paddedCount = RadixSortLocal<T>::getPaddedSize(workGroupSize, count);
+                    if(paddedCount != count)
+                        queue->enqueueFill(srcBuffer, numeric_limits<T>::max(), count * sizeof(T), (paddedCount - count) * sizeof(T));
+
+                    radixSort.histogram(workGroupSize, srcBuffer, histogramBuffer, paddedCount, bits);
+                    radixSort.scan_r(workGroupSize, histogramBuffer, RadixSortLocal<T>::getHistogramSize(workGroupSize, paddedCount));
+                    radixSort.permute(workGroupSize, srcBuffer, dstBuffer, histogramBuffer, paddedCount, bits);
+
+                    gatherKernel->setArg(0, histogramBuffer);
+                    gatherKernel->setArg(1, startBuffer);
+                    gatherKernel->setArg(2, (cl_uint)RadixSortLocal<T>::getHistogramStride(paddedCount));
+
+                    size_t globalWorkSizes[] = { BUCKETS };
+                    size_t localWorkSizes[] = { BUCKETS };
+
+                    queue->enqueueKernel(gatherKernel, 1, globalWorkSizes, localWorkSizes);
+
+                    cl_uint starts[BUCKETS + 1];
+                    queue->enqueueRead(startBuffer, starts);
+                    starts[BUCKETS] = (cl_uint)count;
+
+                    unsigned int bucket = 0;
+                    while(starts[bucket + 1] <= rank)
+                        bucket++;
+
+                    // the keys of the smaller buckets are selected
+                    if(starts[bucket] > 0)
+                        queue->enqueueCopy(dstBuffer, smallestBuffer, 0, selected * sizeof(T), starts[bucket] * sizeof(T));
+
+                    selected += starts[bucket];
+                    rank -= starts[bucket];
+                    count = starts[bucket + 1] - starts[bucket];
+                    pivot |= (T)bucket << bits;
+
+                    // only the keys of the bucket remain candidates
+                    queue->enqueueCopy(dstBuffer, srcBuffer, starts[bucket] * sizeof(T), 0, count * sizeof(T));
+                }
+
+                // the remaining candidates all equal the pivot
+                queue->enqueueCopy(srcBuffer, smallestBuffer, 0, selected * sizeof(T), (rank + 1) * sizeof(T));
+            }
+
+            void download(T* result, size_t size) override
+            {
+                result[0] = pivot;
+                queue->enqueueRead(smallestBuffer, getSmallest(result), 0, k * sizeof(T));
+
+                delete srcBuffer;
+                delete dstBuffer;
+                delete histogramBuffer;
+                delete startBuffer;
+                delete smallestBuffer;
+            }
+
+            void cleanup() override
+            {
+                delete gatherKernel;
+                radixSort.cleanup();
+            }
+
+            virtual ~RadixSelect() {}
+
+        private:
+            Kernel* gatherKernel;
+
+            size_t k;
+            size_t bufferSize;
+            T pivot;
+
+            Buffer* srcBuffer;
+            Buffer* dstBuffer;
+            Buffer* histogramBuffer;
+            Buffer* startBuffer;
+            Buffer* smallestBuffer;
+
+            RadixSortLocal<T> radixSort;
+        };
+    }
+}
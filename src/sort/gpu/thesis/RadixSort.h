@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "../../../common/CLAlgorithm.h"
 #include "../../SortAlgorithm.h"
 
@@ -47,10 +49,7 @@ namespace gpu
 
             void upload(size_t workGroupSize, T* data, size_t size) override
             {
-                bufferSize = roundToMultiple(size, workGroupSize * BLOCK_SIZE);
-
-                srcBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
-                dstBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                allocate(workGroupSize, size);
 
                 if(bufferSize != size)
                 {
@@ -59,12 +58,24 @@ namespace gpu
                 }
                 else
                     queue->enqueueWrite(srcBuffer, data);
+            }
 
-                // each thread has it's own histogram
-                histogramSize = (bufferSize / BLOCK_SIZE) * BUCKETS;
-                histogramSize = roundToMultiple(histogramSize, workGroupSize * 2 * VECTOR_WIDTH);
+            /**
+            * Sorts size elements of the given buffer starting at offset on the device.
+            * Used by algorithms sorting parts of their own buffers, e.g. the oversized segments of the segmented sort.
+            * The scratch buffers have to be allocated for at least size elements, so sorting several ranges only enqueues kernels.
+            */
+            void sort(size_t workGroupSize, Buffer* buffer, size_t offset, size_t size)
+            {
+                setSize(workGroupSize, size);
 
-                histogramBuffer = context->createBuffer(CL_MEM_READ_WRITE, histogramSize * sizeof(cl_uint));
+                queue->enqueueCopy(buffer, srcBuffer, offset * sizeof(T), 0, size * sizeof(T));
+                if(bufferSize != size)
+                    queue->enqueueFill(srcBuffer, numeric_limits<T>::max(), size * sizeof(T), (bufferSize - size) * sizeof(T));
+
+                run(workGroupSize, size);
+
+                queue->enqueueCopy(srcBuffer, buffer, 0, offset * sizeof(T), size * sizeof(T));
             }
 
             void run(size_t workGroupSize, size_t size) override
@@ -99,11 +110,11 @@ namespace gpu
             /**
             * Recursive vector scan
             */
-            void scan_r(size_t workGroupSize, Buffer* values, size_t size)
+            void scan_r(size_t workGroupSize, Buffer* values, size_t size, size_t level = 0)
             {
                 size_t sumBufferSize = roundToMultiple(size / (workGroupSize * 2 * VECTOR_WIDTH), workGroupSize * 2 * VECTOR_WIDTH);
 
-                Buffer* sums = context->createBuffer(CL_MEM_READ_WRITE, sumBufferSize * sizeof(cl_uint));
+                Buffer* sums = sumBuffers[level];
 
                 scanKernel->setArg(0, values);
                 scanKernel->setArg(1, sums);
@@ -117,7 +128,7 @@ namespace gpu
                 if(size > workGroupSize * 2 * VECTOR_WIDTH)
                 {
                     // the buffer containes more than one scanned block, scan the created sum buffer
-                    scan_r(workGroupSize, sums, sumBufferSize);
+                    scan_r(workGroupSize, sums, sumBufferSize, level + 1);
 
                     // apply the sums to the buffer
                     addKernel->setArg(0, values);
@@ -125,17 +136,13 @@ namespace gpu
 
                     queue->enqueueKernel(addKernel, 1, globalWorkSizes, localWorkSizes);
                 }
-
-                delete sums;
             }
 
             void download(T* result, size_t size) override
             {
                 queue->enqueueRead(srcBuffer, result, 0, size * sizeof(T));
 
-                delete srcBuffer;
-                delete histogramBuffer;
-                delete dstBuffer;
+                release();
             }
 
             void cleanup() override
@@ -146,9 +153,54 @@ namespace gpu
                 delete addKernel;
             }
 
+            /**
+            * Allocates the scratch buffers for sorting up to size elements, including the sums of every level of the histogram scan.
+            */
+            void allocate(size_t workGroupSize, size_t size)
+            {
+                setSize(workGroupSize, size);
+
+                srcBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                dstBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                histogramBuffer = context->createBuffer(CL_MEM_READ_WRITE, histogramSize * sizeof(cl_uint));
+
+                // same recursion as scan_r, smaller sorts need fewer and smaller sum buffers
+                sumBuffers.clear();
+                size_t scanSize = histogramSize;
+                while(true)
+                {
+                    size_t sumBufferSize = roundToMultiple(scanSize / (workGroupSize * 2 * VECTOR_WIDTH), workGroupSize * 2 * VECTOR_WIDTH);
+                    sumBuffers.push_back(context->createBuffer(CL_MEM_READ_WRITE, sumBufferSize * sizeof(cl_uint)));
+
+                    if(scanSize <= workGroupSize * 2 * VECTOR_WIDTH)
+                        break;
+                    scanSize = sumBufferSize;
+                }
+            }
+
+            void release()
+            {
+                delete srcBuffer;
+                delete histogramBuffer;
+                delete dstBuffer;
+
+                for(Buffer* sums : sumBuffers)
+                    delete sums;
+                sumBuffers.clear();
+            }
+
             virtual ~RadixSort() {}
 
         private:
+            void setSize(size_t workGroupSize, size_t size)
+            {
+                bufferSize = roundToMultiple(size, workGroupSize * BLOCK_SIZE);
+
+                // each thread has it's own histogram
+                histogramSize = (bufferSize / BLOCK_SIZE) * BUCKETS;
+                histogramSize = roundToMultiple(histogramSize, workGroupSize * 2 * VECTOR_WIDTH);
+            }
+
             size_t bufferSize;
             size_t histogramSize;
 
@@ -160,6 +212,7 @@ namespace gpu
             Buffer* srcBuffer;
             Buffer* histogramBuffer;
             Buffer* dstBuffer;
+            vector<Buffer*> sumBuffers;
         };
     }
 }
@@ -18,13 +18,14 @@ namespace gpu
         {
             static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
 
-            static const unsigned int RADIX = 4;
-            static const unsigned int BUCKETS = (1 << RADIX);
             static const unsigned int BLOCK_SIZE = 32; // elements per thread
 
             static const unsigned int VECTOR_WIDTH = 8; // for recursive vector scan
 
         public:
+            static const unsigned int RADIX = 4;
+            static const unsigned int BUCKETS = (1 << RADIX);
+
             const string getName() override
             {
                 return "Radix sort local (THESIS AMD dixxi)";
@@ -47,7 +48,7 @@ namespace gpu
 
             void upload(size_t workGroupSize, T* data, size_t size) override
             {
-                bufferSize = roundToMultiple(size, workGroupSize * BLOCK_SIZE);
+                bufferSize = getPaddedSize(workGroupSize, size);
 
                 srcBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
                 dstBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
@@ -61,45 +62,85 @@ namespace gpu
                     queue->enqueueWrite(srcBuffer, data);
 
                 // each thread has it's own histogram
-                histogramSize = (bufferSize / BLOCK_SIZE) * BUCKETS;
-                histogramSize = roundToMultiple(histogramSize, workGroupSize * 2 * VECTOR_WIDTH);
+                histogramSize = getHistogramSize(workGroupSize, bufferSize);
 
                 histogramBuffer = context->createBuffer(CL_MEM_READ_WRITE, histogramSize * sizeof(cl_uint));
             }
 
             void run(size_t workGroupSize, size_t size) override
             {
-                size_t localSize = (workGroupSize * BUCKETS * sizeof(cl_uint));
-
-                size_t globalWorkSizes[] = { bufferSize / BLOCK_SIZE };
-                size_t localWorkSizes[] = { workGroupSize };
-
                 for(cl_uint bits = 0; bits < sizeof(T) * 8; bits += RADIX)
                 {
                     // Calculate thread-histograms
-                    histogramKernel->setArg(0, srcBuffer);
-                    histogramKernel->setArg(1, histogramBuffer);
-                    histogramKernel->setArg(2, bits);
-                    histogramKernel->setArg(3, localSize, nullptr);
-
-                    queue->enqueueKernel(histogramKernel, 1, globalWorkSizes, localWorkSizes);
+                    histogram(workGroupSize, srcBuffer, histogramBuffer, bufferSize, bits);
 
                     // Scan the histogram
                     scan_r(workGroupSize, histogramBuffer, histogramSize);
 
                     // Permute the element to appropriate place
-                    permuteKernel->setArg(0, srcBuffer);
-                    permuteKernel->setArg(1, dstBuffer);
-                    permuteKernel->setArg(2, histogramBuffer);
-                    permuteKernel->setArg(3, bits);
-                    permuteKernel->setArg(4, localSize, nullptr);
-
-                    queue->enqueueKernel(permuteKernel, 1, globalWorkSizes, localWorkSizes);
+                    permute(workGroupSize, srcBuffer, dstBuffer, histogramBuffer, bufferSize, bits);
 
                     std::swap(srcBuffer, dstBuffer);
                 }
             }
 
+            /**
+            * Number of keys a buffer has to be padded to for sorting size keys.
+            */
+            static size_t getPaddedSize(size_t workGroupSize, size_t size)
+            {
+                return roundToMultiple(size, workGroupSize * BLOCK_SIZE);
+            }
+
+            /**
+            * Size of the histogram buffer for a padded number of keys, it holds BUCKETS rows of getHistogramStride(size) thread-histogram entries each.
+            */
+            static size_t getHistogramSize(size_t workGroupSize, size_t size)
+            {
+                return roundToMultiple((size / BLOCK_SIZE) * BUCKETS, workGroupSize * 2 * VECTOR_WIDTH);
+            }
+
+            /**
+            * Distance between the rows of the buckets in the histogram buffer for a padded number of keys.
+            */
+            static size_t getHistogramStride(size_t size)
+            {
+                return size / BLOCK_SIZE;
+            }
+
+            /**
+            * Calculates the thread-histograms of the digit at bits of the first size keys of src, size has to be padded.
+            */
+            void histogram(size_t workGroupSize, Buffer* src, Buffer* histograms, size_t size, cl_uint bits)
+            {
+                size_t globalWorkSizes[] = { size / BLOCK_SIZE };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                histogramKernel->setArg(0, src);
+                histogramKernel->setArg(1, histograms);
+                histogramKernel->setArg(2, bits);
+                histogramKernel->setArg(3, workGroupSize * BUCKETS * sizeof(cl_uint), nullptr);
+
+                queue->enqueueKernel(histogramKernel, 1, globalWorkSizes, localWorkSizes);
+            }
+
+            /**
+            * Moves the first size keys of src to their position in dst given by the scanned thread-histograms, size has to be padded.
+            */
+            void permute(size_t workGroupSize, Buffer* src, Buffer* dst, Buffer* scannedHistograms, size_t size, cl_uint bits)
+            {
+                size_t globalWorkSizes[] = { size / BLOCK_SIZE };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                permuteKernel->setArg(0, src);
+                permuteKernel->setArg(1, dst);
+                permuteKernel->setArg(2, scannedHistograms);
+                permuteKernel->setArg(3, bits);
+                permuteKernel->setArg(4, workGroupSize * BUCKETS * sizeof(cl_uint), nullptr);
+
+                queue->enqueueKernel(permuteKernel, 1, globalWorkSizes, localWorkSizes);
+            }
+
             /**
             * Recursive vector scan
             */
@@ -0,0 +1,210 @@
+#define RADIX 8
+#define BUCKETS (1 << RADIX)
+#define RADIX_MASK (BUCKETS - 1)
+#define PASSES 4 // of 32 bit keys
+#define ELEMENTS_PER_ITEM 16
+
+// the tiles are sorted by the digit in local memory in two steps of LOCAL_RADIX bits
+#define LOCAL_RADIX 4
+#define LOCAL_BUCKETS (1 << LOCAL_RADIX)
+#define LOCAL_MASK (LOCAL_BUCKETS - 1)
+
+// a descriptor of a bucket of a tile packs a flag into the highest two bits and a count into the others
+#define FLAG_AGGREGATE (1u << 30) // the count of the tile
+#define FLAG_PREFIX (2u << 30)    // the count of the tile and all tiles before
+#define FLAG_MASK (3u << 30)
+#define VALUE_MASK (~FLAG_MASK)
+
+// Counts the digits of all passes in one read of the keys. The work groups loop over the keys and add their local histograms to the global ones.
+__kernel void HistogramAll(__global uint* data, __global uint* histograms, uint size)
+{
+    uint localId = get_local_id(0);
+    uint localSize = get_local_size(0);
+
+    __local uint hist[PASSES * BUCKETS];
+
+    for(uint i = localId; i < PASSES * BUCKETS; i += localSize)
+        hist[i] = 0;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(uint i = get_global_id(0); i < size; i += get_global_size(0))
+    {
+        uint value = data[i];
+        for(uint p = 0; p < PASSES; ++p)
+            atomic_inc(&hist[p * BUCKETS + ((value >> (p * RADIX)) & RADIX_MASK)]);
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(uint i = localId; i < PASSES * BUCKETS; i += localSize)
+        if(hist[i] > 0)
+            atomic_add(&histograms[i], hist[i]);
+}
+
+// Turns the histogram of every pass into the offsets of its buckets, one work item per pass.
+__kernel void ScanHistograms(__global uint* histograms)
+{
+    __global uint* hist = histograms + get_global_id(0) * BUCKETS;
+
+    uint sum = 0;
+    for(int i = 0; i < BUCKETS; ++i)
+    {
+        uint count = hist[i];
+        hist[i] = sum;
+        sum += count;
+    }
+}
+
+// Sorts a tile in local memory stably by LOCAL_RADIX bits at shift, see PermuteTiles in RadixSortRanked.cl.
+// Every work item ranks ELEMENTS_PER_ITEM consecutive keys of src and writes them to their place in dst.
+void SortTileStep(__local uint* src, __local uint* dst, __local uint* counts, __local uint* sums, uint shift)
+{
+    uint localId = get_local_id(0);
+    uint localSize = get_local_size(0);
+
+    uint values[ELEMENTS_PER_ITEM];
+    for(int k = 0; k < ELEMENTS_PER_ITEM; ++k)
+        values[k] = src[localId * ELEMENTS_PER_ITEM + k];
+
+    for(int i = 0; i < LOCAL_BUCKETS; ++i)
+        counts[i * localSize + localId] = 0;
+
+    for(int k = 0; k < ELEMENTS_PER_ITEM; ++k)
+        counts[((values[k] >> shift) & LOCAL_MASK) * localSize + localId]++;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // exclusive scan of the bucket-major counts
+    __local uint* segment = counts + localId * LOCAL_BUCKETS;
+
+    uint sum = 0;
+    for(int i = 0; i < LOCAL_BUCKETS; ++i)
+    {
+        uint count = segment[i];
+        segment[i] = sum;
+        sum += count;
+    }
+
+    sums[localId] = sum;
+
+    for(uint offset = 1; offset < localSize; offset <<= 1)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        uint add = localId >= offset ? sums[localId - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        sums[localId] += add;
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint before = sums[localId] - sum;
+    for(int i = 0; i < LOCAL_BUCKETS; ++i)
+        segment[i] += before;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(int k = 0; k < ELEMENTS_PER_ITEM; ++k)
+        dst[counts[((values[k] >> shift) & LOCAL_MASK) * localSize + localId]++] = values[k];
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+// One pass over the digit at bits. Every work group sorts one tile by the digit in local memory and writes its buckets to the offsets
+// of the buckets plus the counts of the tiles before, which are found by a decoupled look-back over the descriptors of these tiles.
+// The tiles are numbered in the order the work groups start, so a tile only waits for tiles which are already running.
+// The descriptors of the tiles have to be cleared before every pass, the tile counter of the pass before the first one.
+__kernel void SortPass(__global uint* src, __global uint* dst, __global uint* bucketOffsets, __global uint* descriptors, __global uint* tileCounters, uint bits,
+                       __local uint* counts, __local uint* sums, __local uint* keys, __local uint* sortedKeys)
+{
+    uint localId = get_local_id(0);
+    uint localSize = get_local_size(0);
+    uint tileSize = localSize * ELEMENTS_PER_ITEM;
+    uint pass = bits / RADIX;
+
+    __local uint sharedTileId;
+    __local uint hist[BUCKETS];
+    __local uint localStarts[BUCKETS];
+    __local uint globalStarts[BUCKETS];
+
+    if(localId == 0)
+        sharedTileId = atomic_inc(&tileCounters[pass]);
+
+    for(uint b = localId; b < BUCKETS; b += localSize)
+        hist[b] = 0;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint tileId = sharedTileId;
+
+    // load the tile and count its digits
+    for(uint i = localId; i < tileSize; i += localSize)
+    {
+        uint key = src[tileId * tileSize + i];
+        keys[i] = key;
+        atomic_inc(&hist[(key >> bits) & RADIX_MASK]);
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // publish the counts of the tile, the first tile has no tiles before and publishes them as prefix
+    __global uint* tileDescriptors = descriptors + tileId * BUCKETS;
+
+    for(uint b = localId; b < BUCKETS; b += localSize)
+        atomic_xchg(&tileDescriptors[b], (tileId == 0 ? FLAG_PREFIX : FLAG_AGGREGATE) | hist[b]);
+
+    // look back over the tiles before, adding their counts until one has published its prefix
+    for(uint b = localId; b < BUCKETS; b += localSize)
+    {
+        uint prefix = 0;
+
+        if(tileId > 0)
+        {
+            uint look = tileId - 1;
+            while(true)
+            {
+                uint descriptor = atomic_or(&descriptors[look * BUCKETS + b], 0);
+                uint flag = descriptor & FLAG_MASK;
+
+                if(flag == 0)
+                    continue; // not published yet
+
+                prefix += descriptor & VALUE_MASK;
+
+                if(flag == FLAG_PREFIX)
+                    break;
+
+                look--;
+            }
+
+            atomic_xchg(&tileDescriptors[b], FLAG_PREFIX | (prefix + hist[b]));
+        }
+
+        globalStarts[b] = bucketOffsets[pass * BUCKETS + b] + prefix;
+    }
+
+    // sort the tile by the digit, the steps end with a barrier
+    SortTileStep(keys, sortedKeys, counts, sums, bits);
+    SortTileStep(sortedKeys, keys, counts, sums, bits + LOCAL_RADIX);
+
+    if(localId == 0)
+    {
+        uint sum = 0;
+        for(int b = 0; b < BUCKETS; ++b)
+        {
+            localStarts[b] = sum;
+            sum += hist[b];
+        }
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // consecutive work items write consecutive keys of the same bucket
+    for(uint i = localId; i < tileSize; i += localSize)
+    {
+        uint key = keys[i];
+        uint digit = (key >> bits) & RADIX_MASK;
+
+        dst[globalStarts[digit] + i - localStarts[digit]] = key;
+    }
+}
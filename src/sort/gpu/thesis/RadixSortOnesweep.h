@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+
+#include "../../../common/CLAlgorithm.h"
+#include "../../SortAlgorithm.h"
+
+using namespace std;
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Radix sort with 8 bit digits and a single kernel per digit.
+        * The histograms of all digits are counted in one read of the keys before the first pass. Every pass sorts tiles in local memory
+        * and finds the offsets of their buckets by a decoupled look-back over the counts published by the tiles before, so no scan kernels are needed.
+        * The passes share one set of look-back descriptors, BUCKETS per tile, which is cleared before every pass. With large tiles it stays a small fraction of the keys.
+        * Requires sizes below 1 << 30, as the counts share their word with a flag.
+        */
+        template<typename T>
+        class RadixSortOnesweep : public CLAlgorithm<T>, public SortAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+            static const unsigned int RADIX = 8;
+            static const unsigned int BUCKETS = (1 << RADIX);
+            static const unsigned int PASSES = sizeof(T) * 8 / RADIX;
+            static const unsigned int ELEMENTS_PER_ITEM = 16; // keys per work item, a tile has ELEMENTS_PER_ITEM * work group size keys
+            static const unsigned int LOCAL_BUCKETS = 16; // buckets of the local sorting steps
+
+            static const size_t HISTOGRAM_GROUPS_PER_COMPUTE_UNIT = 8;
+
+        public:
+            const string getName() override
+            {
+                return "Radix sort onesweep (THESIS decoupled look-back)";
+            }
+
+            bool isInPlace() override
+            {
+                return false;
+            }
+
+            const vector<size_t> getSupportedWorkGroupSizes() const override
+            {
+                // the counts, sums and both copies of a tile have to fit into local memory besides the histograms of the pass
+                size_t localMemorySize = (size_t)context->getInfo<cl_ulong>(CL_DEVICE_LOCAL_MEM_SIZE);
+
+                auto sizes = CLAlgorithm<T>::getSupportedWorkGroupSizes();
+                sizes.erase(remove_if(begin(sizes), end(sizes), [localMemorySize](size_t size) { return getLocalMemorySize(size) > localMemorySize; }), sizes.end());
+                return sizes;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/RadixSortOnesweep.cl");
+                histogramKernel = program->createKernel("HistogramAll");
+                scanKernel = program->createKernel("ScanHistograms");
+                passKernel = program->createKernel("SortPass");
+                delete program;
+
+                computeUnits = context->getInfo<cl_uint>(CL_DEVICE_MAX_COMPUTE_UNITS);
+
+                histogramBuffer = context->createBuffer(CL_MEM_READ_WRITE, PASSES * BUCKETS * sizeof(cl_uint));
+                counterBuffer = context->createBuffer(CL_MEM_READ_WRITE, PASSES * sizeof(cl_uint));
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                bufferSize = roundToMultiple(size, workGroupSize * ELEMENTS_PER_ITEM);
+
+                srcBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                dstBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+
+                if(bufferSize != size)
+                {
+                    queue->enqueueWrite(srcBuffer, data, 0, size * sizeof(T));
+                    queue->enqueueFill(srcBuffer, numeric_limits<T>::max(), size * sizeof(T), (bufferSize - size) * sizeof(T));
+                }
+                else
+                    queue->enqueueWrite(srcBuffer, data);
+
+                // the descriptors of all buckets of all tiles of one pass, BUCKETS / (ELEMENTS_PER_ITEM * workGroupSize) of the size of the keys
+                tiles = bufferSize / (workGroupSize * ELEMENTS_PER_ITEM);
+                descriptorBuffer = context->createBuffer(CL_MEM_READ_WRITE, tiles * BUCKETS * sizeof(cl_uint));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                queue->enqueueFill(histogramBuffer, (cl_uint)0, 0, PASSES * BUCKETS * sizeof(cl_uint));
+                queue->enqueueFill(counterBuffer, (cl_uint)0, 0, PASSES * sizeof(cl_uint));
+
+                // Calculate the histograms of all digits
+                size_t groups = min(bufferSize / workGroupSize, computeUnits * HISTOGRAM_GROUPS_PER_COMPUTE_UNIT);
+
+                histogramKernel->setArg(0, srcBuffer);
+                histogramKernel->setArg(1, histogramBuffer);
+                histogramKernel->setArg(2, (cl_uint)bufferSize);
+
+                size_t histogramGlobalWorkSizes[] = { groups * workGroupSize };
+                size_t histogramLocalWorkSizes[] = { workGroupSize };
+
+                queue->enqueueKernel(histogramKernel, 1, histogramGlobalWorkSizes, histogramLocalWorkSizes);
+
+                // Scan the histograms
+                scanKernel->setArg(0, histogramBuffer);
+
+                size_t scanWorkSizes[] = { PASSES };
+
+                queue->enqueueKernel(scanKernel, 1, scanWorkSizes, scanWorkSizes);
+
+                // Sort by every digit in a single kernel
+                size_t globalWorkSizes[] = { tiles * workGroupSize };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                for(cl_uint bits = 0; bits < sizeof(T) * 8; bits += RADIX)
+                {
+                    queue->enqueueFill(descriptorBuffer, (cl_uint)0, 0, tiles * BUCKETS * sizeof(cl_uint));
+
+                    passKernel->setArg(0, srcBuffer);
+                    passKernel->setArg(1, dstBuffer);
+                    passKernel->setArg(2, histogramBuffer);
+                    passKernel->setArg(3, descriptorBuffer);
+                    passKernel->setArg(4, counterBuffer);
+                    passKernel->setArg(5, bits);
+                    passKernel->setArg(6, workGroupSize * LOCAL_BUCKETS * sizeof(cl_uint), nullptr);
+                    passKernel->setArg(7, workGroupSize * sizeof(cl_uint), nullptr);
+                    passKernel->setArg(8, workGroupSize * ELEMENTS_PER_ITEM * sizeof(cl_uint), nullptr);
+                    passKernel->setArg(9, workGroupSize * ELEMENTS_PER_ITEM * sizeof(cl_uint), nullptr);
+
+                    queue->enqueueKernel(passKernel, 1, globalWorkSizes, localWorkSizes);
+
+                    std::swap(srcBuffer, dstBuffer);
+                }
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(srcBuffer, result, 0, size * sizeof(T));
+
+                delete srcBuffer;
+                delete dstBuffer;
+                delete descriptorBuffer;
+            }
+
+            void cleanup() override
+            {
+                delete histogramKernel;
+                delete scanKernel;
+                delete passKernel;
+
+                delete histogramBuffer;
+                delete counterBuffer;
+            }
+
+            virtual ~RadixSortOnesweep() {}
+
+        private:
+            /**
+            * Local memory of the pass kernel: the counts, the sums of the work items and two copies of a tile, the histogram and the starts of the buckets and the tile id.
+            */
+            static size_t getLocalMemorySize(size_t workGroupSize)
+            {
+                return (workGroupSize * (LOCAL_BUCKETS + 1 + 2 * ELEMENTS_PER_ITEM) + 3 * BUCKETS + 1) * sizeof(cl_uint);
+            }
+
+            size_t bufferSize;
+            size_t tiles;
+            size_t computeUnits;
+
+            Kernel* histogramKernel;
+            Kernel* scanKernel;
+            Kernel* passKernel;
+
+            Buffer* srcBuffer;
+            Buffer* dstBuffer;
+            Buffer* histogramBuffer;
+            Buffer* descriptorBuffer;
+            Buffer* counterBuffer;
+        };
+    }
+}
@@ -0,0 +1,228 @@
+#define RADIX 4
+#define BUCKETS (1 << RADIX)
+#define RADIX_MASK (BUCKETS - 1)
+#define ELEMENTS_PER_ITEM 4
+
+#define DIGIT(value) (((value) >> bits) & RADIX_MASK)
+
+// Counts the digits of the tile of every work group, the histograms are stored bucket-major, so their scan gives
+// the position of every bucket of every tile in the output.
+__kernel void HistogramTiles(__global uint4* data, __global uint* histograms, uint bits)
+{
+    uint localId = get_local_id(0);
+
+    __local uint hist[BUCKETS];
+
+    if(localId < BUCKETS)
+        hist[localId] = 0;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint4 value = data[get_global_id(0)];
+
+    atomic_inc(&hist[DIGIT(value.x)]);
+    atomic_inc(&hist[DIGIT(value.y)]);
+    atomic_inc(&hist[DIGIT(value.z)]);
+    atomic_inc(&hist[DIGIT(value.w)]);
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if(localId < BUCKETS)
+        histograms[get_num_groups(0) * localId + get_group_id(0)] = hist[localId];
+}
+
+// Sorts the tile of every work group stably by the digit in local memory, then writes it to the positions given by the scanned tile histograms.
+// As the tile is sorted, consecutive work items write consecutive keys of the same bucket.
+__kernel void PermuteTiles(__global uint4* src, __global uint* dst, __global uint* scannedHistograms, uint bits, __local uint* counts, __local uint* sums, __local uint* keys)
+{
+    uint localId = get_local_id(0);
+    uint localSize = get_local_size(0);
+
+    __local uint localStarts[BUCKETS];
+    __local uint globalStarts[BUCKETS];
+
+    // every work item counts the digits of its keys in its own column of the bucket-major counts
+    uint4 value = src[get_global_id(0)];
+
+    for(int i = 0; i < BUCKETS; ++i)
+        counts[i * localSize + localId] = 0;
+
+    counts[DIGIT(value.x) * localSize + localId]++;
+    counts[DIGIT(value.y) * localSize + localId]++;
+    counts[DIGIT(value.z) * localSize + localId]++;
+    counts[DIGIT(value.w) * localSize + localId]++;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // exclusive scan of the counts, every work item scans BUCKETS consecutive entries, the sums of the work items are scanned in between
+    __local uint* segment = counts + localId * BUCKETS;
+
+    uint sum = 0;
+    for(int i = 0; i < BUCKETS; ++i)
+    {
+        uint count = segment[i];
+        segment[i] = sum;
+        sum += count;
+    }
+
+    sums[localId] = sum;
+
+    for(uint offset = 1; offset < localSize; offset <<= 1)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        uint add = localId >= offset ? sums[localId - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        sums[localId] += add;
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint before = sums[localId] - sum;
+    for(int i = 0; i < BUCKETS; ++i)
+        segment[i] += before;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // the first column holds where the buckets start in the sorted tile
+    if(localId < BUCKETS)
+    {
+        localStarts[localId] = counts[localId * localSize];
+        globalStarts[localId] = scannedHistograms[get_num_groups(0) * localId + get_group_id(0)];
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // rank the keys in the tile, keys of the same work item keep their order
+    keys[counts[DIGIT(value.x) * localSize + localId]++] = value.x;
+    keys[counts[DIGIT(value.y) * localSize + localId]++] = value.y;
+    keys[counts[DIGIT(value.z) * localSize + localId]++] = value.z;
+    keys[counts[DIGIT(value.w) * localSize + localId]++] = value.w;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(uint i = localId; i < localSize * ELEMENTS_PER_ITEM; i += localSize)
+    {
+        uint key = keys[i];
+        uint digit = DIGIT(key);
+
+        dst[globalStarts[digit] + i - localStarts[digit]] = key;
+    }
+}
+
+#define CONCAT(a, b) a ## b
+#define CONCAT_EXPANDED(a, b) CONCAT(a, b)
+
+#define UPSWEEP_STEP(left, right) right += left
+
+#define UPSWEEP_STEPS(left, right) \
+    UPSWEEP_STEP(CONCAT_EXPANDED(val1.s, left), CONCAT_EXPANDED(val1.s, right)); \
+    UPSWEEP_STEP(CONCAT_EXPANDED(val2.s, left), CONCAT_EXPANDED(val2.s, right))
+
+#define DOWNSWEEP_STEP_TMP(left, right, tmp) \
+    int tmp = left;                          \
+    left = right;                            \
+    right += tmp
+
+#define DOWNSWEEP_STEP(left, right) DOWNSWEEP_STEP_TMP(left, right, CONCAT_EXPANDED(tmp, __COUNTER__))
+
+#define DOWNSWEEP_STEPS(left, right) \
+    DOWNSWEEP_STEP(CONCAT_EXPANDED(val1.s, left), CONCAT_EXPANDED(val1.s, right)); \
+    DOWNSWEEP_STEP(CONCAT_EXPANDED(val2.s, left), CONCAT_EXPANDED(val2.s, right))
+
+__kernel void ScanBlocksVec(__global int8* buffer, __global int* sums, __local int* shared)
+{
+    uint globalId = get_global_id(0);
+    uint localId = get_local_id(0);
+    uint n = get_local_size(0) * 2;
+
+    uint offset = 1;
+
+    int8 val1 = buffer[2 * globalId + 0];
+    int8 val2 = buffer[2 * globalId + 1];
+
+    // upsweep vectors
+    UPSWEEP_STEPS(0, 1);
+    UPSWEEP_STEPS(2, 3);
+    UPSWEEP_STEPS(4, 5);
+    UPSWEEP_STEPS(6, 7);
+
+    UPSWEEP_STEPS(1, 3);
+    UPSWEEP_STEPS(5, 7);
+
+    UPSWEEP_STEPS(3, 7);
+
+    // move sums into shared memory block and clear last elements
+    shared[2 * localId + 0] = val1.s7;
+    shared[2 * localId + 1] = val2.s7;
+
+    val1.s7 = 0;
+    val2.s7 = 0;
+
+    // downsweep vectors
+    DOWNSWEEP_STEPS(3, 7);
+
+    DOWNSWEEP_STEPS(1, 3);
+    DOWNSWEEP_STEPS(5, 7);
+
+    DOWNSWEEP_STEPS(0, 1);
+    DOWNSWEEP_STEPS(2, 3);
+    DOWNSWEEP_STEPS(4, 5);
+    DOWNSWEEP_STEPS(6, 7);
+
+    // build sum in place up the tree
+    for (uint d = n >> 1; d > 0; d >>= 1)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (localId < d)
+        {
+            uint ai = offset*(2*localId+1)-1;
+            uint bi = offset*(2*localId+2)-1;
+
+            shared[bi] += shared[ai];
+        }
+        offset <<= 1;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // save sum and clear the last element
+    if (localId == 0)
+    {
+        sums[get_group_id(0)] = shared[n - 1];
+        shared[n - 1] = 0;
+    }
+
+    // traverse down tree & build scan
+    for (uint d = 1; d < n; d *= 2)
+    {
+        offset >>= 1;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (localId < d)
+        {
+            uint ai = offset*(2*localId+1)-1;
+            uint bi = offset*(2*localId+2)-1;
+
+            int t = shared[ai];
+            shared[ai] = shared[bi];
+            shared[bi] += t;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // apply the sums
+    val1 += shared[2 * localId + 0];
+    val2 += shared[2 * localId + 1];
+
+    // write results to device memory
+    buffer[2 * globalId + 0] = val1;
+    buffer[2 * globalId + 1] = val2;
+}
+
+__kernel void AddSums(__global int8* buffer, __global int* sums)
+{
+    uint globalId = get_global_id(0);
+
+    int val = sums[get_group_id(0)];
+
+    buffer[globalId * 2 + 0] += val;
+    buffer[globalId * 2 + 1] += val;
+}
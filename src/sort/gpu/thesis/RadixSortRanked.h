@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+
+#include "../../../common/CLAlgorithm.h"
+#include "../../SortAlgorithm.h"
+
+using namespace std;
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Variant of RadixSortLocal with one histogram per work group instead of per work item.
+        * Every work group sorts its tile by the digit in local memory before writing it, so the keys are written in contiguous runs per bucket.
+        */
+        template<typename T>
+        class RadixSortRanked : public CLAlgorithm<T>, public SortAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+            static const unsigned int RADIX = 4;
+            static const unsigned int BUCKETS = (1 << RADIX);
+            static const unsigned int ELEMENTS_PER_ITEM = 4; // keys per work item, a tile has ELEMENTS_PER_ITEM * work group size keys
+
+            static const unsigned int VECTOR_WIDTH = 8; // for recursive vector scan
+
+        public:
+            const string getName() override
+            {
+                return "Radix sort ranked (THESIS local split, coalesced scatter)";
+            }
+
+            bool isInPlace() override
+            {
+                return false;
+            }
+
+            const vector<size_t> getSupportedWorkGroupSizes() const override
+            {
+                // the histogram of a tile is written by the first BUCKETS work items and the counts, sums and keys of a tile have to fit into local memory
+                size_t localMemorySize = (size_t)context->getInfo<cl_ulong>(CL_DEVICE_LOCAL_MEM_SIZE);
+
+                auto sizes = CLAlgorithm<T>::getSupportedWorkGroupSizes();
+                sizes.erase(remove_if(begin(sizes), end(sizes), [localMemorySize](size_t size) { return size < BUCKETS || getLocalMemorySize(size) > localMemorySize; }), sizes.end());
+                return sizes;
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/RadixSortRanked.cl");
+                histogramKernel = program->createKernel("HistogramTiles");
+                permuteKernel = program->createKernel("PermuteTiles");
+                scanKernel = program->createKernel("ScanBlocksVec");
+                addKernel = program->createKernel("AddSums");
+                delete program;
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                bufferSize = roundToMultiple(size, workGroupSize * ELEMENTS_PER_ITEM);
+
+                srcBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+                dstBuffer = context->createBuffer(CL_MEM_READ_WRITE, bufferSize * sizeof(T));
+
+                if(bufferSize != size)
+                {
+                    queue->enqueueWrite(srcBuffer, data, 0, size * sizeof(T));
+                    queue->enqueueFill(srcBuffer, numeric_limits<T>::max(), size * sizeof(T), (bufferSize - size) * sizeof(T));
+                }
+                else
+                    queue->enqueueWrite(srcBuffer, data);
+
+                // each work group has it's own histogram
+                histogramSize = (bufferSize / (workGroupSize * ELEMENTS_PER_ITEM)) * BUCKETS;
+                histogramSize = roundToMultiple(histogramSize, workGroupSize * 2 * VECTOR_WIDTH);
+
+                histogramBuffer = context->createBuffer(CL_MEM_READ_WRITE, histogramSize * sizeof(cl_uint));
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                size_t globalWorkSizes[] = { bufferSize / ELEMENTS_PER_ITEM };
+                size_t localWorkSizes[] = { workGroupSize };
+
+                for(cl_uint bits = 0; bits < sizeof(T) * 8; bits += RADIX)
+                {
+                    // Calculate tile-histograms
+                    histogramKernel->setArg(0, srcBuffer);
+                    histogramKernel->setArg(1, histogramBuffer);
+                    histogramKernel->setArg(2, bits);
+
+                    queue->enqueueKernel(histogramKernel, 1, globalWorkSizes, localWorkSizes);
+
+                    // Scan the histogram
+                    scan_r(workGroupSize, histogramBuffer, histogramSize);
+
+                    // Sort every tile locally and write its buckets to their places
+                    permuteKernel->setArg(0, srcBuffer);
+                    permuteKernel->setArg(1, dstBuffer);
+                    permuteKernel->setArg(2, histogramBuffer);
+                    permuteKernel->setArg(3, bits);
+                    permuteKernel->setArg(4, workGroupSize * BUCKETS * sizeof(cl_uint), nullptr);
+                    permuteKernel->setArg(5, workGroupSize * sizeof(cl_uint), nullptr);
+                    permuteKernel->setArg(6, workGroupSize * ELEMENTS_PER_ITEM * sizeof(cl_uint), nullptr);
+
+                    queue->enqueueKernel(permuteKernel, 1, globalWorkSizes, localWorkSizes);
+
+                    std::swap(srcBuffer, dstBuffer);
+                }
+            }
+
+            /**
+            * Recursive vector scan
+            */
+            void scan_r(size_t workGroupSize, Buffer* values, size_t size)
+            {
+                size_t sumBufferSize = roundToMultiple(size / (workGroupSize * 2 * VECTOR_WIDTH), workGroupSize * 2 * VECTOR_WIDTH);
+
+                Buffer* sums = context->createBuffer(CL_MEM_READ_WRITE, sumBufferSize * sizeof(cl_uint));
+
+                scanKernel->setArg(0, values);
+                scanKernel->setArg(1, sums);
+                scanKernel->setArg(2, sizeof(cl_uint) * 2 * workGroupSize, nullptr);
+
+                size_t globalWorkSizes[] = { size / (2 * VECTOR_WIDTH) }; // each thread processed 2 elements
+                size_t localWorkSizes[] = { workGroupSize };
+
+                queue->enqueueKernel(scanKernel, 1, globalWorkSizes, localWorkSizes);
+
+                if(size > workGroupSize * 2 * VECTOR_WIDTH)
+                {
+                    // the buffer containes more than one scanned block, scan the created sum buffer
+                    scan_r(workGroupSize, sums, sumBufferSize);
+
+                    // apply the sums to the buffer
+                    addKernel->setArg(0, values);
+                    addKernel->setArg(1, sums);
+
+                    queue->enqueueKernel(addKernel, 1, globalWorkSizes, localWorkSizes);
+                }
+
+                delete sums;
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(srcBuffer, result, 0, size * sizeof(T));
+
+                delete srcBuffer;
+                delete histogramBuffer;
+                delete dstBuffer;
+            }
+
+            void cleanup() override
+            {
+                delete histogramKernel;
+                delete permuteKernel;
+                delete scanKernel;
+                delete addKernel;
+            }
+
+            virtual ~RadixSortRanked() {}
+
+        private:
+            /**
+            * Local memory of the permute kernel: the counts, the sums of the work items and the keys of a tile.
+            */
+            static size_t getLocalMemorySize(size_t workGroupSize)
+            {
+                return workGroupSize * (BUCKETS + 1 + ELEMENTS_PER_ITEM) * sizeof(cl_uint);
+            }
+
+            size_t bufferSize;
+            size_t histogramSize;
+
+            Kernel* histogramKernel;
+            Kernel* permuteKernel;
+            Kernel* scanKernel;
+            Kernel* addKernel;
+
+            Buffer* srcBuffer;
+            Buffer* histogramBuffer;
+            Buffer* dstBuffer;
+        };
+    }
+}
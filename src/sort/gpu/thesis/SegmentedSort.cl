@@ -0,0 +1,81 @@
+#define PADDING_SEGMENT 0xFFFF
+
+/**
+* Sorts a tile of consecutive segments with one work group. Every key is tagged with the index of its segment inside the tile
+* and the tile is bitonic sorted by (segment, key) in local memory, so all segments of the tile are sorted at once and stay in place.
+* The tile is padded to a power of two with keys behind all segments.
+*/
+__kernel void SortTiles(__global uint* data, __global const uint* offsets, __global const uint2* tiles, __local uint* keys, __local ushort* segments)
+{
+    uint localId = get_local_id(0);
+    uint localSize = get_local_size(0);
+
+    uint2 tile = tiles[get_group_id(0)];
+    uint begin = offsets[tile.x];
+    uint count = offsets[tile.y] - begin;
+
+    uint size = 1;
+    while(size < count)
+        size <<= 1;
+
+    for(uint i = localId; i < size; i += localSize)
+    {
+        if(i < count)
+        {
+            // find the last segment starting at or before the key, empty segments are skipped
+            uint low = tile.x;
+            uint high = tile.y;
+            while(high - low > 1)
+            {
+                uint mid = (low + high) / 2;
+                if(offsets[mid] <= begin + i)
+                    low = mid;
+                else
+                    high = mid;
+            }
+
+            keys[i] = data[begin + i];
+            segments[i] = (ushort)(low - tile.x);
+        }
+        else
+        {
+            keys[i] = UINT_MAX;
+            segments[i] = PADDING_SEGMENT;
+        }
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(uint boxwidth = 2; boxwidth <= size; boxwidth <<= 1)
+    {
+        for(uint inc = boxwidth >> 1; inc > 0; inc >>= 1)
+        {
+            for(uint id = localId; id < size / 2; id += localSize)
+            {
+                uint low = id & (inc - 1); // bits below inc
+                uint i = (id << 1) - low;  // insert 0 at position inc
+                uint j = i + inc;
+                bool asc = (i & boxwidth) == 0;
+
+                uint k0 = keys[i];
+                uint k1 = keys[j];
+                ushort s0 = segments[i];
+                ushort s1 = segments[j];
+
+                bool greater = s0 > s1 || (s0 == s1 && k0 > k1);
+                if(greater == asc)
+                {
+                    keys[i] = k1;
+                    keys[j] = k0;
+                    segments[i] = s1;
+                    segments[j] = s0;
+                }
+            }
+
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    }
+
+    for(uint i = localId; i < count; i += localSize)
+        data[begin + i] = keys[i];
+}
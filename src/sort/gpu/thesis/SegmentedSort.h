@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+
+#include "../../../common/CLAlgorithm.h"
+#include "../../SegmentedSortAlgorithm.h"
+#include "RadixSort.h"
+
+using namespace std;
+
+namespace gpu
+{
+    namespace thesis
+    {
+        /**
+        * Sorts many independent segments in one call.
+        * Consecutive segments of up to TILE_SIZE keys are packed into tiles, every tile is sorted by one work group in local memory.
+        * Larger segments are sorted one after another by the radix sort.
+        */
+        template<typename T>
+        class SegmentedSort : public CLAlgorithm<T>, public SegmentedSortAlgorithm
+        {
+            static_assert(is_same<T, cl_uint>::value, "Thesis algorithms only support 32 bit unsigned int");
+
+            static const size_t TILE_SIZE = 2048; // keys sorted in local memory by one work group
+
+        public:
+            const string getName() override
+            {
+                return "Segmented sort (THESIS local bitonic, radix sort for large segments)";
+            }
+
+            void init() override
+            {
+                Program* program = context->createProgram("gpu/thesis/SegmentedSort.cl");
+                kernel = program->createKernel("SortTiles");
+                delete program;
+
+                radixSort.setContext(context);
+                radixSort.setCommandQueue(queue);
+                radixSort.init();
+            }
+
+            void upload(size_t workGroupSize, T* data, size_t size) override
+            {
+                size_t segments = getSegmentCount(data);
+                const T* offsets = getOffsets(data);
+
+                // pack consecutive small segments into tiles of (first segment, end segment)
+                tiles.clear();
+                largeSegments.clear();
+
+                for(size_t s = 0; s < segments; s++)
+                {
+                    size_t length = offsets[s + 1] - offsets[s];
+
+                    if(length > TILE_SIZE)
+                        largeSegments.push_back(s);
+                    else if(!tiles.empty() && tiles.back().s[1] == s && offsets[s + 1] - offsets[tiles.back().s[0]] <= TILE_SIZE && s - tiles.back().s[0] < TILE_SIZE)
+                        tiles.back().s[1] = (cl_uint)s + 1;
+                    else
+                    {
+                        cl_uint2 tile = { { (cl_uint)s, (cl_uint)s + 1 } };
+                        tiles.push_back(tile);
+                    }
+                }
+
+                keyBuffer = context->createBuffer(CL_MEM_READ_WRITE, size * sizeof(T));
+                queue->enqueueWrite(keyBuffer, getKeys(data));
+
+                offsetBuffer = context->createBuffer(CL_MEM_READ_ONLY, (segments + 1) * sizeof(T));
+                queue->enqueueWrite(offsetBuffer, offsets);
+
+                tileBuffer = nullptr;
+                if(!tiles.empty())
+                {
+                    tileBuffer = context->createBuffer(CL_MEM_READ_ONLY, tiles.size() * sizeof(cl_uint2));
+                    queue->enqueueWrite(tileBuffer, tiles.data());
+                }
+
+                segmentOffsets.assign(offsets, offsets + segments + 1);
+
+                // the radix sort scratch is sized for the largest segment, run() only enqueues kernels
+                size_t largest = 0;
+                for(size_t s : largeSegments)
+                    largest = max(largest, (size_t)(offsets[s + 1] - offsets[s]));
+                if(largest > 0)
+                    radixSort.allocate(workGroupSize, largest);
+            }
+
+            void run(size_t workGroupSize, size_t size) override
+            {
+                if(!tiles.empty())
+                {
+                    kernel->setArg(0, keyBuffer);
+                    kernel->setArg(1, offsetBuffer);
+                    kernel->setArg(2, tileBuffer);
+                    kernel->setArg(3, TILE_SIZE * sizeof(cl_uint), nullptr);
+                    kernel->setArg(4, TILE_SIZE * sizeof(cl_ushort), nullptr);
+
+                    size_t globalWorkSizes[] = { tiles.size() * workGroupSize };
+                    size_t localWorkSizes[] = { workGroupSize };
+
+                    queue->enqueueKernel(kernel, 1, globalWorkSizes, localWorkSizes);
+                }
+
+                for(size_t s : largeSegments)
+                    radixSort.sort(workGroupSize, keyBuffer, segmentOffsets[s], segmentOffsets[s + 1] - segmentOffsets[s]);
+            }
+
+            void download(T* result, size_t size) override
+            {
+                queue->enqueueRead(keyBuffer, result, 0, size * sizeof(T));
+
+                delete keyBuffer;
+                delete offsetBuffer;
+                delete tileBuffer;
+
+                if(!largeSegments.empty())
+                    radixSort.release();
+            }
+
+            void cleanup() override
+            {
+                delete kernel;
+                radixSort.cleanup();
+            }
+
+            virtual ~SegmentedSort() {}
+
+        private:
+            Kernel* kernel;
+
+            Buffer* keyBuffer;
+            Buffer* offsetBuffer;
+            Buffer* tileBuffer;
+
+            vector<cl_uint2> tiles;
+            vector<size_t> largeSegments;
+            vector<T> segmentOffsets;
+
+            RadixSort<T> radixSort;
+        };
+    }
+}
@@ -5,6 +5,8 @@
 
 #include "../common/Runner.h"
 #include "SortPlugin.h"
+#include "SegmentedSortPlugin.h"
+#include "SelectPlugin.h"
 
 #include "cpu/Quicksort.h"
 #include "cpu/QSort.h"
@@ -12,6 +14,9 @@
 #include "cpu/TimSort.h"
 #include "cpu/amd/RadixSort.h"
 #include "cpu/stereopsis/radixsort.h"
+#include "cpu/SegmentedSort.h"
+#include "cpu/NthElement.h"
+#include "cpu/ParallelSelect.h"
 
 #include "gpu/bealto/ParallelSelectionSort.h"
 #include "gpu/bealto/ParallelSelectionSortLocal.h"
@@ -44,14 +49,74 @@
 #include "gpu/thesis/RadixSort.h"
 #include "gpu/thesis/RadixSortLocal.h"
 #include "gpu/thesis/RadixSortLocalVec.h"
+#include "gpu/thesis/RadixSortRanked.h"
+#include "gpu/thesis/RadixSortOnesweep.h"
+#include "gpu/thesis/SegmentedSort.h"
+#include "gpu/thesis/RadixSelect.h"
 
 using namespace std;
 
 #define MAX_POWER_OF_TWO 26
 #define RESOLUTION 5
 
-int main()
+/**
+* Sorts many small arrays in one call, every segment size distribution is written to its own stats file.
+*/
+void runSegmentedSort()
 {
+    // total number of keys of all segments
+    set<size_t> sizes;
+    for(int i = 16; i <= MAX_POWER_OF_TWO; i++)
+        sizes.insert((size_t)1 << i);
+
+    Runner<cl_uint, SegmentedSortPlugin> runner(3, sizes.begin(), sizes.end());
+
+    vector<SegmentDistribution> distributions = { SegmentDistribution::Fixed, SegmentDistribution::Uniform, SegmentDistribution::PowerLaw };
+
+    for(SegmentDistribution distribution : distributions)
+    {
+        runner.getPlugin()->setDistribution(distribution);
+
+        string name = segmentDistributionToString(distribution);
+        replace(name.begin(), name.end(), ' ', '_');
+        runner.start("stats_segmented_" + name + ".csv");
+
+        runner.run<cpu::SegmentedSort>();
+        runner.run<gpu::thesis::SegmentedSort>(CLRunType::GPU);
+
+        runner.finish();
+    }
+}
+
+void runSelect()
+{
+    set<size_t> sizes;
+    for(int i = 16; i <= MAX_POWER_OF_TWO; i++)
+        sizes.insert((size_t)1 << i);
+
+    Runner<cl_uint, SelectPlugin> runner(3, sizes.begin(), sizes.end());
+
+    vector<size_t> ks = { 1, 100, 10000, SelectPlugin<cl_uint>::MEDIAN };
+
+    for(size_t k : ks)
+    {
+        runner.getPlugin()->setK(k);
+
+        runner.start("stats_select_" + (k == SelectPlugin<cl_uint>::MEDIAN ? string("median") : to_string(k)) + ".csv");
+
+        runner.run<cpu::NthElement>();
+        runner.run<cpu::ParallelSelect>();
+        runner.run<gpu::thesis::RadixSelect>(CLRunType::GPU);
+
+        runner.finish();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Dataset* dataset = nullptr;
+    int exitCode = 0;
+
     try
     {
         set<size_t> sizes;
@@ -62,70 +127,115 @@ int main()
             sizes.insert(s);
         }
 
+        // an optional dataset file given on the command line replaces the generated input
+        if(argc > 1)
+        {
+            dataset = new Dataset(argv[1]);
+            sizes.clear();
+            sizes.insert((size_t)dataset->getCount());
+        }
+
         //array<size_t, 26> sizes = { 1<<1, 1<<2, 1<<3, 1<<4, 1<<5, 1<<6, 1<<7, 1<<8, 1<<9, 1<<10, 1<<11, 1<<12, 1<<13, 1<<14, 1<<15, 1<<16, 1<<17, 1<<18, 1<<19, 1<<20, 1<<21, 1<<22, 1<<23, 1<<24, 1<<25, 1<<26 };
         //array<size_t, 1> sizes = { 1<<25 };
         Runner<cl_uint, SortPlugin> runner(3, sizes.begin(), sizes.end());
 
         //runner.writeGPUDeviceInfo("gpuinfo.csv");
 
-        runner.start("stats.csv");
-
-        runner.run<cpu::Quicksort>();
-        runner.run<cpu::QSort>();
-        runner.run<cpu::STLSort>();
-        //runner.run<cpu::TimSort>();
-        runner.run<cpu::amd::RadixSort>();
-        runner.run<cpu::stereopsis::RadixSort>();
-
-        //runner.run<gpu::bealto::ParallelSelectionSort>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelSelectionSortLocal>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelSelectionSortBlocks>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortLocal>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortLocalOptim>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortA>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortB2>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortB4>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortB8>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortB16>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelBitonicSortC>(CLRunType::GPU);
-        //runner.run<gpu::bealto::ParallelMergeSort>(CLRunType::GPU);
-
-        //runner.run<gpu::clpp::RadixSort>(CLRunType::GPU); // not working
-
-        //runner.run<gpu::libcl::RadixSort>(CLRunType::GPU);
-
-        //runner.run<gpu::amd::BitonicSort>(CLRunType::GPU);
-        //runner.run<gpu::amd::RadixSort>(CLRunType::GPU); // crashes on large arrays
-        //runner.run<gpu::amd_dixxi::RadixSort>(CLRunType::GPU);
-        //runner.run<gpu::amd_dixxi::RadixSortVec>(CLRunType::GPU);
-
-        //runner.run<gpu::nvidia::RadixSort>(CLRunType::GPU);
-        //runner.run<gpu::nvidia::BitonicSort>(CLRunType::GPU);
-
-        //runner.run<gpu::dixxi::RadixSort>(CLRunType::GPU);
-        //runner.run<gpu::dixxi::RadixSortAtomicCounters>(CLRunType::GPU);
-        //runner.run<gpu::dixxi::BitonicSort>(CLRunType::GPU);
-        //runner.run<gpu::dixxi::BitonicSortFusion>(CLRunType::GPU);
-        //runner.run<gpu::dixxi::BitonicSortLocal>(CLRunType::GPU);
-
-        //runner.run<gpu::gpugems::OddEvenTransition>(CLRunType::GPU);
-
-        runner.run<gpu::thesis::BitonicSort>(CLRunType::GPU);
-        runner.run<gpu::thesis::BitonicSortFusion>(CLRunType::GPU);
-        runner.run<gpu::thesis::RadixSort>(CLRunType::GPU);
-        runner.run<gpu::thesis::RadixSortLocal>(CLRunType::GPU);
-        runner.run<gpu::thesis::RadixSortLocalVec>(CLRunType::GPU);
-
-        //runner.writeGPUDeviceInfo("gpuinfo.csv");
+        vector<KeyDistribution> distributions;
+        if(dataset)
+        {
+            runner.getPlugin()->setDataset(dataset);
+            distributions.push_back(KeyDistribution::Uniform); // ignored
+        }
+        else
+            distributions = { KeyDistribution::Uniform, KeyDistribution::Sorted, KeyDistribution::ReverseSorted, KeyDistribution::NearlySorted, KeyDistribution::FewUnique, KeyDistribution::Zipf, KeyDistribution::Gaussian, KeyDistribution::AllEqual, KeyDistribution::BitLimited };
 
-        runner.finish();
+        // every distribution is written to its own stats file
+        for(KeyDistribution distribution : distributions)
+        {
+            runner.getPlugin()->setDistribution(distribution);
+
+            string name = dataset ? "dataset" : keyDistributionToString(distribution);
+            replace(name.begin(), name.end(), ' ', '_');
+            runner.start("stats_" + name + ".csv");
+
+            runner.run<cpu::Quicksort>();
+            runner.run<cpu::QSort>();
+            runner.run<cpu::STLSort>();
+            //runner.run<cpu::TimSort>();
+            runner.run<cpu::amd::RadixSort>();
+            runner.run<cpu::stereopsis::RadixSort>();
+
+            //runner.run<gpu::bealto::ParallelSelectionSort>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelSelectionSortLocal>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelSelectionSortBlocks>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortLocal>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortLocalOptim>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortA>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortB2>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortB4>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortB8>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortB16>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelBitonicSortC>(CLRunType::GPU);
+            //runner.run<gpu::bealto::ParallelMergeSort>(CLRunType::GPU);
+
+            //runner.run<gpu::clpp::RadixSort>(CLRunType::GPU); // not working
+
+            //runner.run<gpu::libcl::RadixSort>(CLRunType::GPU);
+
+            //runner.run<gpu::amd::BitonicSort>(CLRunType::GPU);
+            //runner.run<gpu::amd::RadixSort>(CLRunType::GPU); // crashes on large arrays
+            //runner.run<gpu::amd_dixxi::RadixSort>(CLRunType::GPU);
+            //runner.run<gpu::amd_dixxi::RadixSortVec>(CLRunType::GPU);
+
+            //runner.run<gpu::nvidia::RadixSort>(CLRunType::GPU);
+            //runner.run<gpu::nvidia::BitonicSort>(CLRunType::GPU);
+
+            //runner.run<gpu::dixxi::RadixSort>(CLRunType::GPU);
+            //runner.run<gpu::dixxi::RadixSortAtomicCounters>(CLRunType::GPU);
+            //runner.run<gpu::dixxi::BitonicSort>(CLRunType::GPU);
+            //runner.run<gpu::dixxi::BitonicSortFusion>(CLRunType::GPU);
+            //runner.run<gpu::dixxi::BitonicSortLocal>(CLRunType::GPU);
+
+            //runner.run<gpu::gpugems::OddEvenTransition>(CLRunType::GPU);
+
+            runner.run<gpu::thesis::BitonicSort>(CLRunType::GPU);
+            runner.run<gpu::thesis::BitonicSortFusion>(CLRunType::GPU);
+            runner.run<gpu::thesis::RadixSort>(CLRunType::GPU);
+            runner.run<gpu::thesis::RadixSortLocal>(CLRunType::GPU);
+            runner.run<gpu::thesis::RadixSortLocalVec>(CLRunType::GPU);
+            runner.run<gpu::thesis::RadixSortRanked>(CLRunType::GPU);
+            runner.run<gpu::thesis::RadixSortOnesweep>(CLRunType::GPU);
+
+            //runner.writeGPUDeviceInfo("gpuinfo.csv");
+
+            runner.finish();
+        }
     }
     catch(const exception& e)
     {
         cerr << e.what() << endl;
+        exitCode = 1;
+    }
+
+    delete dataset;
+
+    // the segmented sorts and selections use own runners, which may only exist after the one above is destroyed
+    if(argc <= 1)
+    {
+        try
+        {
+            runSegmentedSort();
+            runSelect();
+        }
+        catch(const exception& e)
+        {
+            cerr << e.what() << endl;
+            exitCode = 1;
+        }
     }
 
     getchar();
 
-    return 0;
+    return exitCode;
 }